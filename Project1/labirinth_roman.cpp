@@ -1,8 +1,10 @@
-#include <vector>
+#include "labirinth_roman.h"
+#include <algorithm>
+#include <cmath>
 #include <stdexcept>
-#include <cstdint>
-
-using Area = std::vector<std::vector<int>>;
+#ifdef __AVX2__
+#include <immintrin.h>
+#endif
 
 enum class MoveDirection
 {
@@ -25,11 +27,15 @@ private:
 	MazeWalk(const MazeWalk& walk);
 	MazeWalk& operator=(const MazeWalk& other);
 	bool AdvancePosition(size_t &pos, int distance);
+	//the move (its number in the order the moves are tried) which has entered the visited cell
+	size_t GetEntryMove(size_t cell) const;
+	void SetEntryMove(size_t cell, size_t move);
 
 	const Area& m_area;
 	size_t m_posX;
 	size_t m_posY;
 	std::vector<bool> m_isVisited;
+	std::vector<bool> m_entryMoves;	//two bits per cell
 };
 
 MazeWalk::MazeWalk(const Area& a)
@@ -45,45 +51,60 @@ MazeWalk::MazeWalk(const Area& a)
 	}
 }
 
-MazeWalk::MazeWalk(const MazeWalk& walk)
-	: m_area(walk.m_area)
-	, m_posX(walk.m_posX)
-	, m_posY(walk.m_posY)
-	, m_isVisited(walk.m_isVisited)
-{
-}
-
-MazeWalk& MazeWalk::operator=(const MazeWalk& other)
-{
-	if (&m_area[0] != &(other.m_area[0]))
-		throw std::logic_error("Only walks though the same maze can be assigned");
-	
-	if (this != &other)
-	{
-		m_posX = other.m_posX;
-		m_posY = other.m_posY;
-		m_isVisited = other.m_isVisited;
-	}
-
-	return *this;
-}
-
 bool MazeWalk::SolveMaze()
 {
 	if (IsFinishReached())
 		return true;
 
-	auto arrMoves = { MoveDirection::Down, MoveDirection::Left, MoveDirection::Right, MoveDirection::Up };
-	for (auto it = arrMoves.begin(); it != arrMoves.end(); ++it)
+	//depth-first walk from the current position without a stack or a queue: each visited cell keeps the move which has entered it,
+	//so when all the moves of a cell are tried the walk goes back by the reverse move and goes on with the next move of the previous cell;
+	//the state is three bits per cell and each cell is entered once and left once
+	const size_t size = m_area.size();
+	if (size == 0)
+		return false;
+	//the reverse of the move i is the move 3 - i
+	const MoveDirection arrMoves[] = { MoveDirection::Down, MoveDirection::Left, MoveDirection::Right, MoveDirection::Up };
+	const size_t movesCount = sizeof(arrMoves) / sizeof(arrMoves[0]);
+	const size_t startX = m_posX;
+	const size_t startY = m_posY;
+	m_entryMoves.assign(2 * size * size, false);
+	m_isVisited[startY * size + startX] = true;
+	size_t move = 0;
+	for (;;)
 	{
-		MazeWalk newWalk = *this;
-		if (!newWalk.Move(*it))
+		if (move < movesCount)
+		{
+			if (!Move(arrMoves[move]))
+			{
+				++move;
+				continue;
+			}
+			if (IsFinishReached())
+				return true;
+			SetEntryMove(m_posY * size + m_posX, move);
+			move = 0;
 			continue;
-		if (newWalk.SolveMaze())
+		}
+		if (m_posX == startX && m_posY == startY)
+			break;
+		//the previous cell is visited, so the reverse move is made without Move
+		const size_t entryMove = GetEntryMove(m_posY * size + m_posX);
+		switch (arrMoves[movesCount - 1 - entryMove])
 		{
-			*this = newWalk;
-			return true;
+		case MoveDirection::Down:
+			++m_posY;
+			break;
+		case MoveDirection::Up:
+			--m_posY;
+			break;
+		case MoveDirection::Left:
+			--m_posX;
+			break;
+		case MoveDirection::Right:
+			++m_posX;
+			break;
 		}
+		move = entryMove + 1;
 	}
 	return false;
 }
@@ -135,6 +156,17 @@ bool MazeWalk::IsFinishReached() const
 	return true;
 }
 
+size_t MazeWalk::GetEntryMove(size_t cell) const
+{
+	return (m_entryMoves[2 * cell] ? 1 : 0) | (m_entryMoves[2 * cell + 1] ? 2 : 0);
+}
+
+void MazeWalk::SetEntryMove(size_t cell, size_t move)
+{
+	m_entryMoves[2 * cell] = (move & 1) != 0;
+	m_entryMoves[2 * cell + 1] = (move & 2) != 0;
+}
+
 bool MazeWalk::AdvancePosition(size_t& pos, int distance)
 {
 	int64_t newPos = (int64_t)pos + (int64_t)distance;
@@ -146,8 +178,824 @@ bool MazeWalk::AdvancePosition(size_t& pos, int distance)
 	return true;
 }
 
+//The class MazeBits keeps the open cells of a maze as the bits of the words of its rows (the column x is the bit x % 64
+//of the word x / 64) and grows the set of the cells reachable from the top-left corner with the shifts and the masks of whole words,
+//so an operation moves through 64 cells (256 with AVX2) instead of one. A sweep goes through the rows top down (or bottom up):
+//the cells below (above) the reached ones are reached if they are open, then each row is filled along its open runs.
+//A straight corridor takes one sweep in any direction, but a path which turns up and down many times takes a sweep per turn,
+//so the sweeps are limited and the caller falls back to the flood fill if the answer is not found by then.
+class MazeBits
+{
+public:
+	enum class Reachability
+	{
+		Reached,
+		Unreachable,
+		Unknown
+	};
+
+	MazeBits(const Area& a);
+
+	//sweeps the rows until the bottom-right corner is reached, nothing changes or maxSweeps are made
+	Reachability Grow(size_t maxSweeps);
+
+	//the maze of up to 8x8 cells is a single word (the cell (x, y) is the bit y * 8 + x)
+	static const size_t WordMazeMaxSize = 8;
+	static bool CanPassWordMaze(const Area& a);
+
+private:
+	//grows the reached cells of the row from the ones of the previous row, returns true if the row changes
+	bool SweepRow(size_t row, size_t previousRow);
+	//fills the runs of the open bits of a word which have a reached bit
+	static uint64_t FillWord(uint64_t reached, uint64_t open);
+
+	size_t m_size;
+	size_t m_words;	//the number of the words of a row
+	std::vector<uint64_t> m_open;
+	std::vector<uint64_t> m_reached;
+};
+
+MazeBits::MazeBits(const Area& a)
+	: m_size(a.size())
+	, m_words((a.size() + 63) / 64)
+	, m_open(m_words * a.size(), 0)
+	, m_reached(m_words * a.size(), 0)
+{
+	for (size_t y = 0; y < m_size; ++y)
+	{
+		if (a[y].size() != m_size)
+			throw std::logic_error("Not square mazes are not supported");
+		//the bits of a word are gathered without the branches
+		const int* cells = a[y].data();
+		for (size_t w = 0; w < m_words; ++w)
+		{
+			const size_t first = w * 64;
+			const size_t count = m_size - first < 64 ? m_size - first : 64;
+			uint64_t word = 0;
+			for (size_t x = 0; x < count; ++x)
+				word |= uint64_t(cells[first + x] == 0) << x;
+			m_open[y * m_words + w] = word;
+		}
+	}
+	//the walk starts at the top-left corner even if it's a wall
+	if (m_size > 0)
+		m_reached[0] = 1;
+}
+
+MazeBits::Reachability MazeBits::Grow(size_t maxSweeps)
+{
+	if (m_size == 0)
+		return Reachability::Unreachable;
+	if (m_size == 1)
+		return Reachability::Reached;
+
+	const size_t finishWord = (m_size - 1) * m_words + (m_size - 1) / 64;
+	const uint64_t finishBit = uint64_t(1) << ((m_size - 1) % 64);
+	size_t unchangedSweeps = 0;
+	for (size_t sweep = 0; sweep < maxSweeps; ++sweep)
+	{
+		bool isChanged = false;
+		if (sweep % 2 == 0)
+		{
+			for (size_t y = 0; y < m_size; ++y)
+				isChanged |= SweepRow(y, y == 0 ? y : y - 1);
+		}
+		else
+		{
+			for (size_t y = m_size; y-- > 0; )
+				isChanged |= SweepRow(y, y + 1 == m_size ? y : y + 1);
+		}
+		if (m_reached[finishWord] & finishBit)
+			return Reachability::Reached;
+		//a sweep in each direction without changes is the fixpoint
+		unchangedSweeps = isChanged ? 0 : unchangedSweeps + 1;
+		if (unchangedSweeps == 2)
+			return Reachability::Unreachable;
+	}
+	return Reachability::Unknown;
+}
+
+bool MazeBits::SweepRow(size_t row, size_t previousRow)
+{
+	uint64_t* reached = &m_reached[row * m_words];
+	const uint64_t* open = &m_open[row * m_words];
+	const uint64_t* previous = &m_reached[previousRow * m_words];
+	bool isChanged = false;
+	size_t w = 0;
+#ifdef __AVX2__
+	//the words are filled by four at once, the runs crossing the words are joined below
+	for (; w + 4 <= m_words; w += 4)
+	{
+		__m256i o = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(open + w));
+		__m256i r = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(reached + w));
+		__m256i s = _mm256_or_si256(r, _mm256_and_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(previous + w)), o));
+		//up the bits: the carry of the addition runs through the open bits above each reached one
+		__m256i t = _mm256_and_si256(_mm256_or_si256(s, _mm256_slli_epi64(s, 1)), o);
+		s = _mm256_or_si256(_mm256_or_si256(s, t), _mm256_and_si256(_mm256_xor_si256(_mm256_add_epi64(t, o), o), o));
+		//down the bits: the occluded fill with the doubling shifts
+		__m256i p = o;
+		s = _mm256_or_si256(s, _mm256_and_si256(_mm256_srli_epi64(s, 1), p));
+		p = _mm256_and_si256(p, _mm256_srli_epi64(p, 1));
+		s = _mm256_or_si256(s, _mm256_and_si256(_mm256_srli_epi64(s, 2), p));
+		p = _mm256_and_si256(p, _mm256_srli_epi64(p, 2));
+		s = _mm256_or_si256(s, _mm256_and_si256(_mm256_srli_epi64(s, 4), p));
+		p = _mm256_and_si256(p, _mm256_srli_epi64(p, 4));
+		s = _mm256_or_si256(s, _mm256_and_si256(_mm256_srli_epi64(s, 8), p));
+		p = _mm256_and_si256(p, _mm256_srli_epi64(p, 8));
+		s = _mm256_or_si256(s, _mm256_and_si256(_mm256_srli_epi64(s, 16), p));
+		p = _mm256_and_si256(p, _mm256_srli_epi64(p, 16));
+		s = _mm256_or_si256(s, _mm256_and_si256(_mm256_srli_epi64(s, 32), p));
+		isChanged |= !_mm256_testc_si256(r, s);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(reached + w), s);
+	}
+#endif
+	for (; w < m_words; ++w)
+	{
+		const uint64_t filled = FillWord(reached[w] | (previous[w] & open[w]), open[w]);
+		isChanged |= filled != reached[w];
+		reached[w] = filled;
+	}
+	//join the runs crossing the words: forward through the highest bits, then backward through the lowest ones
+	for (w = 1; w < m_words; ++w)
+	{
+		if ((reached[w - 1] >> 63) & open[w] & ~reached[w] & 1)
+		{
+			reached[w] = FillWord(reached[w] | 1, open[w]);
+			isChanged = true;
+		}
+	}
+	for (w = m_words - 1; w > 0; --w)
+	{
+		if ((reached[w] & 1) && ((open[w - 1] & ~reached[w - 1]) >> 63))
+		{
+			reached[w - 1] = FillWord(reached[w - 1] | (uint64_t(1) << 63), open[w - 1]);
+			isChanged = true;
+		}
+	}
+	return isChanged;
+}
+
+uint64_t MazeBits::FillWord(uint64_t reached, uint64_t open)
+{
+	//up the bits: the carry of the addition runs through the open bits above each reached one
+	//(or next to it, the start may be a wall)
+	const uint64_t seeds = (reached | (reached << 1)) & open;
+	//(the seeds cleared by the carry of a lower seed are added back)
+	reached |= seeds | (((seeds + open) ^ open) & open);
+	//down the bits: the occluded fill with the doubling shifts
+	uint64_t propagate = open;
+	reached |= (reached >> 1) & propagate;
+	propagate &= propagate >> 1;
+	reached |= (reached >> 2) & propagate;
+	propagate &= propagate >> 2;
+	reached |= (reached >> 4) & propagate;
+	propagate &= propagate >> 4;
+	reached |= (reached >> 8) & propagate;
+	propagate &= propagate >> 8;
+	reached |= (reached >> 16) & propagate;
+	propagate &= propagate >> 16;
+	reached |= (reached >> 32) & propagate;
+	return reached;
+}
+
+bool MazeBits::CanPassWordMaze(const Area& a)
+{
+	const size_t size = a.size();
+	uint64_t open = 0;
+	for (size_t y = 0; y < size; ++y)
+	{
+		if (a[y].size() != size)
+			throw std::logic_error("Not square mazes are not supported");
+		for (size_t x = 0; x < size; ++x)
+		{
+			if (a[y][x] == 0)
+				open |= uint64_t(1) << (y * WordMazeMaxSize + x);
+		}
+	}
+	if (size <= 1)
+		return size == 1;
+
+	//the cells of the last column don't move right to the next row, the ones of the first column don't move left
+	const uint64_t notFirstColumn = 0xFEFEFEFEFEFEFEFEull;
+	const uint64_t notLastColumn = 0x7F7F7F7F7F7F7F7Full;
+	const uint64_t finish = uint64_t(1) << ((size - 1) * WordMazeMaxSize + size - 1);
+	uint64_t reached = 1;
+	for (;;)
+	{
+		const uint64_t moved = ((reached << 1) & notFirstColumn) | ((reached >> 1) & notLastColumn) | (reached << WordMazeMaxSize) | (reached >> WordMazeMaxSize);
+		const uint64_t grown = reached | (moved & open);
+		if (grown & finish)
+			return true;
+		if (grown == reached)
+			return false;
+		reached = grown;
+	}
+}
+
 bool canPass(const Area& a)
 {
+	if (a.size() <= MazeBits::WordMazeMaxSize)
+		return MazeBits::CanPassWordMaze(a);
+
+	//the open mazes are passed in a few sweeps, the winding ones (each turn back is a sweep)
+	//are left to the flood fill after the sweeps which cost a small part of it
+	MazeBits bits(a);
+	switch (bits.Grow(16))
+	{
+	case MazeBits::Reachability::Reached:
+		return true;
+	case MazeBits::Reachability::Unreachable:
+		return false;
+	default:
+		break;
+	}
 	MazeWalk walk(a);
 	return walk.SolveMaze();
 }
+
+template <class Components>
+bool CanPassComponents(const Components& components)
+{
+	const size_t size = components.GetSize();
+	if (size <= 1)
+		return size == 1;
+
+	//the walk starts at the top-left corner even if it's a wall, then it goes on from the open cells next to it
+	const MazeCell finish = { size - 1, size - 1 };
+	const MazeCell starts[] = { { 0, 0 }, { 1, 0 }, { 0, 1 } };
+	const size_t startsCount = components.AreConnected(starts[0], starts[0]) ? 1 : sizeof(starts) / sizeof(starts[0]);
+	for (size_t i = 0; i < startsCount; ++i)
+	{
+		if (components.AreConnected(starts[i], finish))
+			return true;
+	}
+	return false;
+}
+
+bool canPass(const MazeComponents& components)
+{
+	return components.CanPass();
+}
+
+MazeComponents::MazeComponents(const Area& a)
+	: m_size(a.size())
+	, m_componentsCount(0)
+	, m_components(a.size() * a.size(), uint32_t(NoComponent))
+{
+	if (m_components.size() >= NoComponent)
+		throw std::length_error("The maze is too large to be labeled");
+
+	//the first pass: the provisional labels are merged in the union-find, each root is the smallest label of its set
+	std::vector<uint32_t> parents;
+	for (size_t y = 0; y < m_size; ++y)
+	{
+		if (a[y].size() != m_size)
+			throw std::logic_error("Not square mazes are not supported");
+		const int* cells = a[y].data();
+		uint32_t* labels = &m_components[y * m_size];
+		const uint32_t* upperLabels = y > 0 ? labels - m_size : nullptr;
+		for (size_t x = 0; x < m_size; ++x)
+		{
+			if (cells[x] != 0)
+				continue;
+			uint32_t left = x > 0 ? labels[x - 1] : NoComponent;
+			uint32_t up = upperLabels ? upperLabels[x] : NoComponent;
+			if (left == NoComponent && up == NoComponent)
+			{
+				labels[x] = static_cast<uint32_t>(parents.size());
+				parents.push_back(labels[x]);
+				continue;
+			}
+			if (left == NoComponent || up == NoComponent || left == up)
+			{
+				labels[x] = left == NoComponent ? up : left;
+				continue;
+			}
+			//both neighbours are open, their sets are joined
+			while (parents[left] != left)
+				left = parents[left] = parents[parents[left]];
+			while (parents[up] != up)
+				up = parents[up] = parents[parents[up]];
+			if (left < up)
+				parents[up] = left;
+			else
+				parents[left] = up;
+			labels[x] = left < up ? left : up;
+		}
+	}
+
+	//the roots are numbered in the order they are met, the parent of a label is smaller than it, so the roots are already final
+	std::vector<uint32_t> components(parents.size());
+	for (size_t i = 0; i < parents.size(); ++i)
+	{
+		if (parents[i] == i)
+			components[i] = static_cast<uint32_t>(m_componentsCount++);
+		else
+			components[i] = components[parents[i]];
+	}
+	for (size_t i = 0; i < m_components.size(); ++i)
+	{
+		if (m_components[i] != NoComponent)
+			m_components[i] = components[m_components[i]];
+	}
+}
+
+bool MazeComponents::AreConnected(const MazeCell& a, const MazeCell& b) const
+{
+	const uint32_t component = GetComponent(a);
+	return component != NoComponent && component == GetComponent(b);
+}
+
+std::vector<bool> MazeComponents::AreConnected(const std::vector<MazeCellPair>& pairs) const
+{
+	std::vector<bool> results(pairs.size());
+	for (size_t i = 0; i < pairs.size(); ++i)
+		results[i] = AreConnected(pairs[i].first, pairs[i].second);
+	return results;
+}
+
+bool MazeComponents::CanPass() const
+{
+	return CanPassComponents(*this);
+}
+
+size_t MazeComponents::GetSize() const
+{
+	return m_size;
+}
+
+size_t MazeComponents::GetComponentsCount() const
+{
+	return m_componentsCount;
+}
+
+uint32_t MazeComponents::GetComponent(const MazeCell& cell) const
+{
+	if (cell.x >= m_size || cell.y >= m_size)
+		throw std::out_of_range("The cell is out of the maze");
+	return m_components[cell.y * m_size + cell.x];
+}
+
+bool canPass(const DynamicMaze& maze)
+{
+	return maze.CanPass();
+}
+
+DynamicMaze::DynamicMaze(const Area& a)
+	: m_size(a.size())
+	, m_blockSize(std::max<size_t>(1, static_cast<size_t>(std::cbrt(static_cast<double>(a.size()) * a.size()) / 6)))
+	, m_blocksPerRow((a.size() + m_blockSize - 1) / m_blockSize)
+	, m_innerRegionsCount(0)
+	, m_edgeNodesCount(0)
+	, m_rootsCount(0)
+	, m_labels(a.size() * a.size(), uint32_t(NoComponent))
+	, m_regionsCounts(m_blocksPerRow * m_blocksPerRow, 0)
+	, m_edgeRegionsCounts(m_blocksPerRow * m_blocksPerRow, 0)
+	, m_borderPairs(2 * m_blocksPerRow * m_blocksPerRow)
+	, m_edgeNodes(m_blocksPerRow * m_blocksPerRow)
+	, m_parents()
+	, m_setSizes()
+	, m_oldLabels()
+	, m_oldNodes()
+	, m_pieces()
+	, m_searches()
+	, m_visits()
+	, m_visitStamp(0)
+	, m_queue()
+{
+	if (m_labels.size() >= Unlabeled)
+		throw std::length_error("The maze is too large to be labeled");
+
+	for (size_t y = 0; y < m_size; ++y)
+	{
+		if (a[y].size() != m_size)
+			throw std::logic_error("Not square mazes are not supported");
+		for (size_t x = 0; x < m_size; ++x)
+		{
+			if (a[y][x] == 0)
+				m_labels[y * m_size + x] = Unlabeled;
+		}
+	}
+	for (size_t block = 0; block < m_regionsCounts.size(); ++block)
+		LabelBlock(block);
+	for (size_t block = 0; block < m_regionsCounts.size(); ++block)
+		FindBorderPairs(block);
+	JoinBlocks();
+}
+
+void DynamicMaze::SetWall(size_t x, size_t y, bool isWall)
+{
+	const MazeCell wall = { x, y };
+	const size_t cell = GetCell(wall);
+	if ((m_labels[cell] == NoComponent) == isWall)
+		return;
+	const size_t block = GetBlock(cell);
+	const size_t left = block % m_blocksPerRow * m_blockSize;
+	const size_t top = block / m_blocksPerRow * m_blockSize;
+	const size_t right = std::min(left + m_blockSize, m_size);
+	const size_t bottom = std::min(top + m_blockSize, m_size);
+	m_oldLabels.clear();
+	for (size_t row = top; row < bottom; ++row)
+		m_oldLabels.insert(m_oldLabels.end(), m_labels.begin() + row * m_size + left, m_labels.begin() + row * m_size + right);
+	m_oldNodes = m_edgeNodes[block];
+	const uint32_t oldLabel = m_labels[cell];
+	const uint32_t regionNode = oldLabel < m_oldNodes.size() ? m_oldNodes[oldLabel] : uint32_t(NoComponent);
+	m_innerRegionsCount -= m_regionsCounts[block] - m_edgeRegionsCounts[block];
+	m_edgeNodesCount -= m_edgeRegionsCounts[block];
+
+	m_labels[cell] = isWall ? uint32_t(NoComponent) : uint32_t(Unlabeled);
+	LabelBlock(block);
+	FindBorderPairs(block);
+	if (block % m_blocksPerRow > 0)
+		FindBorderPairs(block - 1);
+	if (block >= m_blocksPerRow)
+		FindBorderPairs(block - m_blocksPerRow);
+	m_innerRegionsCount += m_regionsCounts[block] - m_edgeRegionsCounts[block];
+	m_edgeNodesCount += m_edgeRegionsCounts[block];
+
+	RelinkBlock(block);
+	//an opened cell only adds the pairs at the borders of its block, a wall splits an edge region at most
+	if (!isWall)
+	{
+		JoinBorder(block, 0);
+		JoinBorder(block, 1);
+		if (block % m_blocksPerRow > 0)
+			JoinBorder(block - 1, 0);
+		if (block >= m_blocksPerRow)
+			JoinBorder(block - m_blocksPerRow, 1);
+	}
+	else if (regionNode != NoComponent)
+	{
+		SplitRegion(cell, regionNode);
+	}
+	//the nodes of the replaced regions are dropped once they outnumber the current ones
+	if (m_parents.size() > 2 * m_edgeNodesCount + m_edgeNodes.size())
+		JoinBlocks();
+}
+
+bool DynamicMaze::IsWall(size_t x, size_t y) const
+{
+	const MazeCell cell = { x, y };
+	return m_labels[GetCell(cell)] == NoComponent;
+}
+
+bool DynamicMaze::AreConnected(const MazeCell& a, const MazeCell& b) const
+{
+	const size_t first = GetCell(a);
+	const size_t second = GetCell(b);
+	if (m_labels[first] == NoComponent || m_labels[second] == NoComponent)
+		return false;
+	if (GetBlock(first) == GetBlock(second) && m_labels[first] == m_labels[second])
+		return true;
+	//the regions of different blocks meet only through the edge regions
+	const uint32_t firstNode = GetEdgeNode(first);
+	const uint32_t secondNode = GetEdgeNode(second);
+	return firstNode != NoComponent && secondNode != NoComponent && FindRoot(firstNode) == FindRoot(secondNode);
+}
+
+std::vector<bool> DynamicMaze::AreConnected(const std::vector<MazeCellPair>& pairs) const
+{
+	std::vector<bool> results(pairs.size());
+	for (size_t i = 0; i < pairs.size(); ++i)
+		results[i] = AreConnected(pairs[i].first, pairs[i].second);
+	return results;
+}
+
+bool DynamicMaze::CanPass() const
+{
+	return CanPassComponents(*this);
+}
+
+size_t DynamicMaze::GetSize() const
+{
+	return m_size;
+}
+
+size_t DynamicMaze::GetComponentsCount() const
+{
+	return m_innerRegionsCount + m_rootsCount;
+}
+
+size_t DynamicMaze::GetCell(const MazeCell& cell) const
+{
+	if (cell.x >= m_size || cell.y >= m_size)
+		throw std::out_of_range("The cell is out of the maze");
+	return cell.y * m_size + cell.x;
+}
+
+size_t DynamicMaze::GetBlock(size_t cell) const
+{
+	return cell / m_size / m_blockSize * m_blocksPerRow + cell % m_size / m_blockSize;
+}
+
+void DynamicMaze::LabelBlock(size_t block)
+{
+	const size_t left = block % m_blocksPerRow * m_blockSize;
+	const size_t top = block / m_blocksPerRow * m_blockSize;
+	const size_t right = std::min(left + m_blockSize, m_size);
+	const size_t bottom = std::min(top + m_blockSize, m_size);
+	for (size_t y = top; y < bottom; ++y)
+	{
+		for (size_t x = left; x < right; ++x)
+		{
+			if (m_labels[y * m_size + x] != NoComponent)
+				m_labels[y * m_size + x] = Unlabeled;
+		}
+	}
+
+	//the searches from the cells of the edges first, so the edge regions are numbered before the ones inside the block
+	uint32_t label = 0;
+	for (size_t x = left; x < right; ++x)
+	{
+		const size_t edgeCells[] = { top * m_size + x, (bottom - 1) * m_size + x };
+		for (size_t i = 0; i < sizeof(edgeCells) / sizeof(edgeCells[0]); ++i)
+		{
+			if (m_labels[edgeCells[i]] == Unlabeled)
+				LabelRegion(edgeCells[i], label++, left, top, right, bottom);
+		}
+	}
+	for (size_t y = top; y < bottom; ++y)
+	{
+		const size_t edgeCells[] = { y * m_size + left, y * m_size + right - 1 };
+		for (size_t i = 0; i < sizeof(edgeCells) / sizeof(edgeCells[0]); ++i)
+		{
+			if (m_labels[edgeCells[i]] == Unlabeled)
+				LabelRegion(edgeCells[i], label++, left, top, right, bottom);
+		}
+	}
+	m_edgeRegionsCounts[block] = label;
+	for (size_t y = top + 1; y + 1 < bottom; ++y)
+	{
+		for (size_t x = left + 1; x + 1 < right; ++x)
+		{
+			if (m_labels[y * m_size + x] == Unlabeled)
+				LabelRegion(y * m_size + x, label++, left, top, right, bottom);
+		}
+	}
+	m_regionsCounts[block] = label;
+}
+
+void DynamicMaze::LabelRegion(size_t cell, uint32_t label, size_t left, size_t top, size_t right, size_t bottom)
+{
+	m_labels[cell] = label;
+	m_queue.assign(1, cell);
+	for (size_t head = 0; head < m_queue.size(); ++head)
+	{
+		const size_t current = m_queue[head];
+		const size_t x = current % m_size;
+		const size_t y = current / m_size;
+		const size_t neighbours[] = { current - m_size, current - 1, current + 1, current + m_size };
+		const bool isInside[] = { y > top, x > left, x + 1 < right, y + 1 < bottom };
+		for (size_t i = 0; i < sizeof(neighbours) / sizeof(neighbours[0]); ++i)
+		{
+			if (!isInside[i] || m_labels[neighbours[i]] != Unlabeled)
+				continue;
+			m_labels[neighbours[i]] = label;
+			m_queue.push_back(neighbours[i]);
+		}
+	}
+}
+
+void DynamicMaze::FindBorderPairs(size_t block)
+{
+	const size_t left = block % m_blocksPerRow * m_blockSize;
+	const size_t top = block / m_blocksPerRow * m_blockSize;
+	const size_t right = std::min(left + m_blockSize, m_size);
+	const size_t bottom = std::min(top + m_blockSize, m_size);
+	//the open cells on both sides of a border are in the edge regions of their blocks, the same pair met again along the border is skipped
+	std::vector<std::pair<uint32_t, uint32_t>>& rightPairs = m_borderPairs[2 * block];
+	rightPairs.clear();
+	for (size_t y = top; right < m_size && y < bottom; ++y)
+	{
+		const std::pair<uint32_t, uint32_t> pair(m_labels[y * m_size + right - 1], m_labels[y * m_size + right]);
+		if (pair.first != NoComponent && pair.second != NoComponent && (rightPairs.empty() || rightPairs.back() != pair))
+			rightPairs.push_back(pair);
+	}
+	std::vector<std::pair<uint32_t, uint32_t>>& lowerPairs = m_borderPairs[2 * block + 1];
+	lowerPairs.clear();
+	for (size_t x = left; bottom < m_size && x < right; ++x)
+	{
+		const std::pair<uint32_t, uint32_t> pair(m_labels[(bottom - 1) * m_size + x], m_labels[bottom * m_size + x]);
+		if (pair.first != NoComponent && pair.second != NoComponent && (lowerPairs.empty() || lowerPairs.back() != pair))
+			lowerPairs.push_back(pair);
+	}
+}
+
+void DynamicMaze::JoinBlocks()
+{
+	//the regions inside the blocks are the regions of the maze, the edge regions are the nodes of the union-find
+	m_parents.clear();
+	m_setSizes.clear();
+	m_innerRegionsCount = 0;
+	m_edgeNodesCount = 0;
+	m_rootsCount = 0;
+	for (size_t block = 0; block < m_regionsCounts.size(); ++block)
+	{
+		m_innerRegionsCount += m_regionsCounts[block] - m_edgeRegionsCounts[block];
+		m_edgeNodesCount += m_edgeRegionsCounts[block];
+		m_edgeNodes[block].resize(m_edgeRegionsCounts[block]);
+		for (size_t label = 0; label < m_edgeNodes[block].size(); ++label)
+			m_edgeNodes[block][label] = AddNode();
+	}
+	for (size_t block = 0; block < m_regionsCounts.size(); ++block)
+	{
+		JoinBorder(block, 0);
+		JoinBorder(block, 1);
+	}
+}
+
+void DynamicMaze::RelinkBlock(size_t block)
+{
+	const size_t left = block % m_blocksPerRow * m_blockSize;
+	const size_t top = block / m_blocksPerRow * m_blockSize;
+	const size_t right = std::min(left + m_blockSize, m_size);
+	const size_t bottom = std::min(top + m_blockSize, m_size);
+	//an old edge region lies in one new region, the old node is taken once and its other cells are skipped
+	std::vector<uint32_t>& nodes = m_edgeNodes[block];
+	nodes.assign(m_edgeRegionsCounts[block], uint32_t(NoComponent));
+	size_t i = 0;
+	for (size_t y = top; y < bottom; ++y)
+	{
+		for (size_t x = left; x < right; ++x, ++i)
+		{
+			const uint32_t label = m_labels[y * m_size + x];
+			const uint32_t oldLabel = m_oldLabels[i];
+			if (label >= nodes.size() || oldLabel >= m_oldNodes.size() || m_oldNodes[oldLabel] == NoComponent)
+				continue;
+			if (nodes[label] == NoComponent)
+				nodes[label] = m_oldNodes[oldLabel];
+			else
+				JoinNodes(nodes[label], m_oldNodes[oldLabel]);
+			m_oldNodes[oldLabel] = NoComponent;
+		}
+	}
+
+	//an opened cell may make an edge region of the inner ones, a wall may split its region (the node of the region it left stays)
+	for (size_t label = 0; label < nodes.size(); ++label)
+	{
+		if (nodes[label] == NoComponent)
+			nodes[label] = AddNode();
+	}
+}
+
+void DynamicMaze::JoinBorder(size_t block, size_t side)
+{
+	const size_t neighbour = side == 0 ? block + 1 : block + m_blocksPerRow;
+	const std::vector<std::pair<uint32_t, uint32_t>>& pairs = m_borderPairs[2 * block + side];
+	for (size_t i = 0; i < pairs.size(); ++i)
+		JoinNodes(m_edgeNodes[block][pairs[i].first], m_edgeNodes[neighbour][pairs[i].second]);
+}
+
+void DynamicMaze::SplitRegion(size_t cell, uint32_t node)
+{
+	//every part of the region left by the wall holds an open neighbour of the cell, the ones inside the block are counted as the inner regions
+	const size_t x = cell % m_size;
+	const size_t y = cell / m_size;
+	const size_t neighbours[] = { cell - m_size, cell - 1, cell + 1, cell + m_size };
+	const bool isInside[] = { y > 0, x > 0, x + 1 < m_size, y + 1 < m_size };
+	m_pieces.clear();
+	for (size_t i = 0; i < sizeof(neighbours) / sizeof(neighbours[0]); ++i)
+	{
+		if (!isInside[i] || m_labels[neighbours[i]] == NoComponent)
+			continue;
+		const std::pair<size_t, uint32_t> piece(GetBlock(neighbours[i]), m_labels[neighbours[i]]);
+		if (piece.second < m_edgeRegionsCounts[piece.first] && std::find(m_pieces.begin(), m_pieces.end(), piece) == m_pieces.end())
+			m_pieces.push_back(piece);
+	}
+	if (m_pieces.empty())
+	{
+		--m_rootsCount;
+		return;
+	}
+	for (size_t i = 0; i < m_pieces.size(); ++i)
+		JoinNodes(node, m_edgeNodes[m_pieces[i].first][m_pieces[i].second]);
+	if (m_pieces.size() > 1)
+		SeparatePieces();
+}
+
+void DynamicMaze::SeparatePieces()
+{
+	//the stamps of the searches of the previous separations are older, so the visits aren't cleared
+	const uint32_t piecesCount = static_cast<uint32_t>(m_pieces.size());
+	m_visits.resize(m_parents.size(), 0);
+	if (m_visitStamp > 0xFFFFFFFF - 2 * piecesCount)
+	{
+		std::fill(m_visits.begin(), m_visits.end(), 0);
+		m_visitStamp = 0;
+	}
+	const uint32_t stamp = ++m_visitStamp;
+	m_visitStamp += piecesCount;
+
+	//the searches which met are one group, its searches go on until one group is left or the group ends without meeting the others
+	//(the pieces are the neighbours of one cell, so there are 4 of them at most)
+	uint32_t groups[4];
+	size_t heads[4];
+	m_searches.resize(piecesCount);
+	for (uint32_t i = 0; i < piecesCount; ++i)
+	{
+		groups[i] = i;
+		heads[i] = 0;
+		m_searches[i].assign(1, m_pieces[i]);
+		m_visits[m_edgeNodes[m_pieces[i].first][m_pieces[i].second]] = stamp + i;
+	}
+	uint32_t groupsCount = piecesCount;
+	for (uint32_t i = 0; groupsCount > 1; i = (i + 1) % piecesCount)
+	{
+		const uint32_t group = groups[i];
+		if (group == piecesCount || heads[i] == m_searches[i].size())
+			continue;
+		const size_t block = m_searches[i][heads[i]].first;
+		const uint32_t label = m_searches[i][heads[i]].second;
+		++heads[i];
+
+		//the edge regions meeting the one at the borders of its block, the pairs of the left and the upper borders are kept by the neighbours
+		const size_t neighbours[] = { block + 1, block + m_blocksPerRow, block - 1, block - m_blocksPerRow };
+		const bool hasNeighbour[] = { true, true, block % m_blocksPerRow > 0, block >= m_blocksPerRow };
+		for (size_t side = 0; side < sizeof(neighbours) / sizeof(neighbours[0]); ++side)
+		{
+			if (!hasNeighbour[side])
+				continue;
+			const std::vector<std::pair<uint32_t, uint32_t>>& pairs =
+				side < 2 ? m_borderPairs[2 * block + side] : m_borderPairs[2 * neighbours[side] + side - 2];
+			for (size_t j = 0; j < pairs.size(); ++j)
+			{
+				if ((side < 2 ? pairs[j].first : pairs[j].second) != label)
+					continue;
+				const std::pair<size_t, uint32_t> next(neighbours[side], side < 2 ? pairs[j].second : pairs[j].first);
+				uint32_t& visit = m_visits[m_edgeNodes[next.first][next.second]];
+				if (visit < stamp || visit >= stamp + piecesCount)
+				{
+					visit = stamp + i;
+					m_searches[i].push_back(next);
+				}
+				else if (groups[visit - stamp] != group)
+				{
+					const uint32_t metGroup = groups[visit - stamp];
+					for (uint32_t k = 0; k < piecesCount; ++k)
+					{
+						if (groups[k] == metGroup)
+							groups[k] = group;
+					}
+					--groupsCount;
+				}
+			}
+		}
+
+		bool isEnded = true;
+		for (uint32_t k = 0; k < piecesCount && isEnded; ++k)
+			isEnded = groups[k] != group || heads[k] == m_searches[k].size();
+		if (!isEnded || groupsCount == 1)
+			continue;
+		//the group found its whole region, which gets new nodes (the old ones stay with the others)
+		const uint32_t root = AddNode();
+		for (uint32_t k = 0; k < piecesCount; ++k)
+		{
+			if (groups[k] != group)
+				continue;
+			for (size_t j = 0; j < m_searches[k].size(); ++j)
+			{
+				const uint32_t newNode = j == 0 && k == i ? root : AddNode();
+				m_edgeNodes[m_searches[k][j].first][m_searches[k][j].second] = newNode;
+				JoinNodes(root, newNode);
+			}
+			groups[k] = piecesCount;
+		}
+		--groupsCount;
+	}
+}
+
+uint32_t DynamicMaze::GetEdgeNode(size_t cell) const
+{
+	const size_t block = GetBlock(cell);
+	return m_labels[cell] < m_edgeRegionsCounts[block] ? m_edgeNodes[block][m_labels[cell]] : uint32_t(NoComponent);
+}
+
+uint32_t DynamicMaze::AddNode()
+{
+	const uint32_t node = static_cast<uint32_t>(m_parents.size());
+	m_parents.push_back(node);
+	m_setSizes.push_back(1);
+	++m_rootsCount;
+	return node;
+}
+
+void DynamicMaze::JoinNodes(uint32_t first, uint32_t second)
+{
+	uint32_t firstRoot = FindRoot(first);
+	uint32_t secondRoot = FindRoot(second);
+	if (firstRoot == secondRoot)
+		return;
+	if (m_setSizes[firstRoot] < m_setSizes[secondRoot])
+		std::swap(firstRoot, secondRoot);
+	m_parents[secondRoot] = firstRoot;
+	m_setSizes[firstRoot] += m_setSizes[secondRoot];
+	--m_rootsCount;
+}
+
+uint32_t DynamicMaze::FindRoot(uint32_t node) const
+{
+	//the smaller set goes under the larger one, so the paths are at most log2 of the nodes long and the questions don't change them
+	while (m_parents[node] != node)
+		node = m_parents[node];
+	return node;
+}
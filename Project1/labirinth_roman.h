@@ -0,0 +1,119 @@
+#pragma once
+
+#include <vector>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+using Area = std::vector<std::vector<int>>;
+
+//the cell of the column x and the row y (Area[y][x])
+struct MazeCell
+{
+	size_t x;
+	size_t y;
+};
+
+using MazeCellPair = std::pair<MazeCell, MazeCell>;
+
+//The class MazeComponents labels the connected regions of the open cells of a maze once,
+//so each question whether two cells are connected is a comparison of their labels.
+//The rows are labeled in one pass: an open cell takes the label of its left or upper neighbour
+//and the labels met from both sides are merged with a union-find, the second pass replaces them with their roots.
+class MazeComponents
+{
+public:
+	MazeComponents(const Area& a);
+
+	//the cells are connected if both are open and in the same region (out_of_range is thrown for a cell out of the maze)
+	bool AreConnected(const MazeCell& a, const MazeCell& b) const;
+	std::vector<bool> AreConnected(const std::vector<MazeCellPair>& pairs) const;
+	//tells whether the bottom-right corner is reached from the top-left one, as canPass does
+	bool CanPass() const;
+	size_t GetSize() const;
+	size_t GetComponentsCount() const;
+
+private:
+	static const uint32_t NoComponent = 0xFFFFFFFF;
+
+	uint32_t GetComponent(const MazeCell& cell) const;
+
+	size_t m_size;
+	size_t m_componentsCount;
+	std::vector<uint32_t> m_components;	//the region of each cell or NoComponent for a wall
+};
+
+//The class DynamicMaze keeps the regions of a maze whose walls are set and removed: a change labels the regions inside its block anew,
+//the regions leaving the blocks are joined by a union-find kept between the changes and the parts cut by a wall are searched from all of them in turns.
+class DynamicMaze
+{
+public:
+	DynamicMaze(const Area& a);
+
+	void SetWall(size_t x, size_t y, bool isWall);
+	bool IsWall(size_t x, size_t y) const;
+	//the cells are connected if both are open and in the same region (out_of_range is thrown for a cell out of the maze)
+	bool AreConnected(const MazeCell& a, const MazeCell& b) const;
+	std::vector<bool> AreConnected(const std::vector<MazeCellPair>& pairs) const;
+	//tells whether the bottom-right corner is reached from the top-left one, as canPass does
+	bool CanPass() const;
+	size_t GetSize() const;
+	size_t GetComponentsCount() const;
+
+private:
+	static const uint32_t NoComponent = 0xFFFFFFFF;
+	static const uint32_t Unlabeled = 0xFFFFFFFE;
+
+	size_t GetCell(const MazeCell& cell) const;
+	size_t GetBlock(size_t cell) const;
+	//labels the regions of the block, the edge regions get the first labels
+	void LabelBlock(size_t block);
+	//gives the label to the unlabeled open cells reached from the cell inside the block [left, right) x [top, bottom)
+	void LabelRegion(size_t cell, uint32_t label, size_t left, size_t top, size_t right, size_t bottom);
+	//finds the pairs of the edge regions meeting at the right and the lower borders of the block
+	void FindBorderPairs(size_t block);
+	//joins the edge regions of all the blocks anew and counts the regions of the maze
+	void JoinBlocks();
+	//gives the edge regions of the block labeled anew the nodes of its old edge regions inside them (joining them), a region without one gets a new node
+	void RelinkBlock(size_t block);
+	//joins the edge regions of the pairs at the right (side 0) or the lower (side 1) border of the block
+	void JoinBorder(size_t block, size_t side);
+	//the region of the node lost the new wall of the cell, the edge regions of its open neighbours are joined to the node and separated if they don't meet
+	void SplitRegion(size_t cell, uint32_t node);
+	//searches the edge regions from the pieces in turns, the pieces whose searches meet are joined, the ones found alone get new nodes
+	void SeparatePieces();
+	//the node of the edge region of the cell in the union-find or NoComponent if its region doesn't leave the block
+	uint32_t GetEdgeNode(size_t cell) const;
+	uint32_t AddNode();
+	void JoinNodes(uint32_t first, uint32_t second);
+	uint32_t FindRoot(uint32_t node) const;
+
+	size_t m_size;
+	//about size^(2/3) / 6 cells: a change labels its block anew, while a wall cutting the maze in halves searches size^2 / block edge regions
+	size_t m_blockSize;
+	size_t m_blocksPerRow;
+	size_t m_innerRegionsCount;	//the number of the regions not leaving their blocks
+	size_t m_edgeNodesCount;	//the number of the nodes of the current edge regions
+	size_t m_rootsCount;	//the number of the sets of the union-find holding the current edge regions
+	std::vector<uint32_t> m_labels;	//the region of each cell in its block or NoComponent for a wall
+	std::vector<uint32_t> m_regionsCounts;	//the number of the regions of each block
+	std::vector<uint32_t> m_edgeRegionsCounts;	//the number of the edge regions of each block (their labels are the first ones)
+	//the labels of the pairs of the edge regions at the right and at the lower border of each block (the pairs of the block i are 2i and 2i + 1)
+	std::vector<std::vector<std::pair<uint32_t, uint32_t>>> m_borderPairs;
+	std::vector<std::vector<uint32_t>> m_edgeNodes;	//the node of each edge region of each block
+	//the parent of each node, a root is its own parent (the nodes of the replaced regions stay until all the blocks are joined again)
+	std::vector<uint32_t> m_parents;
+	std::vector<uint32_t> m_setSizes;	//the number of the nodes under each root, the smaller set is put under the larger one
+	std::vector<uint32_t> m_oldLabels;	//the labels of the changed block before the change, row by row
+	std::vector<uint32_t> m_oldNodes;	//the nodes of the edge regions of the changed block before the change
+	std::vector<std::pair<size_t, uint32_t>> m_pieces;	//the blocks and the labels of the edge regions next to the new wall
+	std::vector<std::vector<std::pair<size_t, uint32_t>>> m_searches;	//the edge regions found from each piece
+	std::vector<uint32_t> m_visits;	//the stamp of the search which found each node
+	uint32_t m_visitStamp;	//the stamps up to it are taken by the searches of the previous separations
+	std::vector<size_t> m_queue;
+};
+
+//tells whether one can reach the bottom-right corner starting from the top-left corner, 1 is a wall
+bool canPass(const Area& a);
+bool canPass(const MazeComponents& components);
+bool canPass(const DynamicMaze& maze);
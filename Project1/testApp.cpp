@@ -12,8 +12,10 @@ true/false is required as the output.
 */
 #include <iostream>
 #include <vector>
-
-using Area = std::vector<std::vector<int>>;
+#include <random>
+#include <chrono>
+#include <string>
+#include "labirinth_roman.h"
 
 // 1 - wall that we cannot pass, 0 - empty space that we can move to
 Area labirinth = {
@@ -38,9 +40,92 @@ Area labirinth = {
 
 };
 
-bool canPass(const Area& a);
+//replays the toggles of the walls of the maze asking canPass after each one, the dynamic maze against the answers from scratch
+void CompareToggles(const std::string& title, Area maze, const std::vector<MazeCell>& toggles)
+{
+	typedef std::chrono::steady_clock Clock;
+	Clock::time_point start = Clock::now();
+	DynamicMaze dynamicMaze(maze);
+	std::vector<bool> dynamicAnswers(toggles.size());
+	for (size_t i = 0; i < toggles.size(); ++i)
+	{
+		dynamicMaze.SetWall(toggles[i].x, toggles[i].y, !dynamicMaze.IsWall(toggles[i].x, toggles[i].y));
+		dynamicAnswers[i] = canPass(dynamicMaze);
+	}
+	const double dynamicSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	start = Clock::now();
+	size_t mismatches = 0;
+	for (size_t i = 0; i < toggles.size(); ++i)
+	{
+		int& cell = maze[toggles[i].y][toggles[i].x];
+		cell = 1 - cell;
+		if (canPass(maze) != dynamicAnswers[i])
+			++mismatches;
+	}
+	const double scratchSeconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+	std::cout << title << ", " << toggles.size() << " toggles: dynamic " << dynamicSeconds << " s, from scratch "
+		<< scratchSeconds << " s, mismatches: " << mismatches << std::endl;
+}
 
-int main() {
+//the random toggles of a random maze
+void BenchmarkToggles(size_t size, size_t togglesCount)
+{
+	std::mt19937 random(1);
+	Area maze(size, std::vector<int>(size, 0));
+	for (size_t y = 0; y < size; ++y)
+	{
+		for (size_t x = 0; x < size; ++x)
+			maze[y][x] = random() % 100 < 40 ? 1 : 0;
+	}
+	std::vector<MazeCell> toggles(togglesCount);
+	for (size_t i = 0; i < togglesCount; ++i)
+		toggles[i] = { random() % size, random() % size };
+	CompareToggles(std::to_string(size) + "x" + std::to_string(size), maze, toggles);
+}
+
+//the open maze split in halves by a wall column with one gap, which is toggled: each toggle joins or splits the halves
+void BenchmarkBridge(size_t size, size_t togglesCount)
+{
+	Area maze(size, std::vector<int>(size, 0));
+	for (size_t y = 0; y < size; ++y)
+		maze[y][size / 2] = y == size / 2 ? 0 : 1;
+	const std::vector<MazeCell> toggles(togglesCount, MazeCell{ size / 2, size / 2 });
+	CompareToggles(std::to_string(size) + "x" + std::to_string(size) + " bridge", maze, toggles);
+}
+
+//asks the questions about the regions of the labirinth labeled once
+void DemoComponents()
+{
+	MazeComponents components(labirinth);
+	std::vector<MazeCellPair> pairs = { { { 0, 0 }, { 7, 7 } }, { { 0, 0 }, { 7, 0 } }, { { 0, 4 }, { 0, 5 } } };
+	std::vector<bool> connected = components.AreConnected(pairs);
+	std::cout << "Regions: " << components.GetComponentsCount() << ", can I pass? : " << std::boolalpha << canPass(components) << std::endl;
+	for (size_t i = 0; i < pairs.size(); ++i)
+	{
+		std::cout << "(" << pairs[i].first.x << ", " << pairs[i].first.y << ") - (" << pairs[i].second.x << ", " << pairs[i].second.y
+			<< ") connected: " << connected[i] << std::endl;
+	}
+}
+
+//only the answer for the labirinth is printed, the demo of the regions (--demo) and the benchmark of the changing mazes (--benchmark) are optional
+int main(int argc, char* argv[]) {
 
 	std::cout << "Can I pass? : " << std::boolalpha << canPass(labirinth) << std::endl;
+
+	for (int i = 1; i < argc; ++i)
+	{
+		const std::string option(argv[i]);
+		if (option == "--demo")
+		{
+			DemoComponents();
+		}
+		else if (option == "--benchmark")
+		{
+			BenchmarkToggles(256, 10000);
+			BenchmarkToggles(1024, 500);
+			BenchmarkBridge(1024, 200);
+		}
+	}
 }
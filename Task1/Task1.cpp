@@ -1,5 +1,82 @@
 #include "stdafx.h"
 #include "board.h"
+#include "puzzle.h"
+#include "verifier.h"
+#include "trace.h"
+#include "shortest_solutions.h"
+#include "board2.h"
+#include "generator.h"
+#include "solver_server.h"
+#include "ranked_solver.h"
+#include "checkpointed_solver.h"
+#include "portfolio_solver.h"
+#include "engine.h"
+#include "calibration.h"
+#include "regression.h"
+
+namespace
+{
+	//writes the recorded trace events to the file when the application finishes
+	class TraceFileWriter
+	{
+	public:
+		explicit TraceFileWriter(const std::string &fileName)
+			:m_fileName(fileName)
+		{
+			Trace::Enable();
+		}
+		~TraceFileWriter()
+		{
+			Trace::Disable();
+			std::ofstream traceFile(m_fileName);
+			if(!traceFile.is_open())
+			{
+				std::cerr << "Error while openning the trace file: " << m_fileName << std::endl;
+				return;
+			}
+			Trace::Write(traceFile);
+		}
+
+	private:
+		std::string m_fileName;
+	};
+
+	//prints the solution as the application does, returns the exit code
+	int PrintSolution(bool solutionFound, const std::vector<TiltDirection> &solution)
+	{
+		if(solutionFound)
+		{
+			for(size_t i = 0; i < solution.size(); ++i)
+			{
+				switch(solution[i])
+				{
+					case East:
+						std::cout << "E ";
+						break;
+					case West:
+						std::cout << "W ";
+						break;
+					case North:
+						std::cout << "N ";
+						break;
+					case South:
+						std::cout << "S ";
+						break;
+					default:
+						std::cerr << "Unexpected value in the solution!" << std::endl;
+						return 4;
+				}
+			}
+		}
+		else
+		{
+			std::cout << "X";
+		}
+		std::cout << std::endl;
+
+		return 0;
+	}
+}
 
 int _tmain(int argc, _TCHAR* argv[])
 try
@@ -10,7 +87,58 @@ try
 	desc.add_options()
     ("help", "produce help message")
 	("input_file", po::value<std::string>(), "set path to the file with the input data")
+	("verify", po::value<std::string>(), "set path to the file with (puzzle line, solution line) pairs to check instead of solving")
+	("threads", po::value<size_t>()->default_value(0), "set number of the verification, generator and server threads (0 - number of the hardware threads)")
+	("count_solutions", "count all the shortest solutions instead of printing one")
+	("enumerate", po::value<size_t>()->default_value(0), "set number of the shortest solutions to print after their count")
+	("trace", po::value<std::string>(), "set path to the file to write the Chrome trace of the solver to (the tracing should be compiled in)")
+	("checkpoint", po::value<std::string>(), "set path to the file to write the checkpoints of the solve to, so it can be resumed")
+	("checkpoint_interval", po::value<size_t>()->default_value(60), "set number of the seconds between the checkpoints")
+	("resume", po::value<std::string>(), "set path to the checkpoint to continue the solve from instead of reading the input file")
+	("portfolio", po::value<std::string>()->implicit_value("board2,ranked,best_first,sparse,nogood"), "race the comma separated engines on the puzzle and print the answer of the first one")
+	("engine", po::value<std::string>()->default_value("auto"), "set the engine to solve with: auto (the fastest one according to the calibration), board, board2, sparse, ranked, best_first (not the shortest solution), nogood or compact (the fewest bytes per state)")
+	("calibration", po::value<std::string>(), "set path to the calibration table to choose the engine with instead of the built-in one")
+	("calibrate", po::value<std::string>(), "set path to the file to write the calibration table measured on the generated puzzles to instead of solving")
+	("calibration_samples", po::value<size_t>()->default_value(4), "set number of the generated puzzles of each kind the engines are measured on")
+	("memory_limit", po::value<size_t>()->default_value(RankedSolver::DefaultMemoryLimit >> 20), "set the most megabytes of the visited states bitmap, with which the states are ranked instead of hashed")
 	;
+	GeneratorOptions generatorOptions;
+	po::options_description generatorDesc("Generator options");
+	generatorDesc.add_options()
+	("generate", po::value<std::string>(), "set path to the file to write the generated puzzles to instead of solving")
+	("board_size", po::value<size_t>(&generatorOptions.boardSize)->default_value(generatorOptions.boardSize), "set size of the generated boards")
+	("balls", po::value<size_t>(&generatorOptions.ballsCount)->default_value(generatorOptions.ballsCount), "set number of the balls on the generated boards")
+	("walls", po::value<size_t>(&generatorOptions.wallsCount)->default_value(generatorOptions.wallsCount), "set number of the walls on the generated boards")
+	("min_depth", po::value<size_t>(&generatorOptions.minSolutionLength)->default_value(generatorOptions.minSolutionLength), "set the least optimal solution length of the generated puzzles")
+	("min_states", po::value<size_t>(&generatorOptions.minStatesCount)->default_value(generatorOptions.minStatesCount), "set the least number of the reachable states of the generated puzzles")
+	("unsolvable", "generate unsolvable puzzles")
+	("count", po::value<size_t>(&generatorOptions.puzzlesCount)->default_value(generatorOptions.puzzlesCount), "set number of the puzzles to generate")
+	("climbing_steps", po::value<size_t>(&generatorOptions.climbingSteps)->default_value(generatorOptions.climbingSteps), "set number of the hill climbing steps for each sampled layout")
+	("max_samples", po::value<size_t>(&generatorOptions.maxSamples)->default_value(generatorOptions.maxSamples), "set the most number of the sampled layouts")
+	("seed", po::value<unsigned int>(&generatorOptions.seed)->default_value(generatorOptions.seed), "set seed of the random layouts")
+	;
+	desc.add(generatorDesc);
+	po::options_description serverDesc("Server options");
+	serverDesc.add_options()
+	("serve", po::value<std::string>(), "set path to the unix domain socket to serve the \"<id> <puzzle>\" request lines on instead of solving")
+	("serve_stdio", "serve the request lines from the standard input instead of solving")
+	("cache_size", po::value<size_t>()->default_value(1 << 16), "set number of the puzzles which solutions the server remembers")
+	("load", po::value<std::string>(), "set path to the socket of a server to send the puzzle of the input file to and report the latency")
+	("requests", po::value<size_t>()->default_value(100000), "set number of the requests the load generator sends")
+	("in_flight", po::value<size_t>()->default_value(16), "set number of the requests the load generator keeps waiting for the responses")
+	("load_puzzles", po::value<size_t>()->default_value(0), "set number of the puzzles the load generator generates with the generator options and sends in turn instead of the input file puzzle (more than the server cache size to measure the solving, not the cache)")
+	;
+	desc.add(serverDesc);
+	po::options_description regressionDesc("Regression options");
+	regressionDesc.add_options()
+	("regress", po::value<std::string>(), "set path to the corpus of the puzzles with their baselines to check the solver against instead of solving (exit code 6 on a regression)")
+	("regress_report", "print the deltas against the baselines for all the puzzles of the corpus, not only for the regressions")
+	("regress_record", "measure the puzzles of the corpus and write them back as the new baselines")
+	("regress_repeats", po::value<size_t>()->default_value(3), "set number of the solves of each puzzle, the least time is taken")
+	("regress_tolerance", po::value<double>()->default_value(0.5), "set the fraction the solve time may exceed the baseline by before it is reported")
+	("regress_gate_time", "count the solves slower than the tolerance as the regressions (the baselines should be recorded on the same machine)")
+	;
+	desc.add(regressionDesc);
 	po::variables_map vm;
 	po::store(po::parse_command_line(argc, argv, desc), vm);
 	po::notify(vm);    
@@ -19,6 +147,131 @@ try
 		std::cout << desc << "\n";
 		return 1;
 	}
+	std::unique_ptr<TraceFileWriter> traceFileWriter;
+	if(vm.count("trace"))
+	{
+		traceFileWriter.reset(new TraceFileWriter(vm["trace"].as<std::string>()));
+	}
+	//verify the claimed solutions instead of solving
+	if(vm.count("verify"))
+	{
+		std::string verifyFileName(vm["verify"].as<std::string>());
+		std::ifstream verifyFile(verifyFileName);
+		if(!verifyFile.is_open())
+		{
+			std::cerr << "Error while openning the verification file: " << verifyFileName << std::endl;
+			return 3;
+		}
+		VerifySolutionsStream(verifyFile, std::cout, vm["threads"].as<size_t>(), 1 << 16);
+		return 0;
+	}
+	//generate the puzzles instead of solving
+	if(vm.count("generate"))
+	{
+		std::string corpusFileName(vm["generate"].as<std::string>());
+		std::ofstream corpusFile(corpusFileName);
+		if(!corpusFile.is_open())
+		{
+			std::cerr << "Error while openning the corpus file: " << corpusFileName << std::endl;
+			return 3;
+		}
+		generatorOptions.isUnsolvable = vm.count("unsolvable") != 0;
+		generatorOptions.threadsCount = vm["threads"].as<size_t>();
+		std::vector<GeneratedPuzzle> puzzles(GeneratePuzzles(generatorOptions));
+		WriteCorpus(corpusFile, puzzles);
+		if(puzzles.size() < generatorOptions.puzzlesCount)
+		{
+			std::cerr << "Only " << puzzles.size() << " puzzles meeting the targets were found" << std::endl;
+			return 5;
+		}
+		return 0;
+	}
+	unsigned long long memoryLimit = static_cast<unsigned long long>(vm["memory_limit"].as<size_t>()) << 20;
+	//measure the engines instead of solving
+	if(vm.count("calibrate"))
+	{
+		std::string calibrationFileName(vm["calibrate"].as<std::string>());
+		std::ofstream calibrationFile(calibrationFileName);
+		if(!calibrationFile.is_open())
+		{
+			std::cerr << "Error while openning the calibration file: " << calibrationFileName << std::endl;
+			return 3;
+		}
+		WriteCalibration(calibrationFile, Calibrate(vm["calibration_samples"].as<size_t>(), generatorOptions.seed, memoryLimit));
+		return 0;
+	}
+	//check the solver against the baselines instead of solving
+	if(vm.count("regress"))
+	{
+		std::string corpusFileName(vm["regress"].as<std::string>());
+		std::ifstream corpusFile(corpusFileName);
+		if(!corpusFile.is_open())
+		{
+			std::cerr << "Error while openning the regression corpus: " << corpusFileName << std::endl;
+			return 3;
+		}
+		std::vector<RegressionCase> cases(ReadRegressionCorpus(corpusFile));
+		corpusFile.close();
+		size_t repeats = vm["regress_repeats"].as<size_t>();
+		if(vm.count("regress_record"))
+		{
+			for(size_t i = 0; i < cases.size(); ++i)
+			{
+				cases[i] = MeasureRegressionCase(cases[i].puzzle, repeats);
+			}
+			std::ofstream recordFile(corpusFileName);
+			if(!recordFile.is_open())
+			{
+				std::cerr << "Error while openning the regression corpus: " << corpusFileName << std::endl;
+				return 3;
+			}
+			WriteRegressionCorpus(recordFile, cases);
+			return 0;
+		}
+		return RunRegression(cases, repeats, vm["regress_tolerance"].as<double>(), vm.count("regress_gate_time") != 0, vm.count("regress_report") != 0, std::cout) ? 6 : 0;
+	}
+	//serve the requests instead of solving
+	if(vm.count("serve") || vm.count("serve_stdio"))
+	{
+		SolverServer server(vm["threads"].as<size_t>(), vm["cache_size"].as<size_t>());
+		if(vm.count("serve_stdio"))
+		{
+			server.ServeStream(std::cin, std::cout);
+			return 0;
+		}
+		server.ServeSocket(vm["serve"].as<std::string>());
+		return 0;
+	}
+	//measure the server with the generated puzzles
+	if(vm.count("load") && vm["load_puzzles"].as<size_t>())
+	{
+		generatorOptions.isUnsolvable = vm.count("unsolvable") != 0;
+		generatorOptions.threadsCount = vm["threads"].as<size_t>();
+		generatorOptions.puzzlesCount = vm["load_puzzles"].as<size_t>();
+		generatorOptions.maxSamples = std::max(generatorOptions.maxSamples, generatorOptions.puzzlesCount);
+		std::vector<GeneratedPuzzle> generated(GeneratePuzzles(generatorOptions));
+		//the same layout may be generated twice
+		std::set<std::string> puzzles;
+		for(size_t i = 0; i < generated.size(); ++i)
+		{
+			puzzles.insert(FormatPuzzle(generated[i].puzzle));
+		}
+		if(puzzles.empty())
+		{
+			std::cerr << "No puzzles meeting the targets were found" << std::endl;
+			return 5;
+		}
+		RunLoadGenerator(vm["load"].as<std::string>(), std::vector<std::string>(puzzles.begin(), puzzles.end()), vm["requests"].as<size_t>(), vm["in_flight"].as<size_t>(), std::cout);
+		return 0;
+	}
+	//continue the checkpointed solve instead of starting it
+	if(vm.count("resume"))
+	{
+		std::vector<TiltDirection> solution;
+		SolveStatistics statistics;
+		bool solutionFound = CheckpointedSolver::Resume(vm["resume"].as<std::string>(), vm["checkpoint_interval"].as<size_t>(), solution, statistics);
+		return PrintSolution(solutionFound, solution);
+	}
 	if(!vm.count("input_file"))
 	{
 		std::cerr << "No input file was specified!" << std::endl;
@@ -40,84 +293,91 @@ try
 		return 3;
 	}
 
-	size_t boardSize;
-	std::vector<Position> balls;
-	std::vector<Position> holes;
-	std::vector<std::pair<Position, Position>> walls;
-
 	//Parse input data
-	//bellow we don't check for errors in the input data (according to the task)
-	//Note: in the input we recieve positions starting from (1,1), so we fix them
-	std::stringstream ss(inputData);
-	size_t readNumber;
-	ss >> readNumber;
-	boardSize = readNumber;
-	ss >> readNumber;
-	balls.resize(readNumber);
-	holes.resize(readNumber);
-	ss >> readNumber;
-	walls.resize(readNumber);
-	for(size_t i = 0; i < balls.size(); ++i)
-	{
-		ss >> readNumber;
-		balls[i].column = readNumber - 1;
-		ss >> readNumber;
-		balls[i].row = readNumber - 1;
-	}
-	for(size_t i = 0; i < holes.size(); ++i)
-	{
-		ss >> readNumber;
-		holes[i].column = readNumber - 1;
-		ss >> readNumber;
-		holes[i].row = readNumber - 1;
-	}
-	for(size_t i = 0; i < walls.size(); ++i)
-	{
-		ss >> readNumber;
-		walls[i].first.column = readNumber - 1;
-		ss >> readNumber;
-		walls[i].first.row = readNumber - 1;
-		ss >> readNumber;
-		walls[i].second.column = readNumber - 1;
-		ss >> readNumber;
-		walls[i].second.row = readNumber - 1;
+	//bellow we don't check for consistency of the input data (according to the task)
+	Puzzle puzzle(ParsePuzzle(inputData));
+
+	//Measure the server with the puzzle
+	if(vm.count("load"))
+	{
+		RunLoadGenerator(vm["load"].as<std::string>(), std::vector<std::string>(1, inputData), vm["requests"].as<size_t>(), vm["in_flight"].as<size_t>(), std::cout);
+		return 0;
 	}
 
-	//Solve the game
-	Board b(boardSize, balls, holes, walls);
-	std::vector<TiltDirection> solution;
-	bool solutionFound = Board::Solve(b, solution);
-	if(solutionFound)
+	//Count the shortest solutions
+	if(vm.count("count_solutions"))
 	{
-		for(size_t i = 0; i < solution.size(); ++i)
+		ShortestSolutionsGraph graph;
+		if(!ShortestSolutionsGraph::Build(Board2(puzzle.boardSize, puzzle.balls, puzzle.holes, puzzle.walls), graph))
+		{
+			std::cout << "X" << std::endl;
+			return 0;
+		}
+		std::cout << graph.CountSolutions() << std::endl;
+		ShortestSolutionsGraph::Enumerator enumerator(graph);
+		std::vector<TiltDirection> solution;
+		for(size_t i = 0; i < vm["enumerate"].as<size_t>() && enumerator.Next(solution); ++i)
 		{
-			switch(solution[i])
+			for(size_t j = 0; j < solution.size(); ++j)
 			{
-				case East:
-					std::cout << "E ";
-					break;
-				case West:
-					std::cout << "W ";
-					break;
-				case North:
-					std::cout << "N ";
-					break;
-				case South:
-					std::cout << "S ";
-					break;
-				default:
-					std::cerr << "Unexpected value in the solution!" << std::endl;
-					return 4;
+				std::cout << DirectionToLetter(solution[j]) << " ";
 			}
+			std::cout << std::endl;
+		}
+		return 0;
+	}
+
+	//Solve the game (all the engines but best_first and compact search the states in the same order, so they find the same shortest solution)
+	std::vector<TiltDirection> solution;
+	bool solutionFound = false;
+	if(vm.count("portfolio"))
+	{
+		std::vector<std::string> engines;
+		std::istringstream enginesList(vm["portfolio"].as<std::string>());
+		std::string engine;
+		while(std::getline(enginesList, engine, ','))
+		{
+			engines.push_back(engine);
+		}
+		PortfolioSolver portfolio(engines, memoryLimit);
+		SolveStatistics statistics;
+		solutionFound = portfolio.Solve(puzzle, solution, statistics);
+		//the solution alone goes to the standard output
+		std::cerr << "Answered by " << statistics.winner << ", wins:";
+		for(std::map<std::string, size_t>::const_iterator it = statistics.engineWins.begin(); it != statistics.engineWins.end(); ++it)
+		{
+			std::cerr << " " << it->first << " " << it->second;
 		}
+		std::cerr << std::endl;
+	}
+	else if(vm.count("checkpoint"))
+	{
+		SolveStatistics statistics;
+		solutionFound = CheckpointedSolver::Solve(puzzle, vm["checkpoint"].as<std::string>(), vm["checkpoint_interval"].as<size_t>(), solution, statistics);
 	}
 	else
 	{
-		std::cout << "X";
+		std::string engineName(vm["engine"].as<std::string>());
+		if("auto" == engineName)
+		{
+			CalibrationTable calibration(GetDefaultCalibration());
+			if(vm.count("calibration"))
+			{
+				std::string calibrationFileName(vm["calibration"].as<std::string>());
+				std::ifstream calibrationFile(calibrationFileName);
+				if(!calibrationFile.is_open())
+				{
+					std::cerr << "Error while openning the calibration file: " << calibrationFileName << std::endl;
+					return 3;
+				}
+				calibration = ReadCalibration(calibrationFile);
+			}
+			engineName = ChooseEngine(PuzzleView(puzzle), calibration, memoryLimit);
+		}
+		SolveStatistics statistics;
+		solutionFound = CreateEngine(engineName, PuzzleView(puzzle))->Solve(solution, statistics);
 	}
-	std::cout << std::endl;
-
-	return 0;
+	return PrintSolution(solutionFound, solution);
 }
 catch(const std::exception& e)
 {
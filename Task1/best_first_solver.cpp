@@ -0,0 +1,107 @@
+#include "stdafx.h"
+#include "best_first_solver.h"
+#include "successor_generator.h"
+#include "trace.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, South, East, North};
+	const size_t g_directionsCount = sizeof(g_directions) / sizeof(g_directions[0]);
+
+	size_t CountBalls(const PackedState &state)
+	{
+		return state.size() - std::count(state.begin(), state.end(), SunkBall);
+	}
+}
+
+bool BestFirstSolver::QueueEntry::operator>(const QueueEntry &other) const
+{
+	if(ballsLeft != other.ballsLeft)
+	{
+		return ballsLeft > other.ballsLeft;
+	}
+	if(depth != other.depth)
+	{
+		return depth > other.depth;
+	}
+	return node > other.node;
+}
+
+bool BestFirstSolver::Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+{
+	TRACE_SCOPE("BestFirstSolver::Solve");
+	statistics = SolveStatistics();
+	solution.clear();
+	if(originalBoard.IsGameLost())
+	{
+		return false;
+	}
+	if(originalBoard.IsGameWon())
+	{
+		return true;
+	}
+	SuccessorGenerator generator(originalBoard);
+	std::vector<PackedState> states(1);
+	originalBoard.GetPackedState(states[0]);
+	std::vector<Node> nodes(1);
+	nodes[0].parent = 0;
+	nodes[0].tilt = West;
+	std::set<PackedState> statesMet;
+	statesMet.insert(states[0]);
+	std::priority_queue<QueueEntry, std::vector<QueueEntry>, std::greater<QueueEntry>> queue;
+	QueueEntry start = {CountBalls(states[0]), 0, 0};
+	queue.push(start);
+	statistics.boardsQueued = 1;
+	statistics.maxQueueSize = 1;
+
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	while(!queue.empty())
+	{
+		if(cancellation)
+		{
+			cancellation->Check();
+		}
+		QueueEntry entry = queue.top();
+		queue.pop();
+		generator.Expand(states[entry.node], successors);
+		for(size_t i = 0; i < g_directionsCount; ++i)
+		{
+			const SuccessorGenerator::Successor &successor = successors[g_directions[i]];
+			++statistics.boardsQueued;
+			if(SuccessorGenerator::Lost == successor.outcome)
+			{
+				continue;
+			}
+			if(SuccessorGenerator::Won == successor.outcome)
+			{
+				RestoreSolution(nodes, entry.node, solution);
+				solution.push_back(g_directions[i]);
+				statistics.statesMet = statesMet.size();
+				return true;
+			}
+			const PackedState &child = successor.state;
+			if(!statesMet.insert(child).second)
+			{
+				continue;
+			}
+			Node node = {entry.node, g_directions[i]};
+			nodes.push_back(node);
+			states.push_back(child);
+			QueueEntry next = {CountBalls(child), entry.depth + 1, nodes.size() - 1};
+			queue.push(next);
+		}
+		statistics.maxQueueSize = std::max(statistics.maxQueueSize, queue.size());
+	}
+	statistics.statesMet = statesMet.size();
+	return false;
+}
+
+void BestFirstSolver::RestoreSolution(const std::vector<Node> &nodes, size_t node, std::vector<TiltDirection> &solution)
+{
+	solution.clear();
+	for(; node != 0; node = nodes[node].parent)
+	{
+		solution.push_back(nodes[node].tilt);
+	}
+	std::reverse(solution.begin(), solution.end());
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "board2.h"
+
+//The class BestFirstSolver is an informed search for the deep puzzles: the states with fewer balls left are expanded first
+//(and of them the ones closer to the start), so the search dives to sinking the balls instead of going through all the short tilts sequences.
+//It meets all the reachable states before it tells that the puzzle is unsolvable, as the breadth-first search does,
+//but the found solution is not necessary the shortest one.
+class BestFirstSolver
+{
+public:
+	//throws SolveCancelled when the cancellation (if any) is requested
+	static bool Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation = 0);
+
+private:
+	//the met state with the link to the state it was reached from
+	struct Node
+	{
+		size_t parent;
+		TiltDirection tilt;
+	};
+	//the node to expand: the fewer balls and then the less depth go first, the equal ones in the order they were met
+	struct QueueEntry
+	{
+		size_t ballsLeft;
+		size_t depth;
+		size_t node;
+
+		bool operator>(const QueueEntry &other) const;
+	};
+
+	static void RestoreSolution(const std::vector<Node> &nodes, size_t node, std::vector<TiltDirection> &solution);
+};
@@ -0,0 +1,94 @@
+#include "stdafx.h"
+#include "big_unsigned.h"
+
+BigUnsigned::BigUnsigned(unsigned long long value)
+	:m_digits()
+{
+	while(value)
+	{
+		m_digits.push_back(static_cast<unsigned int>(value & 0xFFFFFFFF));
+		value >>= 32;
+	}
+}
+
+BigUnsigned& BigUnsigned::operator+=(const BigUnsigned &other)
+{
+	if(m_digits.size() < other.m_digits.size())
+	{
+		m_digits.resize(other.m_digits.size());
+	}
+	unsigned long long carry = 0;
+	for(size_t i = 0; i < m_digits.size(); ++i)
+	{
+		unsigned long long sum = carry + m_digits[i] + (i < other.m_digits.size() ? other.m_digits[i] : 0);
+		m_digits[i] = static_cast<unsigned int>(sum & 0xFFFFFFFF);
+		carry = sum >> 32;
+		//nothing is left to add
+		if(!carry && i >= other.m_digits.size())
+		{
+			break;
+		}
+	}
+	if(carry)
+	{
+		m_digits.push_back(static_cast<unsigned int>(carry));
+	}
+	return *this;
+}
+
+bool BigUnsigned::operator==(const BigUnsigned &other) const
+{
+	return m_digits == other.m_digits;
+}
+
+bool BigUnsigned::operator!=(const BigUnsigned &other) const
+{
+	return m_digits != other.m_digits;
+}
+
+bool BigUnsigned::IsZero() const
+{
+	return m_digits.empty();
+}
+
+std::string BigUnsigned::ToString() const
+{
+	if(IsZero())
+	{
+		return "0";
+	}
+
+	//divide by 10^9 repeatedly, collecting the decimal groups from the least significant one
+	std::vector<unsigned int> quotient(m_digits);
+	std::vector<unsigned int> decimalGroups;
+	while(!quotient.empty())
+	{
+		unsigned long long remainder = 0;
+		for(size_t i = quotient.size(); i-- > 0; )
+		{
+			unsigned long long current = (remainder << 32) | quotient[i];
+			quotient[i] = static_cast<unsigned int>(current / 1000000000);
+			remainder = current % 1000000000;
+		}
+		decimalGroups.push_back(static_cast<unsigned int>(remainder));
+		while(!quotient.empty() && !quotient.back())
+		{
+			quotient.pop_back();
+		}
+	}
+
+	std::ostringstream result;
+	result << decimalGroups.back();
+	for(size_t i = decimalGroups.size() - 1; i-- > 0; )
+	{
+		result.width(9);
+		result.fill('0');
+		result << decimalGroups[i];
+	}
+	return result.str();
+}
+
+std::ostream& operator<<(std::ostream &output, const BigUnsigned &value)
+{
+	return output << value.ToString();
+}
@@ -0,0 +1,19 @@
+#pragma once
+
+//The class BigUnsigned is an unsigned integer of an arbitrary length (enough for counting paths in the game graphs).
+//The value is stored as a vector of 32-bit digits, the least significant digit first.
+class BigUnsigned
+{
+public:
+	BigUnsigned(unsigned long long value = 0);
+	BigUnsigned& operator+=(const BigUnsigned &other);
+	bool operator==(const BigUnsigned &other) const;
+	bool operator!=(const BigUnsigned &other) const;
+	bool IsZero() const;
+	std::string ToString() const;
+
+private:
+	std::vector<unsigned int> m_digits;
+};
+
+std::ostream& operator<<(std::ostream &output, const BigUnsigned &value);
@@ -1,15 +1,117 @@
 #include "stdafx.h"
 #include "board.h"
+#include "puzzle.h"
+#include "trace.h"
+
+PuzzleView::PuzzleView(const Puzzle &puzzle)
+	:boardSize(puzzle.boardSize)
+	,balls(puzzle.balls.data())
+	,ballsCount(puzzle.balls.size())
+	,holes(puzzle.holes.data())
+	,holesCount(puzzle.holes.size())
+	,walls(puzzle.walls.data())
+	,wallsCount(puzzle.walls.size())
+{
+}
+
+PuzzleView::PuzzleView(size_t boardSize, const std::vector<Position> &balls, const std::vector<Position> &holes, const std::vector<std::pair<Position, Position>> &walls)
+	:boardSize(boardSize)
+	,balls(balls.data())
+	,ballsCount(balls.size())
+	,holes(holes.data())
+	,holesCount(holes.size())
+	,walls(walls.data())
+	,wallsCount(walls.size())
+{
+}
+
+void ValidatePuzzle(const PuzzleView &puzzle)
+{
+	TRACE_SCOPE("ValidatePuzzle");
+	//check board size is positive
+	if(!puzzle.boardSize)
+	{
+		throw std::invalid_argument("boardSize should be possitive");
+	}
+
+	//check balls count equals holes count
+	if(puzzle.ballsCount != puzzle.holesCount)
+	{
+		throw std::invalid_argument("balls count should be equal to holes count");
+	}
+
+	//check balls and holes positions fit the board size
+	auto notOnTheBoard = boost::not1(boost::bind2nd(boost::mem_fun_ref(&Position::IsOnABoard), puzzle.boardSize));
+	if(std::any_of(puzzle.balls, puzzle.balls + puzzle.ballsCount, notOnTheBoard))
+	{
+		throw std::domain_error("balls positions should be on the board");
+	}
+	if(std::any_of(puzzle.holes, puzzle.holes + puzzle.holesCount, notOnTheBoard))
+	{
+		throw std::domain_error("holes positions should be on the board");
+	}
+
+	//check balls and holes positions are unique: after the sort the same positions are adjacent
+	//(the second element tells the holes from the balls)
+	std::vector<std::pair<Position, bool>> positions;
+	positions.reserve(puzzle.ballsCount + puzzle.holesCount);
+	for(size_t i = 0; i < puzzle.ballsCount; ++i)
+	{
+		positions.push_back(std::make_pair(puzzle.balls[i], false));
+	}
+	for(size_t i = 0; i < puzzle.holesCount; ++i)
+	{
+		positions.push_back(std::make_pair(puzzle.holes[i], true));
+	}
+	std::sort(positions.begin(), positions.end());
+	for(size_t i = 1; i < positions.size(); ++i)
+	{
+		if(!(positions[i - 1].first == positions[i].first))
+		{
+			continue;
+		}
+		if(positions[i - 1].second != positions[i].second)
+		{
+			throw std::domain_error("balls positions should not intersect with holes positions");
+		}
+		throw std::domain_error(positions[i].second ? "holes positions should be different" : "balls positions should be different");
+	}
+
+	//check walls positions fit the board size and are placed on the border of the cells
+	for(size_t i = 0; i < puzzle.wallsCount; ++i)
+	{
+		const Position &wallBegin = puzzle.walls[i].first;
+		const Position &wallEnd = puzzle.walls[i].second;
+		if(!(wallBegin.IsOnABoard(puzzle.boardSize) && wallEnd.IsOnABoard(puzzle.boardSize)))
+		{
+			throw std::domain_error("walls positions should be on the board");
+		}
+		if(!(wallBegin.row == wallEnd.row && 1 == (std::max(wallBegin.column, wallEnd.column) - std::min(wallBegin.column, wallEnd.column))) &&
+		   !(wallBegin.column == wallEnd.column && 1 == (std::max(wallBegin.row, wallEnd.row) - std::min(wallBegin.row, wallEnd.row))))
+		{
+			throw std::domain_error("walls positions should be placed on the border of the cells");
+		}
+	}
+}
 
 bool Board::Solve(const Board &originalBoard, std::vector<TiltDirection> &solution)
 {
+	TRACE_SCOPE("Solve");
 	std::deque<Board> boardsQueue;
 	std::deque<BoardStateDigest> statesMet;
 	boardsQueue.push_back(originalBoard);
 
+	//the boards are queued in the order of their tilts sequences length, so a layer ends when the length changes
+	TRACE_NAMED_SCOPE(layerScope, "Layer");
+	size_t layerDepth = 0;
 	while(!boardsQueue.empty())
 	{
 		Board &curBoard = boardsQueue.front();
+		if(curBoard.GetTiltsSequence().size() != layerDepth)
+		{
+			layerDepth = curBoard.GetTiltsSequence().size();
+			TRACE_RESTART(layerScope);
+		}
 		if(curBoard.IsGameWon())
 		{
 			solution.resize(curBoard.GetTiltsSequence().size());
@@ -17,8 +119,15 @@ bool Board::Solve(const Board &originalBoard, std::vector<TiltDirection> &soluti
 			return true;
 		}
 		//if the game is not lost and we didn't meet the cycle (returned to a previous state)
-		if(!curBoard.IsGameLost() && !std::any_of(statesMet.begin(), statesMet.end(), boost::bind1st(std::equal_to<BoardStateDigest>(), curBoard.GetStateDigest())))
+		bool isNewState = false;
+		if(!curBoard.IsGameLost())
+		{
+			TRACE_SCOPE("Dedup");
+			isNewState = !std::any_of(statesMet.begin(), statesMet.end(), boost::bind1st(std::equal_to<BoardStateDigest>(), curBoard.GetStateDigest()));
+		}
+		if(isNewState)
 		{
+			TRACE_SCOPE("TiltBatch");
 			statesMet.push_back(curBoard.GetStateDigest());
 			boardsQueue.push_back(curBoard);
 			boardsQueue.back().TiltWest();
@@ -34,92 +143,56 @@ bool Board::Solve(const Board &originalBoard, std::vector<TiltDirection> &soluti
 	return false;
 }
 
-Board::Board( size_t boardSize, std::vector<Position> balls, std::vector<Position> holes, std::vector<std::pair<Position, Position>> walls )
+Board::Board(size_t boardSize, const std::vector<Position> &balls, const std::vector<Position> &holes, const std::vector<std::pair<Position, Position>> &walls)
 	:m_isGameWon(false)
 	,m_isGameLost(false)
 	,m_tilts()
 	,m_cells()
 	,m_stateDigest()
 {
-	//check board size is positive
-	if(!boardSize)
-	{
-		throw std::invalid_argument("boardSize should be possitive");
-	}
-
-	//check balls count equals holes count
-	if(balls.size() != holes.size())
-	{
-		throw std::invalid_argument("balls count should be equal to holes count");
-	}
+	Initialize(PuzzleView(boardSize, balls, holes, walls), UntrustedPuzzle);
+}
 
-	//check balls and holes positions fit the board size
-	auto notOnTheBoard = boost::not1(boost::bind2nd(boost::mem_fun_ref(&Position::IsOnABoard), boardSize));
-	if(std::any_of(balls.begin(), balls.end(), notOnTheBoard))
-	{
-		throw std::domain_error("balls positions should be on the board");
-	}
-	if(std::any_of(holes.begin(), holes.end(), notOnTheBoard))
-	{
-		throw std::domain_error("holes positions should be on the board");
-	}
-	
-	//check balls and holes positions are unique
-	for(std::vector<Position>::iterator it = balls.begin(); it != balls.end(); )
-	{
-		auto equalToCurrent = boost::bind1st(std::equal_to<Position>(), *it);
-		if(std::any_of(++it, balls.end(), equalToCurrent))
-		{
-			throw std::domain_error("balls positions should be different");
-		}
-		if(std::any_of(holes.begin(), holes.end(), equalToCurrent))
-		{
-			throw std::domain_error("balls positions should not intersect with holes positions");
-		}
-	}
-	for(std::vector<Position>::iterator it = holes.begin(); it != holes.end(); )
-	{
-		auto equalToCurrent = boost::bind1st(std::equal_to<Position>(), *it);
-		if(std::any_of(++it, holes.end(), equalToCurrent))
-		{
-			throw std::domain_error("holes positions should be different");
-		}
-	}
+Board::Board(const PuzzleView &puzzle, PuzzleTrust trust)
+	:m_isGameWon(false)
+	,m_isGameLost(false)
+	,m_tilts()
+	,m_cells()
+	,m_stateDigest()
+{
+	Initialize(puzzle, trust);
+}
 
-	//check walls positions fit the board size and are placed on the border of the cells
-	for(std::vector<std::pair<Position, Position>>::iterator it = walls.begin(); it != walls.end(); ++it)
+void Board::Initialize(const PuzzleView &puzzle, PuzzleTrust trust)
+{
+	TRACE_SCOPE("Board::Board");
+	if(UntrustedPuzzle == trust)
 	{
-		const Position &wallBegin = it->first;
-		const Position &wallEnd = it->second;
-		if(!(wallBegin.IsOnABoard(boardSize) && wallEnd.IsOnABoard(boardSize)))
-		{
-			throw std::domain_error("walls positions should be on the board");
-		}
-		if(!(wallBegin.row == wallEnd.row && 1 == (std::max(wallBegin.column, wallEnd.column) - std::min(wallBegin.column, wallEnd.column))) &&
-		   !(wallBegin.column == wallEnd.column && 1 == (std::max(wallBegin.row, wallEnd.row) - std::min(wallBegin.row, wallEnd.row))))
-		{
-			throw std::domain_error("walls positions should be placed on the border of the cells");
-		}
+		ValidatePuzzle(puzzle);
 	}
+	size_t boardSize = puzzle.boardSize;
+	const Position *balls = puzzle.balls;
+	const Position *holes = puzzle.holes;
+	const std::pair<Position, Position> *walls = puzzle.walls;
 
 	//initialize the cells
 	m_cells.resize(2 * boardSize - 1, 2 * boardSize - 1, false);
 	//place the balls
-	for(size_t i = 0; i < balls.size(); ++i)
+	for(size_t i = 0; i < puzzle.ballsCount; ++i)
 	{
 		Cell &c = m_cells(2 * balls[i].row, 2 * balls[i].column);
 		c.type = Cell::Ball;
 		c.attribute = i;
 	}
 	//place the holes
-	for(size_t i = 0; i < holes.size(); ++i)
+	for(size_t i = 0; i < puzzle.holesCount; ++i)
 	{
 		Cell &c = m_cells(2 * holes[i].row, 2 * holes[i].column);
 		c.type = Cell::Hole;
 		c.attribute = i;
 	}
 	//place the walls
-	for(size_t i = 0; i < walls.size(); ++i)
+	for(size_t i = 0; i < puzzle.wallsCount; ++i)
 	{
 		const Position &wallBegin = walls[i].first;
 		const Position &wallEnd = walls[i].second;
@@ -134,7 +207,7 @@ Board::Board( size_t boardSize, std::vector<Position> balls, std::vector<Positio
 	}
 
 	//fill the state digest
-	for(size_t i = 0; i < balls.size(); ++i)
+	for(size_t i = 0; i < puzzle.ballsCount; ++i)
 	{
 		m_stateDigest[i] = Position(balls[i].row * 2, balls[i].column * 2);
 	}
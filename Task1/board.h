@@ -16,6 +16,10 @@ struct Position
 	{
 		return row == other.row && column == other.column;
 	}
+	bool operator<(const Position &other) const
+	{
+		return row < other.row || (row == other.row && column < other.column);
+	}
 	bool IsOnABoard(size_t boardSize) const
 	{
 		return row < boardSize && column < boardSize;
@@ -24,6 +28,32 @@ struct Position
 
 enum TiltDirection {West, East, North, South};
 
+struct Puzzle;
+
+//The struct PuzzleView refers to the game parameters kept elsewhere (in a Puzzle, a cache or the generator's arrays),
+//so the boards can be built from them without copying.
+struct PuzzleView
+{
+	size_t boardSize;
+	const Position *balls;
+	size_t ballsCount;
+	const Position *holes;
+	size_t holesCount;
+	const std::pair<Position, Position> *walls;
+	size_t wallsCount;
+
+	explicit PuzzleView(const Puzzle &puzzle);
+	PuzzleView(size_t boardSize, const std::vector<Position> &balls, const std::vector<Position> &holes, const std::vector<std::pair<Position, Position>> &walls);
+};
+
+//The boards validate the game parameters unless they are trusted (come from the generator or were validated before).
+enum PuzzleTrust {UntrustedPuzzle, TrustedPuzzle};
+
+//Checks the game parameters as the boards' constructors need them: invalid_argument is thrown for the wrong sizes,
+//domain_error for the wrong positions (out of the board, not unique, walls not on the borders of the cells).
+//Takes O(n log n) for n balls and holes and O(k) for k walls.
+void ValidatePuzzle(const PuzzleView &puzzle);
+
 //The class BoardStateDigest is used to store and compare the state of the board though the game.
 //As during the game walls and holes do not move and holes disapear only with the corresponding balls
 //for a given game (a board instance) we can describe the board state by the positions of the balls left on it.
@@ -68,7 +98,8 @@ class Board
 public:
 	static bool Solve(const Board &originalBoard, std::vector<TiltDirection> &solution);
 
-	Board(size_t boardSize, std::vector<Position> balls, std::vector<Position> holes, std::vector<std::pair<Position, Position>> walls);
+	Board(size_t boardSize, const std::vector<Position> &balls, const std::vector<Position> &holes, const std::vector<std::pair<Position, Position>> &walls);
+	explicit Board(const PuzzleView &puzzle, PuzzleTrust trust = UntrustedPuzzle);
 	bool IsGameWon() const;
 	bool IsGameLost() const;
 	//all below methods thow logic_error when game is lost
@@ -91,6 +122,8 @@ private:
 		size_t attribute;	//attribute of the object in a cell (balls and holes numbers)
 	};
 
+	void Initialize(const PuzzleView &puzzle, PuzzleTrust trust);
+
 	bool m_isGameWon;
 	bool m_isGameLost;
 	std::vector<TiltDirection> m_tilts;
@@ -1,131 +1,256 @@
 #include "stdafx.h"
 #include "board2.h"
+#include "successor_generator.h"
+#include "trace.h"
 
-bool Board2::Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution)
+namespace
 {
-	std::deque<Board2> boardsQueue;
-	std::deque<BoardStateDigest> statesMet;
-	boardsQueue.push_back(originalBoard);
+	const TiltDirection g_directions[] = {West, South, East, North};
+	const size_t g_directionsCount = sizeof(g_directions) / sizeof(g_directions[0]);
+	const size_t NoNode = static_cast<size_t>(-1);
+
+	//a board of the queue of the search: the state and the outcome of the tilt which has made it
+	//and the expanded state it is a tilt of (NoNode for the original board)
+	struct QueuedState
+	{
+		PackedState state;
+		SuccessorGenerator::Outcome outcome;
+		size_t parent;
+		TiltDirection tilt;
+		size_t depth;
+	};
 
-	while(!boardsQueue.empty())
+	//appends the tilts from the original board to the queued state to the solution
+	//(each expanded state keeps the expanded state it is a tilt of and the tilt)
+	void RestoreTilts(const std::vector<std::pair<size_t, TiltDirection>> &expanded, size_t parent, TiltDirection tilt, std::vector<TiltDirection> &solution)
 	{
-		Board2 &curBoard = boardsQueue.front();
-		if(curBoard.IsGameWon())
+		std::vector<TiltDirection> tilts;
+		for(; NoNode != parent; parent = expanded[parent].first)
 		{
-			solution.resize(curBoard.GetTiltsSequence().size());
-			std::copy(curBoard.GetTiltsSequence().begin(), curBoard.GetTiltsSequence().end(), solution.begin());
-			return true;
+			tilts.push_back(tilt);
+			tilt = expanded[parent].second;
 		}
-		//if the game is not lost and we didn't meet the cycle (returned to a previous state)
-		if(!curBoard.IsGameLost() && !std::any_of(statesMet.begin(), statesMet.end(), boost::bind1st(std::equal_to<BoardStateDigest>(), curBoard.GetStateDigest())))
+		solution.insert(solution.end(), tilts.rbegin(), tilts.rend());
+	}
+
+	//the search for the board whose states can't be packed (with 65536 cells), the queue keeps the copies of the board
+	bool SolveByBoards(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+	{
+		std::deque<Board2> boardsQueue;
+		std::set<BoardStateDigest> statesMet;
+		boardsQueue.push_back(originalBoard);
+		statistics.boardsQueued = 1;
+		statistics.maxQueueSize = 1;
+
+		//the boards are queued in the order of their tilts sequences length, so a layer ends when the length changes
+		TRACE_NAMED_SCOPE(layerScope, "Layer");
+		size_t layerDepth = 0;
+		while(!boardsQueue.empty())
 		{
-			statesMet.push_back(curBoard.GetStateDigest());
-			boardsQueue.push_back(curBoard);
-			boardsQueue.back().Tilt(West);
-			boardsQueue.push_back(curBoard);
-			boardsQueue.back().Tilt(South);
-			boardsQueue.push_back(curBoard);
-			boardsQueue.back().Tilt(East);
-			boardsQueue.push_back(curBoard);
-			boardsQueue.back().Tilt(North);
+			Board2 &curBoard = boardsQueue.front();
+			if(curBoard.GetTiltsSequence().size() != layerDepth)
+			{
+				layerDepth = curBoard.GetTiltsSequence().size();
+				TRACE_RESTART(layerScope);
+			}
+			if(curBoard.IsGameWon())
+			{
+				solution.resize(curBoard.GetTiltsSequence().size());
+				std::copy(curBoard.GetTiltsSequence().begin(), curBoard.GetTiltsSequence().end(), solution.begin());
+				statistics.statesMet = statesMet.size();
+				return true;
+			}
+			//if the game is not lost and we didn't meet the cycle (returned to a previous state)
+			bool isNewState = false;
+			if(!curBoard.IsGameLost())
+			{
+				if(cancellation)
+				{
+					cancellation->Check();
+				}
+				TRACE_SCOPE("Dedup");
+				isNewState = statesMet.insert(curBoard.GetStateDigest()).second;
+			}
+			if(isNewState)
+			{
+				TRACE_SCOPE("TiltBatch");
+				boardsQueue.push_back(curBoard);
+				boardsQueue.back().Tilt(West);
+				boardsQueue.push_back(curBoard);
+				boardsQueue.back().Tilt(South);
+				boardsQueue.push_back(curBoard);
+				boardsQueue.back().Tilt(East);
+				boardsQueue.push_back(curBoard);
+				boardsQueue.back().Tilt(North);
+				statistics.boardsQueued += 4;
+				statistics.maxQueueSize = std::max(statistics.maxQueueSize, boardsQueue.size());
+			}
+			boardsQueue.pop_front();
 		}
-		boardsQueue.pop_front();
+		statistics.statesMet = statesMet.size();
+		return false;
 	}
-	return false;
 }
 
-Board2::Board2( size_t boardSize, std::vector<Position> balls, std::vector<Position> holes, std::vector<std::pair<Position, Position>> walls )
-	:m_isGameWon(false)
-	,m_isGameLost(false)
-	,m_tilts()
-	,m_boardSize()
-	,m_cells()
-	,m_horizontallyAdjacentCells()
-	,m_verticallyAdjacentCells()
-	,m_stateDigest()
+bool Board2::Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution)
 {
-	//check board size is positive
-	if(!boardSize)
-	{
-		throw std::invalid_argument("boardSize should be possitive");
-	}
+	SolveStatistics statistics;
+	return Solve(originalBoard, solution, statistics);
+}
 
-	//check balls count equals holes count
-	if(balls.size() != holes.size())
+bool Board2::Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+{
+	TRACE_SCOPE("Solve");
+	statistics = SolveStatistics();
+	if(originalBoard.GetBoardSize() * originalBoard.GetBoardSize() > SunkBall)
 	{
-		throw std::invalid_argument("balls count should be equal to holes count");
+		return SolveByBoards(originalBoard, solution, statistics, cancellation);
 	}
-
-	//check balls and holes positions fit the board size
-	auto notOnTheBoard = boost::not1(boost::bind2nd(boost::mem_fun_ref(&Position::IsOnABoard), boardSize));
-	if(std::any_of(balls.begin(), balls.end(), notOnTheBoard))
+	//the queue and the statistics are the same as of the copies of the board, but the states are packed and tilted by the generator
+	SuccessorGenerator generator(originalBoard);
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	std::deque<QueuedState> statesQueue;
+	std::set<PackedState> statesMet;
+	std::vector<std::pair<size_t, TiltDirection>> expanded;
+	QueuedState original = {PackedState(), SuccessorGenerator::Moved, NoNode, West, 0};
+	if(originalBoard.IsGameLost())
 	{
-		throw std::domain_error("balls positions should be on the board");
+		original.outcome = SuccessorGenerator::Lost;
 	}
-	if(std::any_of(holes.begin(), holes.end(), notOnTheBoard))
+	else
 	{
-		throw std::domain_error("holes positions should be on the board");
+		original.outcome = originalBoard.IsGameWon() ? SuccessorGenerator::Won : SuccessorGenerator::Moved;
+		original.depth = originalBoard.GetTiltsSequence().size();
+		originalBoard.GetPackedState(original.state);
 	}
-	
-	//check balls and holes positions are unique
-	for(std::vector<Position>::iterator it = balls.begin(); it != balls.end(); )
+	statesQueue.push_back(original);
+	statistics.boardsQueued = 1;
+	statistics.maxQueueSize = 1;
+
+	//the states are queued in the order of their tilts sequences length, so a layer ends when the length changes
+	TRACE_NAMED_SCOPE(layerScope, "Layer");
+	size_t layerDepth = 0;
+	while(!statesQueue.empty())
 	{
-		auto equalToCurrent = boost::bind1st(std::equal_to<Position>(), *it);
-		if(std::any_of(++it, balls.end(), equalToCurrent))
+		QueuedState &curState = statesQueue.front();
+		if(curState.depth != layerDepth)
 		{
-			throw std::domain_error("balls positions should be different");
+			layerDepth = curState.depth;
+			TRACE_RESTART(layerScope);
 		}
-		if(std::any_of(holes.begin(), holes.end(), equalToCurrent))
+		if(SuccessorGenerator::Won == curState.outcome)
 		{
-			throw std::domain_error("balls positions should not intersect with holes positions");
+			solution = originalBoard.GetTiltsSequence();
+			RestoreTilts(expanded, curState.parent, curState.tilt, solution);
+			statistics.statesMet = statesMet.size();
+			return true;
 		}
-	}
-	for(std::vector<Position>::iterator it = holes.begin(); it != holes.end(); )
-	{
-		auto equalToCurrent = boost::bind1st(std::equal_to<Position>(), *it);
-		if(std::any_of(++it, holes.end(), equalToCurrent))
+		//if the game is not lost and we didn't meet the cycle (returned to a previous state)
+		bool isNewState = false;
+		if(SuccessorGenerator::Lost != curState.outcome)
+		{
+			if(cancellation)
+			{
+				cancellation->Check();
+			}
+			TRACE_SCOPE("Dedup");
+			isNewState = statesMet.insert(curState.state).second;
+		}
+		if(isNewState)
 		{
-			throw std::domain_error("holes positions should be different");
+			TRACE_SCOPE("TiltBatch");
+			generator.Expand(curState.state, successors);
+			expanded.push_back(std::make_pair(curState.parent, curState.tilt));
+			for(size_t i = 0; i < g_directionsCount; ++i)
+			{
+				const SuccessorGenerator::Successor &successor = successors[g_directions[i]];
+				QueuedState child = {successor.state, successor.outcome, expanded.size() - 1, g_directions[i], curState.depth + 1};
+				statesQueue.push_back(child);
+			}
+			statistics.boardsQueued += 4;
+			statistics.maxQueueSize = std::max(statistics.maxQueueSize, statesQueue.size());
 		}
+		statesQueue.pop_front();
 	}
+	statistics.statesMet = statesMet.size();
+	return false;
+}
 
-	//check walls positions fit the board size and are placed on the border of the cells
-	for(std::vector<std::pair<Position, Position>>::iterator it = walls.begin(); it != walls.end(); ++it)
+Board2::Board2(size_t boardSize, const std::vector<Position> &balls, const std::vector<Position> &holes, const std::vector<std::pair<Position, Position>> &walls)
+	:m_isGameWon(false)
+	,m_isGameLost(false)
+	,m_tilts()
+	,m_boardSize()
+	,m_cells()
+	,m_columnMajorCells()
+	,m_layout()
+	,m_stateDigest()
+	,m_sequencesBalls()
+	,m_isJournaling(false)
+	,m_journal()
+	,m_journalTilts()
+{
+	Initialize(PuzzleView(boardSize, balls, holes, walls), UntrustedPuzzle);
+}
+
+Board2::Board2(const PuzzleView &puzzle, PuzzleTrust trust)
+	:m_isGameWon(false)
+	,m_isGameLost(false)
+	,m_tilts()
+	,m_boardSize()
+	,m_cells()
+	,m_columnMajorCells()
+	,m_layout()
+	,m_stateDigest()
+	,m_sequencesBalls()
+	,m_isJournaling(false)
+	,m_journal()
+	,m_journalTilts()
+{
+	Initialize(puzzle, trust);
+}
+
+void Board2::Initialize(const PuzzleView &puzzle, PuzzleTrust trust)
+{
+	TRACE_SCOPE("Board2::Board2");
+	if(UntrustedPuzzle == trust)
 	{
-		const Position &wallBegin = it->first;
-		const Position &wallEnd = it->second;
-		if(!(wallBegin.IsOnABoard(boardSize) && wallEnd.IsOnABoard(boardSize)))
-		{
-			throw std::domain_error("walls positions should be on the board");
-		}
-		if(!(wallBegin.row == wallEnd.row && 1 == (std::max(wallBegin.column, wallEnd.column) - std::min(wallBegin.column, wallEnd.column))) &&
-		   !(wallBegin.column == wallEnd.column && 1 == (std::max(wallBegin.row, wallEnd.row) - std::min(wallBegin.row, wallEnd.row))))
-		{
-			throw std::domain_error("walls positions should be placed on the border of the cells");
-		}
+		ValidatePuzzle(puzzle);
 	}
-	
+	size_t boardSize = puzzle.boardSize;
+	//the cells numbers of the layout are 16 bit
+	if(boardSize > 0x100)
+	{
+		throw std::domain_error("boardSize should not be greater than 256");
+	}
+
+	const Position *balls = puzzle.balls;
+	const Position *holes = puzzle.holes;
+	const std::pair<Position, Position> *walls = puzzle.walls;
+
 	m_boardSize = boardSize;
+	std::shared_ptr<Layout> layout(std::make_shared<Layout>());
 
 	//initialize the cells
 	m_cells.resize(boardSize * boardSize);
 	//place the balls
-	for(size_t i = 0; i < balls.size(); ++i)
+	for(size_t i = 0; i < puzzle.ballsCount; ++i)
 	{
 		Cell &c = m_cells[balls[i].row * boardSize + balls[i].column];
 		c.type = Cell::Ball;
 		c.attribute = i;
 	}
 	//place the holes
-	for(size_t i = 0; i < holes.size(); ++i)
+	for(size_t i = 0; i < puzzle.holesCount; ++i)
 	{
 		Cell &c = m_cells[holes[i].row * boardSize + holes[i].column];;
 		c.type = Cell::Hole;
 		c.attribute = i;
+		layout->holes.push_back(holes[i].row * boardSize + holes[i].column);
 	}
 
 	//fill the state digest
-	for(size_t i = 0; i < balls.size(); ++i)
+	for(size_t i = 0; i < puzzle.ballsCount; ++i)
 	{
 		m_stateDigest[i] = Position(balls[i].row, balls[i].column);
 	}
@@ -133,7 +258,7 @@ Board2::Board2( size_t boardSize, std::vector<Position> balls, std::vector<Posit
 	//partition walls to horizontal and vertical
 	std::vector<std::pair<Position, Position>> horizontalWalls;
 	std::vector<std::pair<Position, Position>> verticalWalls;
-	std::partition_copy(walls.begin(), walls.end(), std::back_inserter(horizontalWalls), std::back_inserter(verticalWalls), [](const std::pair<Position, Position> &wall) {
+	std::partition_copy(walls, walls + puzzle.wallsCount, std::back_inserter(horizontalWalls), std::back_inserter(verticalWalls), [](const std::pair<Position, Position> &wall) {
 		return wall.first.column == wall.second.column;
 	});
 	//make horizontal walls to be set through positions from top to bottom
@@ -168,56 +293,56 @@ Board2::Board2( size_t boardSize, std::vector<Position> balls, std::vector<Posit
 	});
 	//create the list of sequences of the horizontally adjacent cells
 	//(without any vertical walls there would be boardSize sequences of boardSize length each; a vertical wall splits corresponding sequence on two)
-	m_horizontallyAdjacentCells.resize(boardSize + verticalWalls.size());
-	for(size_t adjacentCellsSequenceNum = 0, adjacentCellsRow = 0, adjacentCellsStartColumn = 0; adjacentCellsSequenceNum < m_horizontallyAdjacentCells.size(); ++adjacentCellsSequenceNum)
+	std::vector<size_t> &horizontalOffsets = layout->horizontalOffsets;
+	horizontalOffsets.resize(boardSize + verticalWalls.size() + 1);
+	for(size_t adjacentCellsSequenceNum = 0, adjacentCellsRow = 0, adjacentCellsStartColumn = 0; adjacentCellsSequenceNum + 1 < horizontalOffsets.size(); ++adjacentCellsSequenceNum)
 	{
 		//if current sequence should be split
 		if(adjacentCellsSequenceNum - adjacentCellsRow < verticalWalls.size() && adjacentCellsRow == verticalWalls[adjacentCellsSequenceNum - adjacentCellsRow].second.row)
 		{
-			m_horizontallyAdjacentCells[adjacentCellsSequenceNum].resize(verticalWalls[adjacentCellsSequenceNum - adjacentCellsRow].second.column - adjacentCellsStartColumn);
+			horizontalOffsets[adjacentCellsSequenceNum + 1] = horizontalOffsets[adjacentCellsSequenceNum] + verticalWalls[adjacentCellsSequenceNum - adjacentCellsRow].second.column - adjacentCellsStartColumn;
 			adjacentCellsStartColumn = verticalWalls[adjacentCellsSequenceNum - adjacentCellsRow].second.column;
 		}
 		//current sequence lasts till the end of the row
 		else
 		{
-			m_horizontallyAdjacentCells[adjacentCellsSequenceNum].resize(boardSize - adjacentCellsStartColumn);
+			horizontalOffsets[adjacentCellsSequenceNum + 1] = horizontalOffsets[adjacentCellsSequenceNum] + boardSize - adjacentCellsStartColumn;
 			adjacentCellsStartColumn = 0;
 			++adjacentCellsRow;
 		}
 	}
 	//create the list of sequences of the vertically adjacent cells 
 	//(without any horizontal walls there would be boardSize sequences of boardSize length each; a horizontal wall splits corresponding sequence on two)
-	m_verticallyAdjacentCells.resize(boardSize + horizontalWalls.size());
-	for(size_t adjacentCellsSequenceNum = 0, adjacentCellsColumn = 0, adjacentCellsStartRow = 0; adjacentCellsSequenceNum < m_verticallyAdjacentCells.size(); ++adjacentCellsSequenceNum)
+	std::vector<size_t> &verticalOffsets = layout->verticalOffsets;
+	verticalOffsets.resize(boardSize + horizontalWalls.size() + 1);
+	for(size_t adjacentCellsSequenceNum = 0, adjacentCellsColumn = 0, adjacentCellsStartRow = 0; adjacentCellsSequenceNum + 1 < verticalOffsets.size(); ++adjacentCellsSequenceNum)
 	{
 		//if current sequence should be split
 		if(adjacentCellsSequenceNum - adjacentCellsColumn < horizontalWalls.size() && adjacentCellsColumn == horizontalWalls[adjacentCellsSequenceNum - adjacentCellsColumn].second.column)
 		{
-			m_verticallyAdjacentCells[adjacentCellsSequenceNum].resize(horizontalWalls[adjacentCellsSequenceNum - adjacentCellsColumn].second.row - adjacentCellsStartRow);
+			verticalOffsets[adjacentCellsSequenceNum + 1] = verticalOffsets[adjacentCellsSequenceNum] + horizontalWalls[adjacentCellsSequenceNum - adjacentCellsColumn].second.row - adjacentCellsStartRow;
 			adjacentCellsStartRow = horizontalWalls[adjacentCellsSequenceNum - adjacentCellsColumn].second.row;
 		}
 		//current sequence lasts till the end of the row
 		else
 		{
-			m_verticallyAdjacentCells[adjacentCellsSequenceNum].resize(boardSize - adjacentCellsStartRow);
+			verticalOffsets[adjacentCellsSequenceNum + 1] = verticalOffsets[adjacentCellsSequenceNum] + boardSize - adjacentCellsStartRow;
 			adjacentCellsStartRow = 0;
 			++adjacentCellsColumn;
 		}
 	}
-	FillAdjacentSequencesLists();
-}
-
-Board2::Board2(const Board2 &other)
-	:m_isGameWon(other.m_isGameWon)
-	,m_isGameLost(other.m_isGameLost)
-	,m_tilts(other.m_tilts)
-	,m_boardSize(other.m_boardSize)
-	,m_cells(other.m_cells)
-	,m_horizontallyAdjacentCells(other.m_horizontallyAdjacentCells)
-	,m_verticallyAdjacentCells(other.m_verticallyAdjacentCells)
-	,m_stateDigest(other.m_stateDigest)
-{
-	FillAdjacentSequencesLists();
+	FillAdjacentSequencesLists(boardSize, *layout);
+	FillSequencesShapes(*layout);
+	m_layout = layout;
+	if(!layout->transposedCells.empty())
+	{
+		m_columnMajorCells.resize(m_cells.size());
+		for(size_t i = 0; i < m_cells.size(); ++i)
+		{
+			m_columnMajorCells[layout->transposedCells[i]] = m_cells[i];
+		}
+	}
+	CountSequencesBalls();
 }
 
 void Board2::Tilt(TiltDirection direction)
@@ -229,26 +354,47 @@ void Board2::Tilt(TiltDirection direction)
 	
 	if(m_isGameWon)
 	{
+		if(m_isJournaling)
+		{
+			m_journalTilts.push_back(std::make_pair(m_journal.size(), false));
+		}
 		return;
 	}
+	if(m_isJournaling)
+	{
+		m_journalTilts.push_back(std::make_pair(m_journal.size(), true));
+	}
 
-	std::vector<std::vector<CellsIterator>>::const_iterator adjacentCellsSequencesListBegin;
-	std::vector<std::vector<CellsIterator>>::const_iterator adjacentCellsSequencesListEnd;
+	//the sequences of a list are stored one after another, so a tilt goes through the cells numbers sequentially
+	const std::vector<size_t> *offsets;
+	const unsigned short *cells;
+	const unsigned short *shapes;
+	const unsigned short *sequencesBalls = m_sequencesBalls.data();
+	bool isColumnMajor = false;
 	if(West == direction || East == direction)
 	{
-		adjacentCellsSequencesListBegin = m_horizontallyAdjacentCells.cbegin();
-		adjacentCellsSequencesListEnd = m_horizontallyAdjacentCells.cend();
+		offsets = &m_layout->horizontalOffsets;
+		cells = m_layout->horizontalCells.data();
+		shapes = m_layout->horizontalShapes.data();
 	}
 	else
 	{
-		adjacentCellsSequencesListBegin = m_verticallyAdjacentCells.cbegin();
-		adjacentCellsSequencesListEnd = m_verticallyAdjacentCells.cend();
+		offsets = &m_layout->verticalOffsets;
+		cells = m_layout->verticalCells.data();
+		shapes = m_layout->verticalShapes.data();
+		sequencesBalls += m_layout->horizontalOffsets.size() - 1;
+		isColumnMajor = !m_columnMajorCells.empty();
 	}
+	size_t sequencesCount = offsets->size() - 1;
 	if(West == direction || North == direction)
 	{
-		for(auto adjacentCellsSequenceIt = adjacentCellsSequencesListBegin; adjacentCellsSequenceIt != adjacentCellsSequencesListEnd; ++adjacentCellsSequenceIt)
+		for(size_t i = 0; i < sequencesCount; ++i)
 		{
-			MoveBallsToTheStartingAdjacentCell(adjacentCellsSequenceIt->cbegin(), adjacentCellsSequenceIt->cend());
+			if(!sequencesBalls[i])
+			{
+				continue;
+			}
+			TiltSequence(cells + (*offsets)[i], cells + (*offsets)[i + 1], shapes[2 * i], isColumnMajor);
 			if(m_isGameLost || m_isGameWon)
 			{
 				break;
@@ -257,9 +403,14 @@ void Board2::Tilt(TiltDirection direction)
 	}
 	else
 	{
-		for(auto adjacentCellsSequenceIt = adjacentCellsSequencesListBegin; adjacentCellsSequenceIt != adjacentCellsSequencesListEnd; ++adjacentCellsSequenceIt)
+		typedef std::reverse_iterator<const unsigned short*> ReverseCellsIterator;
+		for(size_t i = 0; i < sequencesCount; ++i)
 		{
-			MoveBallsToTheStartingAdjacentCell(adjacentCellsSequenceIt->crbegin(), adjacentCellsSequenceIt->crend());
+			if(!sequencesBalls[i])
+			{
+				continue;
+			}
+			TiltSequence(ReverseCellsIterator(cells + (*offsets)[i + 1]), ReverseCellsIterator(cells + (*offsets)[i]), shapes[2 * i + 1], isColumnMajor);
 			if(m_isGameLost || m_isGameWon)
 			{
 				break;
@@ -279,6 +430,52 @@ bool Board2::IsGameLost() const
 {
 	return m_isGameLost;
 }
+
+void Board2::SetJournaling(bool isJournaling)
+{
+	m_isJournaling = isJournaling;
+	if(!isJournaling)
+	{
+		m_journal.clear();
+		m_journalTilts.clear();
+	}
+}
+
+void Board2::Undo()
+{
+	if(m_journalTilts.empty())
+	{
+		throw std::logic_error("there is no journaled tilt to undo");
+	}
+	std::pair<size_t, bool> tilt = m_journalTilts.back();
+	m_journalTilts.pop_back();
+	if(!tilt.second)
+	{
+		return;
+	}
+	//take the changes back starting from the last one, so a cell left by a ball is free again when it returns there
+	while(m_journal.size() > tilt.first)
+	{
+		const JournalChange &change = m_journal.back();
+		if(SunkCell == change.toLinearNumber)
+		{
+			SetCell(m_layout->holes[change.ball], Cell(Cell::Hole, change.ball));
+			AddBallCount(change.fromLinearNumber);
+		}
+		else
+		{
+			SetCell(change.toLinearNumber, Cell());
+			MoveBallCount(change.toLinearNumber, change.fromLinearNumber);
+		}
+		SetCell(change.fromLinearNumber, Cell(Cell::Ball, change.ball));
+		m_stateDigest[change.ball] = Position(change.fromLinearNumber / m_boardSize, change.fromLinearNumber % m_boardSize);
+		m_journal.pop_back();
+	}
+	//a tilt is made only on the board which is neither won nor lost
+	m_isGameWon = false;
+	m_isGameLost = false;
+	m_tilts.pop_back();
+}
 const std::vector<TiltDirection>& Board2::GetTiltsSequence() const
 {
 	return m_tilts;
@@ -293,37 +490,291 @@ const BoardStateDigest& Board2::GetStateDigest() const
 	return m_stateDigest;
 }
 
+size_t Board2::GetBoardSize() const
+{
+	return m_boardSize;
+}
+
+void Board2::GetPackedState(PackedState &state) const
+{
+	if(m_isGameLost)
+	{
+		throw std::logic_error("the board is not valid anymore");
+	}
+	if(m_cells.size() > SunkBall)
+	{
+		throw std::domain_error("the board is too large for the packed state");
+	}
+	state.assign(m_layout->holes.size(), SunkBall);
+	for(BoardStateDigest::const_iterator it = m_stateDigest.begin(); it != m_stateDigest.end(); ++it)
+	{
+		state[it->first] = static_cast<unsigned short>(it->second.row * m_boardSize + it->second.column);
+	}
+}
+
+void Board2::SetPackedState(const PackedState &state)
+{
+	if(state.size() != m_layout->holes.size())
+	{
+		throw std::invalid_argument("the state should have a cell for each ball");
+	}
+	if(m_cells.size() > SunkBall)
+	{
+		throw std::domain_error("the board is too large for the packed state");
+	}
+
+	//remove the balls and the holes which are still on the board
+	for(BoardStateDigest::const_iterator it = m_stateDigest.begin(); it != m_stateDigest.end(); ++it)
+	{
+		SetCell(it->second.row * m_boardSize + it->second.column, Cell());
+		SetCell(m_layout->holes[it->first], Cell());
+	}
+	m_stateDigest.clear();
+
+	//place the balls of the state and their holes
+	for(size_t i = 0; i < state.size(); ++i)
+	{
+		if(SunkBall == state[i])
+		{
+			continue;
+		}
+		SetCell(state[i], Cell(Cell::Ball, i));
+		SetCell(m_layout->holes[i], Cell(Cell::Hole, i));
+		m_stateDigest[i] = Position(state[i] / m_boardSize, state[i] % m_boardSize);
+	}
+	m_isGameWon = m_stateDigest.empty();
+	m_isGameLost = false;
+	m_tilts.clear();
+	m_journal.clear();
+	m_journalTilts.clear();
+	CountSequencesBalls();
+}
+
+void Board2::GetAdjacentSequences(TiltDirection direction, std::vector<size_t> &offsets, std::vector<unsigned short> &cells) const
+{
+	bool isHorizontal = West == direction || East == direction;
+	offsets = isHorizontal ? m_layout->horizontalOffsets : m_layout->verticalOffsets;
+	cells = isHorizontal ? m_layout->horizontalCells : m_layout->verticalCells;
+	//the vertical sequences may go through the column-major cells
+	if(!isHorizontal && !m_layout->transposedCells.empty())
+	{
+		for(size_t i = 0; i < cells.size(); ++i)
+		{
+			cells[i] = m_layout->transposedCells[cells[i]];
+		}
+	}
+	if(East == direction || South == direction)
+	{
+		for(size_t i = 0; i + 1 < offsets.size(); ++i)
+		{
+			std::reverse(cells.begin() + offsets[i], cells.begin() + offsets[i + 1]);
+		}
+	}
+}
+
+const std::vector<size_t>& Board2::GetHolesCells() const
+{
+	return m_layout->holes;
+}
+
+void Board2::SetMaxTablesEntries(size_t maxTablesEntries)
+{
+	boost::lock_guard<boost::mutex> lock(m_layout->tablesMutex);
+	m_layout->maxTablesEntries = maxTablesEntries;
+}
+
+size_t Board2::GetTablesEntries() const
+{
+	boost::lock_guard<boost::mutex> lock(m_layout->tablesMutex);
+	return m_layout->tablesEntries;
+}
+
 Board2::Cell::Cell(Value type, size_t attribute)
 	:type(type)
 	,attribute(attribute)
 {
 }
 
-void Board2::FillAdjacentSequencesLists()
+void Board2::FillAdjacentSequencesLists(size_t boardSize, Layout &layout)
 {
-	//fill the horizontally adjacent cells
-	for(size_t i = 0, adjacentCellsSequenceNum = 0, sequenceStartLinearNumber = 0; i < m_cells.size(); ++i)
+	TRACE_SCOPE("FillAdjacentSequencesLists");
+	size_t cellsCount = boardSize * boardSize;
+	//the horizontal sequences go through the rows one after another, so the cells numbers are the linear numbers
+	layout.horizontalCells.resize(cellsCount);
+	for(size_t i = 0; i < cellsCount; ++i)
+	{
+		layout.horizontalCells[i] = static_cast<unsigned short>(i);
+	}
+	//the vertical sequences go through the columns one after another
+	layout.verticalCells.resize(cellsCount);
+	for(size_t i = 0; i < cellsCount; ++i)
+	{
+		size_t row = i % boardSize;
+		size_t column = i / boardSize;
+		layout.verticalCells[i] = static_cast<unsigned short>(row * boardSize + column);
+	}
+	//with the column-major cells the vertical sequences go through them in their order
+	if(boardSize >= ColumnMajorCellsMinBoardSize)
+	{
+		layout.transposedCells.swap(layout.verticalCells);
+		layout.verticalCells = layout.horizontalCells;
+	}
+}
+
+void Board2::FillSequencesShapes(Layout &layout)
+{
+	//the sequences of the cells
+	size_t horizontalSequencesCount = layout.horizontalOffsets.size() - 1;
+	layout.horizontalSequencesOfCells.resize(layout.horizontalCells.size());
+	layout.verticalSequencesOfCells.resize(layout.verticalCells.size());
+	for(size_t i = 0; i < horizontalSequencesCount; ++i)
+	{
+		for(size_t j = layout.horizontalOffsets[i]; j < layout.horizontalOffsets[i + 1]; ++j)
+		{
+			layout.horizontalSequencesOfCells[layout.horizontalCells[j]] = static_cast<unsigned int>(i);
+		}
+	}
+	for(size_t i = 0; i + 1 < layout.verticalOffsets.size(); ++i)
 	{
-		if(i == sequenceStartLinearNumber + m_horizontallyAdjacentCells[adjacentCellsSequenceNum].size())
+		for(size_t j = layout.verticalOffsets[i]; j < layout.verticalOffsets[i + 1]; ++j)
 		{
-			sequenceStartLinearNumber += m_horizontallyAdjacentCells[adjacentCellsSequenceNum].size();
-			++adjacentCellsSequenceNum;
+			size_t linearNumber = layout.transposedCells.empty() ? layout.verticalCells[j] : layout.transposedCells[layout.verticalCells[j]];
+			layout.verticalSequencesOfCells[linearNumber] = static_cast<unsigned int>(horizontalSequencesCount + i);
 		}
-		//size_t row = i / m_boardSize;
-		//size_t column = i % m_boardSize;
-		//(row * boardSize + column == i)
-		m_horizontallyAdjacentCells[adjacentCellsSequenceNum][i - sequenceStartLinearNumber] = m_cells.begin() + i;
 	}
-	//fill the vertically adjacent cells
-	for(size_t i = 0, adjacentCellsSequenceNum = 0, sequenceStartLinearNumber = 0; i < m_cells.size(); ++i)
+
+	std::vector<bool> isHole(layout.horizontalCells.size());
+	for(size_t i = 0; i < layout.holes.size(); ++i)
 	{
-		if(i == sequenceStartLinearNumber + m_verticallyAdjacentCells[adjacentCellsSequenceNum].size())
+		isHole[layout.holes[i]] = true;
+	}
+	std::map<std::pair<size_t, unsigned int>, unsigned short> shapesNumbers;
+	for(size_t isVertical = 0; isVertical < 2; ++isVertical)
+	{
+		const std::vector<size_t> &offsets = isVertical ? layout.verticalOffsets : layout.horizontalOffsets;
+		const std::vector<unsigned short> &cells = isVertical ? layout.verticalCells : layout.horizontalCells;
+		std::vector<unsigned short> &shapes = isVertical ? layout.verticalShapes : layout.horizontalShapes;
+		shapes.assign(2 * (offsets.size() - 1), static_cast<unsigned short>(NoShape));
+		for(size_t i = 0; i + 1 < offsets.size(); ++i)
 		{
-			sequenceStartLinearNumber += m_verticallyAdjacentCells[adjacentCellsSequenceNum].size();
-			++adjacentCellsSequenceNum;
+			size_t length = offsets[i + 1] - offsets[i];
+			//the single cells are not moved through, the long sequences are not in the tables
+			if(length < 2 || length > MaxTableSequenceLength)
+			{
+				continue;
+			}
+			for(size_t isBackward = 0; isBackward < 2; ++isBackward)
+			{
+				unsigned int holesMask = 0;
+				for(size_t place = 0; place < length; ++place)
+				{
+					size_t cell = cells[isBackward ? offsets[i + 1] - 1 - place : offsets[i] + place];
+					size_t linearNumber = isVertical && !layout.transposedCells.empty() ? layout.transposedCells[cell] : cell;
+					holesMask |= isHole[linearNumber] ? 1u << place : 0;
+				}
+				std::pair<size_t, unsigned int> shape(length, holesMask);
+				std::map<std::pair<size_t, unsigned int>, unsigned short>::const_iterator it = shapesNumbers.find(shape);
+				if(shapesNumbers.end() == it)
+				{
+					it = shapesNumbers.insert(std::make_pair(shape, static_cast<unsigned short>(layout.shapes.size()))).first;
+					layout.shapes.push_back(shape);
+				}
+				shapes[2 * i + isBackward] = it->second;
+			}
 		}
-		size_t row = i % m_boardSize;
-		size_t column = i / m_boardSize;
-		m_verticallyAdjacentCells[adjacentCellsSequenceNum][i - sequenceStartLinearNumber] = m_cells.begin() + row * m_boardSize + column;
 	}
-}
\ No newline at end of file
+	layout.tables.reset(new boost::atomic<const SequenceTable*>[layout.shapes.size()]);
+	for(size_t i = 0; i < layout.shapes.size(); ++i)
+	{
+		layout.tables[i].store(0);
+	}
+	layout.tablesEntries = 0;
+	layout.maxTablesEntries = MaxTablesEntries;
+}
+
+const Board2::SequenceTable& Board2::BuildSequenceTable(unsigned short shape) const
+{
+	TRACE_SCOPE("BuildSequenceTable");
+	boost::lock_guard<boost::mutex> lock(m_layout->tablesMutex);
+	const SequenceTable *table = m_layout->tables[shape].load(boost::memory_order_acquire);
+	if(table)
+	{
+		return *table;
+	}
+	std::unique_ptr<SequenceTable> builtTable(new SequenceTable());
+	builtTable->length = m_layout->shapes[shape].first;
+	builtTable->holesMask = m_layout->shapes[shape].second;
+	size_t length = builtTable->length;
+	size_t holesCount = 0;
+	for(size_t place = 0; place < length; ++place)
+	{
+		holesCount += (builtTable->holesMask >> place) & 1;
+	}
+	size_t entriesCount = size_t(1) << (length + holesCount);
+	if(m_layout->tablesEntries + entriesCount <= m_layout->maxTablesEntries)
+	{
+		m_layout->tablesEntries += entriesCount;
+		builtTable->entries.resize(entriesCount);
+		for(size_t key = 0; key < entriesCount; ++key)
+		{
+			//the holes left by their places
+			unsigned int holesLeft = 0;
+			for(size_t place = 0, holeBit = length; place < length; ++place)
+			{
+				if((builtTable->holesMask >> place) & 1)
+				{
+					holesLeft |= ((key >> holeBit++) & 1) << place;
+				}
+			}
+			//each ball falls to the nearest hole left after the previous stopped ball or stops next to it (as if it's sunk, else the game is lost anyway)
+			unsigned long long entry = 0;
+			size_t next = 0;
+			for(size_t place = 0, ballsCount = 0; place < length; ++place)
+			{
+				if(!((key >> place) & 1))
+				{
+					continue;
+				}
+				size_t target = next;
+				for(size_t hole = place; hole > next; --hole)
+				{
+					if((holesLeft >> (hole - 1)) & 1)
+					{
+						target = (hole - 1) | SequenceTable::FallsToHole;
+						holesLeft &= ~(1u << (hole - 1));
+						break;
+					}
+				}
+				if(target == next)
+				{
+					++next;
+				}
+				entry |= static_cast<unsigned long long>(target) << (8 * ballsCount++);
+			}
+			builtTable->entries[key] = entry;
+		}
+	}
+	m_layout->builtTables.push_back(std::move(builtTable));
+	m_layout->tables[shape].store(m_layout->builtTables.back().get(), boost::memory_order_release);
+	return *m_layout->builtTables.back();
+}
+
+void Board2::CountSequencesBalls()
+{
+	m_sequencesBalls.assign(m_layout->horizontalOffsets.size() + m_layout->verticalOffsets.size() - 2, 0);
+	for(BoardStateDigest::const_iterator it = m_stateDigest.begin(); it != m_stateDigest.end(); ++it)
+	{
+		size_t linearNumber = it->second.row * m_boardSize + it->second.column;
+		++m_sequencesBalls[m_layout->horizontalSequencesOfCells[linearNumber]];
+		++m_sequencesBalls[m_layout->verticalSequencesOfCells[linearNumber]];
+	}
+}
+
+void Board2::SetCell(size_t linearNumber, const Cell &cell)
+{
+	m_cells[linearNumber] = cell;
+	if(!m_columnMajorCells.empty())
+	{
+		m_columnMajorCells[m_layout->transposedCells[linearNumber]] = cell;
+	}
+}
@@ -1,10 +1,23 @@
 #pragma once
 
 #include "board.h"
+#include "solve_statistics.h"
+#include "packed_state.h"
+#include "cancellation.h"
 
 //The class Board represents the game (the game parameters, current game and board states, the acceptable operations).
-//Internal represantation of the board is a vector of cells with the size of boardSize x boardSize and two vectors of vectors of iterators,
-//which represent the lists of sequences of adjacent cells (horizontally and vertically adjacent cells).
+//Internal represantation of the board is a vector of cells with the size of boardSize x boardSize and the layout,
+//which represents the lists of sequences of adjacent cells (horizontally and vertically adjacent cells).
+//Each list is stored flat: the cells numbers of all the sequences one after another (in the order the tilts go through them)
+//and the offsets of the sequences in the cells numbers. The layout depends only on the walls and the holes,
+//so it is shared by the copies of the board.
+//The vertical sequences go through the cells with the stride of a row, so the large boards keep a column-major copy of the cells
+//(updated as the balls move), which makes the vertical tilts to go through the memory sequentially as the horizontal ones do.
+//The board keeps the number of the balls of each sequence, so a tilt skips the sequences without balls.
+//The short sequences are tilted with the lookup tables instead of going through the cells back from each ball: a sequence is keyed
+//by its balls and its holes left, the table gives the place of each ball in their order (the cell it stops at or the hole it falls to).
+//The tables depend only on the length of a sequence and the places of its holes (its shape), so they are shared by the sequences of the same shape
+//and by all the copies of the board; a table is built when a sequence of its shape is tilted first.
 //Each cell represents the ball, hole or nothing (empty cell).
 //Balls' and holes' numbers are stored as an attribute of the cell.
 //For example:
@@ -16,21 +29,46 @@
 //	-------------
 //Internal representation:
 //cells vector: {(ball, 0), (hole, 1), (hole, 0), (ball, 1)}
-//horizontally adjacent cells (here we put indexes in cells vectors, to depict the iterators values): {{0, 1}, {2, 3}}
-//vertically adjacent cells (here we put indexes in cells vectors, to depict the iterators values): {{0}, {2}, {1, 3}}
+//horizontally adjacent cells: {0, 1, 2, 3}, offsets: {0, 2, 4} (that is the sequences {0, 1} and {2, 3})
+//vertically adjacent cells: {0, 2, 1, 3}, offsets: {0, 1, 2, 4} (that is the sequences {0}, {2} and {1, 3})
 class Board2
 {
 public:
+	//the breadth-first search of the tilts, the states are packed and tilted by SuccessorGenerator
+	//(only the boards with 65536 cells, which don't fit the packed states, are searched by the copies of the board)
 	static bool Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution);
+	//throws SolveCancelled when the cancellation (if any) is requested
+	static bool Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation = 0);
 
-	Board2(size_t boardSize, std::vector<Position> balls, std::vector<Position> holes, std::vector<std::pair<Position, Position>> walls);
-	Board2(const Board2 &other);
+	//the boards with more than 65536 cells are not supported (domain_error is thrown)
+	Board2(size_t boardSize, const std::vector<Position> &balls, const std::vector<Position> &holes, const std::vector<std::pair<Position, Position>> &walls);
+	explicit Board2(const PuzzleView &puzzle, PuzzleTrust trust = UntrustedPuzzle);
 	bool IsGameWon() const;
 	bool IsGameLost() const;
+	//while journaling each tilt records the balls it moves and sinks, so it can be undone without copying the board
+	//(disabling the journal or setting a state forgets the recorded tilts)
+	void SetJournaling(bool isJournaling);
+	//restores the state before the last journaled tilt (even a lost one) in the time of its changes, throws logic_error if there is no such tilt
+	void Undo();
 	//all below methods thow logic_error when game is lost
 	void Tilt(TiltDirection direction);
 	const std::vector<TiltDirection>& GetTiltsSequence() const;
 	const BoardStateDigest& GetStateDigest() const;
+	size_t GetBoardSize() const;
+	//the packed state can be used only for the boards with no more than SunkBall cells (otherwise domain_error is thrown)
+	void GetPackedState(PackedState &state) const;
+	//replaces the balls with the ones of the state (of a board with the same walls and holes) and starts the tilts sequence anew
+	void SetPackedState(const PackedState &state);
+	//the sequences of the adjacent cells the tilt goes through as the linear numbers of the cells
+	//(the sequence i is the cells from offsets[i] till offsets[i + 1], each starts at the cell the balls move to)
+	void GetAdjacentSequences(TiltDirection direction, std::vector<size_t> &offsets, std::vector<unsigned short> &cells) const;
+	//the linear numbers of the cells of the holes (including the ones of the sunk balls)
+	const std::vector<size_t>& GetHolesCells() const;
+	//limits the entries of the lookup tables of the board and its copies (MaxTablesEntries by default): the tables built already are kept,
+	//the sequences of the shapes whose tables don't fit are tilted by going through the cells (0 turns the tables off)
+	void SetMaxTablesEntries(size_t maxTablesEntries);
+	//the entries of the lookup tables built by the board and its copies
+	size_t GetTablesEntries() const;
 
 private:
 	struct Cell
@@ -42,51 +80,171 @@ private:
 		Value type;
 		size_t attribute;	//balls and holes numbers
 	};
-	typedef std::vector<Cell>::iterator CellsIterator;
+	//the places of the balls of a short sequence after the tilt for each key of the balls and the holes left in the sequence
+	//(the bits of the balls' cells, then the bits of the holes left in their order); the place of each ball is a byte of the entry in the balls order
+	struct SequenceTable
+	{
+		static const unsigned char FallsToHole = 0x80;	//the place is the cell of the hole the ball falls to, not the one it stops at
 
-	void FillAdjacentSequencesLists();
+		size_t length;
+		unsigned int holesMask;	//the bits of the holes' cells
+		std::vector<unsigned long long> entries;	//empty if the table doesn't fit the memory limit
+	};
+	//a change made by a journaled tilt: the ball moved from a cell to another one or sank (then the cell it went to is SunkCell)
+	struct JournalChange
+	{
+		unsigned int ball;
+		unsigned int fromLinearNumber;
+		unsigned int toLinearNumber;
+	};
+	//the sequences of the adjacent cells and the holes cells, which don't change during the game
+	struct Layout
+	{
+		std::vector<size_t> horizontalOffsets;	//the sequence i is the cells from horizontalOffsets[i] till horizontalOffsets[i + 1]
+		std::vector<unsigned short> horizontalCells;
+		std::vector<size_t> verticalOffsets;
+		std::vector<unsigned short> verticalCells;	//the numbers in the column-major cells if the board has them
+		std::vector<unsigned short> transposedCells;	//maps the linear numbers to the column-major ones and back (empty if not used)
+		std::vector<size_t> holes;	//linear numbers of the holes cells
+		//the horizontal and the vertical sequence of each cell (the numbers of the vertical ones follow the horizontal ones)
+		std::vector<unsigned int> horizontalSequencesOfCells;
+		std::vector<unsigned int> verticalSequencesOfCells;
+		//the shape of each sequence tilted forward (2 * i) and backward (2 * i + 1) or NoShape if the sequence is not tilted by a table
+		std::vector<unsigned short> horizontalShapes;
+		std::vector<unsigned short> verticalShapes;
+		std::vector<std::pair<size_t, unsigned int>> shapes;	//the length and the holes' cells bits of each shape
+		//the tables of the shapes (null until they are built), built by the boards sharing the layout
+		std::unique_ptr<boost::atomic<const SequenceTable*>[]> tables;
+		mutable std::vector<std::unique_ptr<SequenceTable>> builtTables;
+		mutable size_t tablesEntries;
+		mutable size_t maxTablesEntries;
+		mutable boost::mutex tablesMutex;
+	};
+	//the smallest board for which the column-major cells pay for their updates (the smaller boards fit the caches anyway)
+	static const size_t ColumnMajorCellsMinBoardSize = 96;
+	//the longest sequence tilted by a table and the most entries of the tables of a layout
+	static const size_t MaxTableSequenceLength = 8;
+	static const size_t MaxTablesEntries = 1 << 20;
+	static const unsigned short NoShape = 0xFFFF;
+	static const unsigned int SunkCell = 0xFFFFFFFF;
+
+	void Initialize(const PuzzleView &puzzle, PuzzleTrust trust);
+	static void FillAdjacentSequencesLists(size_t boardSize, Layout &layout);
+	static void FillSequencesShapes(Layout &layout);
+	//builds the table of the shape if another board hasn't built it yet
+	const SequenceTable& BuildSequenceTable(unsigned short shape) const;
+	template <typename AdjacentCellsIterator>
+	void TiltSequence(AdjacentCellsIterator adjacentCellsBegin, AdjacentCellsIterator adjacentCellsEnd, unsigned short shape, bool isColumnMajor);
+	template <typename AdjacentCellsIterator>
+	void MoveBallsByTable(const SequenceTable &table, AdjacentCellsIterator adjacentCellsBegin, AdjacentCellsIterator adjacentCellsEnd, bool isColumnMajor);
+	void SetCell(size_t linearNumber, const Cell &cell);
+	void CountSequencesBalls();
+	//keeps the numbers of the balls of the sequences when a ball moves between the cells, is sunk or is put back
+	void MoveBallCount(size_t fromLinearNumber, size_t toLinearNumber);
+	void RemoveBallCount(size_t linearNumber);
+	void AddBallCount(size_t linearNumber);
+	void RecordChange(size_t ballNumber, size_t fromLinearNumber, size_t toLinearNumber);
 	template <typename AdjacentCellsIterator>
-	void MoveBallsToTheStartingAdjacentCell(AdjacentCellsIterator adjacentCellsBegin, AdjacentCellsIterator adjacentCellsEnd);
+	void MoveBallsToTheStartingAdjacentCell(AdjacentCellsIterator adjacentCellsBegin, AdjacentCellsIterator adjacentCellsEnd, bool isColumnMajor);
 
 	bool m_isGameWon;
 	bool m_isGameLost;
 	std::vector<TiltDirection> m_tilts;
 	size_t m_boardSize;
 	std::vector<Cell> m_cells;
-	std::vector<std::vector<CellsIterator>> m_horizontallyAdjacentCells;
-	std::vector<std::vector<CellsIterator>> m_verticallyAdjacentCells;
+	std::vector<Cell> m_columnMajorCells;	//empty for the small boards
+	std::shared_ptr<const Layout> m_layout;
 	BoardStateDigest m_stateDigest;
+	std::vector<unsigned short> m_sequencesBalls;	//the number of the balls of each horizontal and then each vertical sequence
+	bool m_isJournaling;
+	std::vector<JournalChange> m_journal;	//the changes of the journaled tilts one after another
+	//the first change of each journaled tilt and whether the tilt was made (the tilts of a won board don't change it)
+	std::vector<std::pair<size_t, bool>> m_journalTilts;
 };
 
+inline void Board2::MoveBallCount(size_t fromLinearNumber, size_t toLinearNumber)
+{
+	--m_sequencesBalls[m_layout->horizontalSequencesOfCells[fromLinearNumber]];
+	--m_sequencesBalls[m_layout->verticalSequencesOfCells[fromLinearNumber]];
+	++m_sequencesBalls[m_layout->horizontalSequencesOfCells[toLinearNumber]];
+	++m_sequencesBalls[m_layout->verticalSequencesOfCells[toLinearNumber]];
+}
+
+inline void Board2::RemoveBallCount(size_t linearNumber)
+{
+	--m_sequencesBalls[m_layout->horizontalSequencesOfCells[linearNumber]];
+	--m_sequencesBalls[m_layout->verticalSequencesOfCells[linearNumber]];
+}
+
+inline void Board2::AddBallCount(size_t linearNumber)
+{
+	++m_sequencesBalls[m_layout->horizontalSequencesOfCells[linearNumber]];
+	++m_sequencesBalls[m_layout->verticalSequencesOfCells[linearNumber]];
+}
+
+inline void Board2::RecordChange(size_t ballNumber, size_t fromLinearNumber, size_t toLinearNumber)
+{
+	if(m_isJournaling)
+	{
+		JournalChange change = {static_cast<unsigned int>(ballNumber), static_cast<unsigned int>(fromLinearNumber), static_cast<unsigned int>(toLinearNumber)};
+		m_journal.push_back(change);
+	}
+}
+
 template <typename AdjacentCellsIterator>
-void Board2::MoveBallsToTheStartingAdjacentCell(AdjacentCellsIterator adjacentCellsBegin, AdjacentCellsIterator adjacentCellsEnd)
+void Board2::MoveBallsToTheStartingAdjacentCell(AdjacentCellsIterator adjacentCellsBegin, AdjacentCellsIterator adjacentCellsEnd, bool isColumnMajor)
 {
+	//the cells the sequences go through and their copy, which should be kept the same
+	std::vector<Cell> &cells = isColumnMajor ? m_columnMajorCells : m_cells;
+	std::vector<Cell> *mirror = m_columnMajorCells.empty() ? 0 : (isColumnMajor ? &m_cells : &m_columnMajorCells);
+	const std::vector<unsigned short> &transposedCells = m_layout->transposedCells;
 	//go through adjacent cells
 	for(auto adjacentCellsIt = adjacentCellsBegin; adjacentCellsIt != adjacentCellsEnd; ++adjacentCellsIt)
 	{
 		//if a ball is found try to move it
-		if(Cell::Ball == (*adjacentCellsIt)->type)
+		Cell &ball = cells[*adjacentCellsIt];
+		if(Cell::Ball == ball.type)
 		{
-			auto ballNumber = (*adjacentCellsIt)->attribute;
+			auto ballNumber = ball.attribute;
 			//search for a position where to move the ball (from the current ball position through adjacent cells)
 			for(auto targetPos = adjacentCellsIt; ; --targetPos)
 			{
 				//if we met a board border or another ball next to the current target position - we move the ball there
-				if(adjacentCellsBegin == targetPos || Cell::Ball == (*std::prev(targetPos))->type)
+				if(adjacentCellsBegin == targetPos || Cell::Ball == cells[*std::prev(targetPos)].type)
 				{
-					std::iter_swap(*targetPos, *adjacentCellsIt);
-					size_t linearNumber = *targetPos - m_cells.begin();
+					std::swap(cells[*targetPos], ball);
+					if(mirror)
+					{
+						std::swap((*mirror)[transposedCells[*targetPos]], (*mirror)[transposedCells[*adjacentCellsIt]]);
+					}
+					if(targetPos == adjacentCellsIt)
+					{
+						break;
+					}
+					size_t linearNumber = isColumnMajor ? transposedCells[*targetPos] : *targetPos;
+					size_t fromLinearNumber = isColumnMajor ? transposedCells[*adjacentCellsIt] : *adjacentCellsIt;
+					MoveBallCount(fromLinearNumber, linearNumber);
+					RecordChange(ballNumber, fromLinearNumber, linearNumber);
 					m_stateDigest[ballNumber].row = linearNumber / m_boardSize;
 					m_stateDigest[ballNumber].column = linearNumber % m_boardSize;
 					break;
 				}
-				if(Cell::Hole == (*std::prev(targetPos))->type)
+				Cell &previous = cells[*std::prev(targetPos)];
+				if(Cell::Hole == previous.type)
 				{
 					//if the ball and the hole numbers match
-					if(ballNumber == (*std::prev(targetPos))->attribute)
+					if(ballNumber == previous.attribute)
 					{
-						**std::prev(targetPos) = Cell();
-						**adjacentCellsIt = Cell();
+						previous = Cell();
+						ball = Cell();
+						if(mirror)
+						{
+							(*mirror)[transposedCells[*std::prev(targetPos)]] = Cell();
+							(*mirror)[transposedCells[*adjacentCellsIt]] = Cell();
+						}
+						size_t fromLinearNumber = isColumnMajor ? transposedCells[*adjacentCellsIt] : *adjacentCellsIt;
+						RemoveBallCount(fromLinearNumber);
+						RecordChange(ballNumber, fromLinearNumber, SunkCell);
 						m_stateDigest.erase(ballNumber);
 						//if no balls is left
 						if(m_stateDigest.empty())
@@ -106,3 +264,110 @@ void Board2::MoveBallsToTheStartingAdjacentCell(AdjacentCellsIterator adjacentCe
 		}
 	}
 }
+
+template <typename AdjacentCellsIterator>
+void Board2::TiltSequence(AdjacentCellsIterator adjacentCellsBegin, AdjacentCellsIterator adjacentCellsEnd, unsigned short shape, bool isColumnMajor)
+{
+	if(NoShape != shape)
+	{
+		const SequenceTable *table = m_layout->tables[shape].load(boost::memory_order_acquire);
+		if(!table)
+		{
+			table = &BuildSequenceTable(shape);
+		}
+		if(!table->entries.empty())
+		{
+			MoveBallsByTable(*table, adjacentCellsBegin, adjacentCellsEnd, isColumnMajor);
+			return;
+		}
+	}
+	MoveBallsToTheStartingAdjacentCell(adjacentCellsBegin, adjacentCellsEnd, isColumnMajor);
+}
+
+template <typename AdjacentCellsIterator>
+void Board2::MoveBallsByTable(const SequenceTable &table, AdjacentCellsIterator adjacentCellsBegin, AdjacentCellsIterator adjacentCellsEnd, bool isColumnMajor)
+{
+	std::vector<Cell> &cells = isColumnMajor ? m_columnMajorCells : m_cells;
+	std::vector<Cell> *mirror = m_columnMajorCells.empty() ? 0 : (isColumnMajor ? &m_cells : &m_columnMajorCells);
+	const std::vector<unsigned short> &transposedCells = m_layout->transposedCells;
+	//the key of the balls and the holes left
+	size_t key = 0;
+	size_t holeBit = table.length;
+	unsigned char ballsPlaces[MaxTableSequenceLength];
+	size_t ballsCount = 0;
+	size_t place = 0;
+	for(auto adjacentCellsIt = adjacentCellsBegin; adjacentCellsIt != adjacentCellsEnd; ++adjacentCellsIt, ++place)
+	{
+		const Cell &cell = cells[*adjacentCellsIt];
+		if(table.holesMask & (1u << place))
+		{
+			if(Cell::Hole == cell.type)
+			{
+				key |= size_t(1) << holeBit;
+			}
+			++holeBit;
+		}
+		if(Cell::Ball == cell.type)
+		{
+			key |= size_t(1) << place;
+			ballsPlaces[ballsCount++] = static_cast<unsigned char>(place);
+		}
+	}
+	if(!ballsCount)
+	{
+		return;
+	}
+	unsigned long long entry = table.entries[key];
+	for(size_t i = 0; i < ballsCount; ++i, entry >>= 8)
+	{
+		unsigned char target = static_cast<unsigned char>(entry & 0xFF);
+		AdjacentCellsIterator ballIt = adjacentCellsBegin + ballsPlaces[i];
+		Cell &ball = cells[*ballIt];
+		auto ballNumber = ball.attribute;
+		if(target & SequenceTable::FallsToHole)
+		{
+			AdjacentCellsIterator holeIt = adjacentCellsBegin + (target & ~SequenceTable::FallsToHole);
+			Cell &hole = cells[*holeIt];
+			//if the ball and the hole numbers don't match
+			if(ballNumber != hole.attribute)
+			{
+				m_isGameLost = true;
+				return;
+			}
+			hole = Cell();
+			ball = Cell();
+			if(mirror)
+			{
+				(*mirror)[transposedCells[*holeIt]] = Cell();
+				(*mirror)[transposedCells[*ballIt]] = Cell();
+			}
+			size_t fromLinearNumber = isColumnMajor ? transposedCells[*ballIt] : *ballIt;
+			RemoveBallCount(fromLinearNumber);
+			RecordChange(ballNumber, fromLinearNumber, SunkCell);
+			m_stateDigest.erase(ballNumber);
+			//if no balls is left
+			if(m_stateDigest.empty())
+			{
+				m_isGameWon = true;
+				return;
+			}
+			continue;
+		}
+		if(target == ballsPlaces[i])
+		{
+			continue;
+		}
+		AdjacentCellsIterator targetIt = adjacentCellsBegin + target;
+		std::swap(cells[*targetIt], ball);
+		if(mirror)
+		{
+			std::swap((*mirror)[transposedCells[*targetIt]], (*mirror)[transposedCells[*ballIt]]);
+		}
+		size_t linearNumber = isColumnMajor ? transposedCells[*targetIt] : *targetIt;
+		size_t fromLinearNumber = isColumnMajor ? transposedCells[*ballIt] : *ballIt;
+		MoveBallCount(fromLinearNumber, linearNumber);
+		RecordChange(ballNumber, fromLinearNumber, linearNumber);
+		m_stateDigest[ballNumber].row = linearNumber / m_boardSize;
+		m_stateDigest[ballNumber].column = linearNumber % m_boardSize;
+	}
+}
@@ -0,0 +1,342 @@
+#include "stdafx.h"
+#include "calibration.h"
+#include "generator.h"
+#include "trace.h"
+
+CalibrationEntry::CalibrationEntry()
+	:boardSize(0)
+	,ballsCount(0)
+	,wallsCount(0)
+	,engine()
+	,seconds(0)
+{
+}
+
+CalibrationEntry::CalibrationEntry(size_t boardSize, size_t ballsCount, size_t wallsCount, const std::string &engine, double seconds)
+	:boardSize(boardSize)
+	,ballsCount(ballsCount)
+	,wallsCount(wallsCount)
+	,engine(engine)
+	,seconds(seconds)
+{
+}
+
+namespace
+{
+	const size_t g_calibrationSizes[] = {4, 8, 16, 32, 64};
+	const size_t g_calibrationBalls[] = {1, 2, 3, 4};
+	const size_t g_calibrationWallsPerRow[] = {0, 2};
+
+	//the table produced by --calibrate with the default options (4 samples, the seed 0, 256 MB)
+	const CalibrationEntry g_defaultCalibration[] = {
+		CalibrationEntry(4, 1, 0, "board", 2.19278e-05),
+		CalibrationEntry(4, 1, 0, "board2", 1.06733e-05),
+		CalibrationEntry(4, 1, 0, "sparse", 1.4287e-05),
+		CalibrationEntry(4, 1, 0, "ranked", 1.0383e-05),
+		CalibrationEntry(4, 1, 0, "nogood", 1.90267e-05),
+		CalibrationEntry(4, 1, 8, "board", 3.40725e-05),
+		CalibrationEntry(4, 1, 8, "board2", 1.67385e-05),
+		CalibrationEntry(4, 1, 8, "sparse", 1.99068e-05),
+		CalibrationEntry(4, 1, 8, "ranked", 1.26908e-05),
+		CalibrationEntry(4, 1, 8, "nogood", 1.37538e-05),
+		CalibrationEntry(4, 2, 0, "board", 4.02562e-05),
+		CalibrationEntry(4, 2, 0, "board2", 0.000309936),
+		CalibrationEntry(4, 2, 0, "sparse", 2.2874e-05),
+		CalibrationEntry(4, 2, 0, "ranked", 1.52767e-05),
+		CalibrationEntry(4, 2, 0, "nogood", 3.65678e-05),
+		CalibrationEntry(4, 2, 8, "board", 6.198e-05),
+		CalibrationEntry(4, 2, 8, "board2", 2.23262e-05),
+		CalibrationEntry(4, 2, 8, "sparse", 3.6196e-05),
+		CalibrationEntry(4, 2, 8, "ranked", 1.82133e-05),
+		CalibrationEntry(4, 2, 8, "nogood", 4.10492e-05),
+		CalibrationEntry(4, 3, 0, "board", 5.46228e-05),
+		CalibrationEntry(4, 3, 0, "board2", 2.0265e-05),
+		CalibrationEntry(4, 3, 0, "sparse", 3.0873e-05),
+		CalibrationEntry(4, 3, 0, "ranked", 1.6649e-05),
+		CalibrationEntry(4, 3, 0, "nogood", 0.0010841),
+		CalibrationEntry(4, 3, 8, "board", 0.000119409),
+		CalibrationEntry(4, 3, 8, "board2", 3.56383e-05),
+		CalibrationEntry(4, 3, 8, "sparse", 6.3744e-05),
+		CalibrationEntry(4, 3, 8, "ranked", 2.50275e-05),
+		CalibrationEntry(4, 3, 8, "nogood", 5.56175e-05),
+		CalibrationEntry(4, 4, 0, "board", 4.29657e-05),
+		CalibrationEntry(4, 4, 0, "board2", 1.62415e-05),
+		CalibrationEntry(4, 4, 0, "sparse", 2.7227e-05),
+		CalibrationEntry(4, 4, 0, "ranked", 2.96075e-05),
+		CalibrationEntry(4, 4, 0, "nogood", 0.000124277),
+		CalibrationEntry(4, 4, 8, "board", 0.000566275),
+		CalibrationEntry(4, 4, 8, "board2", 0.000127935),
+		CalibrationEntry(4, 4, 8, "sparse", 0.0016794),
+		CalibrationEntry(4, 4, 8, "ranked", 9.91217e-05),
+		CalibrationEntry(4, 4, 8, "nogood", 0.000211672),
+		CalibrationEntry(8, 1, 0, "board", 7.23462e-05),
+		CalibrationEntry(8, 1, 0, "board2", 1.8546e-05),
+		CalibrationEntry(8, 1, 0, "sparse", 1.79428e-05),
+		CalibrationEntry(8, 1, 0, "ranked", 1.5351e-05),
+		CalibrationEntry(8, 1, 0, "nogood", 1.6689e-05),
+		CalibrationEntry(8, 1, 16, "board", 8.11005e-05),
+		CalibrationEntry(8, 1, 16, "board2", 2.89375e-05),
+		CalibrationEntry(8, 1, 16, "sparse", 3.20167e-05),
+		CalibrationEntry(8, 1, 16, "ranked", 2.21703e-05),
+		CalibrationEntry(8, 1, 16, "nogood", 2.2263e-05),
+		CalibrationEntry(8, 2, 0, "board", 0.000104665),
+		CalibrationEntry(8, 2, 0, "board2", 2.16725e-05),
+		CalibrationEntry(8, 2, 0, "sparse", 2.98398e-05),
+		CalibrationEntry(8, 2, 0, "ranked", 1.69318e-05),
+		CalibrationEntry(8, 2, 0, "nogood", 0.000278426),
+		CalibrationEntry(8, 2, 16, "board", 0.000359403),
+		CalibrationEntry(8, 2, 16, "board2", 6.72618e-05),
+		CalibrationEntry(8, 2, 16, "sparse", 0.000107925),
+		CalibrationEntry(8, 2, 16, "ranked", 3.98102e-05),
+		CalibrationEntry(8, 2, 16, "nogood", 0.00170339),
+		CalibrationEntry(8, 3, 0, "board", 0.000183559),
+		CalibrationEntry(8, 3, 0, "board2", 3.33887e-05),
+		CalibrationEntry(8, 3, 0, "sparse", 7.04005e-05),
+		CalibrationEntry(8, 3, 0, "ranked", 2.81345e-05),
+		CalibrationEntry(8, 3, 0, "nogood", 0.00190824),
+		CalibrationEntry(8, 3, 16, "board", 0.00189648),
+		CalibrationEntry(8, 3, 16, "board2", 0.000128423),
+		CalibrationEntry(8, 3, 16, "sparse", 0.000224164),
+		CalibrationEntry(8, 3, 16, "ranked", 7.57132e-05),
+		CalibrationEntry(8, 3, 16, "nogood", 0.00183793),
+		CalibrationEntry(8, 4, 0, "board", 0.000161139),
+		CalibrationEntry(8, 4, 0, "board2", 3.19415e-05),
+		CalibrationEntry(8, 4, 0, "sparse", 5.92793e-05),
+		CalibrationEntry(8, 4, 0, "ranked", 0.00190864),
+		CalibrationEntry(8, 4, 0, "nogood", 0.00545139),
+		CalibrationEntry(8, 4, 16, "board", 0.0057886),
+		CalibrationEntry(8, 4, 16, "board2", 0.000323651),
+		CalibrationEntry(8, 4, 16, "sparse", 0.00180555),
+		CalibrationEntry(8, 4, 16, "ranked", 0.000367918),
+		CalibrationEntry(8, 4, 16, "nogood", 0.00623),
+		CalibrationEntry(16, 1, 0, "board", 0.000108012),
+		CalibrationEntry(16, 1, 0, "board2", 2.1881e-05),
+		CalibrationEntry(16, 1, 0, "sparse", 1.91325e-05),
+		CalibrationEntry(16, 1, 0, "ranked", 1.69455e-05),
+		CalibrationEntry(16, 1, 0, "nogood", 3.30223e-05),
+		CalibrationEntry(16, 1, 32, "board", 0.000252112),
+		CalibrationEntry(16, 1, 32, "board2", 4.76882e-05),
+		CalibrationEntry(16, 1, 32, "sparse", 4.79393e-05),
+		CalibrationEntry(16, 1, 32, "ranked", 3.14487e-05),
+		CalibrationEntry(16, 1, 32, "nogood", 3.94253e-05),
+		CalibrationEntry(16, 2, 0, "board", 0.000223518),
+		CalibrationEntry(16, 2, 0, "board2", 3.2454e-05),
+		CalibrationEntry(16, 2, 0, "sparse", 4.09003e-05),
+		CalibrationEntry(16, 2, 0, "ranked", 2.30677e-05),
+		CalibrationEntry(16, 2, 0, "nogood", 0.000141955),
+		CalibrationEntry(16, 2, 32, "board", 0.00846308),
+		CalibrationEntry(16, 2, 32, "board2", 0.000260035),
+		CalibrationEntry(16, 2, 32, "sparse", 0.00346992),
+		CalibrationEntry(16, 2, 32, "ranked", 9.12525e-05),
+		CalibrationEntry(16, 2, 32, "nogood", 0.000400155),
+		CalibrationEntry(16, 3, 0, "board", 0.000381508),
+		CalibrationEntry(16, 3, 0, "board2", 4.23003e-05),
+		CalibrationEntry(16, 3, 0, "sparse", 6.97913e-05),
+		CalibrationEntry(16, 3, 0, "ranked", 0.000142206),
+		CalibrationEntry(16, 3, 0, "nogood", 0.00288926),
+		CalibrationEntry(16, 3, 32, "board", 0.015795),
+		CalibrationEntry(16, 3, 32, "board2", 0.000918498),
+		CalibrationEntry(16, 3, 32, "sparse", 0.00228095),
+		CalibrationEntry(16, 3, 32, "ranked", 0.000802898),
+		CalibrationEntry(16, 3, 32, "nogood", 0.00149215),
+		CalibrationEntry(16, 4, 0, "board", 0.000507621),
+		CalibrationEntry(16, 4, 0, "board2", 5.6841e-05),
+		CalibrationEntry(16, 4, 0, "sparse", 9.89195e-05),
+		CalibrationEntry(16, 4, 0, "nogood", 0.000679104),
+		CalibrationEntry(16, 4, 32, "board", 0.348578),
+		CalibrationEntry(16, 4, 32, "board2", 0.00783904),
+		CalibrationEntry(16, 4, 32, "sparse", 0.0470926),
+		CalibrationEntry(16, 4, 32, "nogood", 0.0190425),
+		CalibrationEntry(32, 1, 0, "board", 0.000273827),
+		CalibrationEntry(32, 1, 0, "board2", 3.9527e-05),
+		CalibrationEntry(32, 1, 0, "sparse", 2.46118e-05),
+		CalibrationEntry(32, 1, 0, "ranked", 3.4734e-05),
+		CalibrationEntry(32, 1, 0, "nogood", 0.000356403),
+		CalibrationEntry(32, 1, 64, "board", 0.00238748),
+		CalibrationEntry(32, 1, 64, "board2", 9.49288e-05),
+		CalibrationEntry(32, 1, 64, "sparse", 8.94533e-05),
+		CalibrationEntry(32, 1, 64, "ranked", 6.03173e-05),
+		CalibrationEntry(32, 1, 64, "nogood", 0.00143976),
+		CalibrationEntry(32, 2, 0, "board", 0.00180561),
+		CalibrationEntry(32, 2, 0, "board2", 5.90625e-05),
+		CalibrationEntry(32, 2, 0, "sparse", 5.27493e-05),
+		CalibrationEntry(32, 2, 0, "ranked", 4.43408e-05),
+		CalibrationEntry(32, 2, 0, "nogood", 0.00160097),
+		CalibrationEntry(32, 2, 64, "board", 0.047194),
+		CalibrationEntry(32, 2, 64, "board2", 0.0014874),
+		CalibrationEntry(32, 2, 64, "sparse", 0.000862369),
+		CalibrationEntry(32, 2, 64, "ranked", 0.000163902),
+		CalibrationEntry(32, 2, 64, "nogood", 0.00324833),
+		CalibrationEntry(32, 3, 0, "board", 0.000915402),
+		CalibrationEntry(32, 3, 0, "board2", 6.04843e-05),
+		CalibrationEntry(32, 3, 0, "sparse", 7.44305e-05),
+		CalibrationEntry(32, 3, 0, "ranked", 0.114155),
+		CalibrationEntry(32, 3, 0, "nogood", 0.00135178),
+		CalibrationEntry(32, 3, 64, "board", 0.21743),
+		CalibrationEntry(32, 3, 64, "board2", 0.00307687),
+		CalibrationEntry(32, 3, 64, "sparse", 0.00745354),
+		CalibrationEntry(32, 3, 64, "ranked", 0.110475),
+		CalibrationEntry(32, 3, 64, "nogood", 0.00734743),
+		CalibrationEntry(32, 4, 0, "board", 0.00118735),
+		CalibrationEntry(32, 4, 0, "board2", 6.7969e-05),
+		CalibrationEntry(32, 4, 0, "sparse", 0.000105518),
+		CalibrationEntry(32, 4, 0, "nogood", 0.00243789),
+		CalibrationEntry(32, 4, 64, "board", 3.10589),
+		CalibrationEntry(32, 4, 64, "board2", 0.0225916),
+		CalibrationEntry(32, 4, 64, "sparse", 0.0927023),
+		CalibrationEntry(32, 4, 64, "nogood", 0.0315025),
+		CalibrationEntry(64, 1, 0, "board", 0.00129384),
+		CalibrationEntry(64, 1, 0, "board2", 0.000120585),
+		CalibrationEntry(64, 1, 0, "sparse", 3.37285e-05),
+		CalibrationEntry(64, 1, 0, "ranked", 0.000109801),
+		CalibrationEntry(64, 1, 0, "nogood", 0.0532438),
+		CalibrationEntry(64, 1, 128, "board", 0.0140999),
+		CalibrationEntry(64, 1, 128, "board2", 0.000230362),
+		CalibrationEntry(64, 1, 128, "sparse", 0.000179431),
+		CalibrationEntry(64, 1, 128, "ranked", 0.000155888),
+		CalibrationEntry(64, 1, 128, "nogood", 0.0521249),
+		CalibrationEntry(64, 2, 0, "board", 0.00295775),
+		CalibrationEntry(64, 2, 0, "board2", 0.000119471),
+		CalibrationEntry(64, 2, 0, "sparse", 5.44448e-05),
+		CalibrationEntry(64, 2, 0, "ranked", 0.000209652),
+		CalibrationEntry(64, 2, 0, "nogood", 0.0542391),
+		CalibrationEntry(64, 2, 128, "board", 0.112793),
+		CalibrationEntry(64, 2, 128, "board2", 0.000724973),
+		CalibrationEntry(64, 2, 128, "sparse", 0.00128612),
+		CalibrationEntry(64, 2, 128, "ranked", 0.000397743),
+		CalibrationEntry(64, 2, 128, "nogood", 0.0588766),
+		CalibrationEntry(64, 3, 0, "board", 0.00374403),
+		CalibrationEntry(64, 3, 0, "board2", 0.000130401),
+		CalibrationEntry(64, 3, 0, "sparse", 7.0679e-05),
+		CalibrationEntry(64, 3, 0, "nogood", 0.0568276),
+		CalibrationEntry(64, 3, 128, "board", 1.08674),
+		CalibrationEntry(64, 3, 128, "board2", 0.00610271),
+		CalibrationEntry(64, 3, 128, "sparse", 0.0159128),
+		CalibrationEntry(64, 3, 128, "nogood", 0.0814464),
+		CalibrationEntry(64, 4, 0, "board", 0.00421004),
+		CalibrationEntry(64, 4, 0, "board2", 0.000143488),
+		CalibrationEntry(64, 4, 0, "sparse", 0.000110568),
+		CalibrationEntry(64, 4, 128, "board", 39.8609),
+		CalibrationEntry(64, 4, 128, "board2", 0.0616826),
+		CalibrationEntry(64, 4, 128, "sparse", 0.384325)};
+
+	double Distance(const PuzzleView &puzzle, const CalibrationEntry &entry)
+	{
+		double boardSize = std::log(static_cast<double>(puzzle.boardSize)) - std::log(static_cast<double>(entry.boardSize));
+		double balls = std::log(static_cast<double>(puzzle.ballsCount + 1)) - std::log(static_cast<double>(entry.ballsCount + 1));
+		double walls = std::log(static_cast<double>(puzzle.wallsCount + 1)) - std::log(static_cast<double>(entry.wallsCount + 1));
+		return boardSize * boardSize + balls * balls + walls * walls;
+	}
+}
+
+const CalibrationTable& GetDefaultCalibration()
+{
+	static const CalibrationTable calibration(g_defaultCalibration, g_defaultCalibration + sizeof(g_defaultCalibration) / sizeof(g_defaultCalibration[0]));
+	return calibration;
+}
+
+CalibrationTable Calibrate(size_t samplesCount, unsigned int seed, unsigned long long memoryLimit)
+{
+	TRACE_SCOPE("Calibrate");
+	CalibrationTable calibration;
+	std::vector<std::string> engines(GetEngineNames());
+	for(size_t size = 0; size < sizeof(g_calibrationSizes) / sizeof(g_calibrationSizes[0]); ++size)
+	{
+		for(size_t balls = 0; balls < sizeof(g_calibrationBalls) / sizeof(g_calibrationBalls[0]); ++balls)
+		{
+			for(size_t walls = 0; walls < sizeof(g_calibrationWallsPerRow) / sizeof(g_calibrationWallsPerRow[0]); ++walls)
+			{
+				//the random puzzles, a half of them solvable
+				GeneratorOptions options;
+				options.boardSize = g_calibrationSizes[size];
+				options.ballsCount = g_calibrationBalls[balls];
+				options.wallsCount = g_calibrationWallsPerRow[walls] * options.boardSize;
+				options.climbingSteps = 0;
+				options.threadsCount = 1;
+				options.seed = seed;
+				options.puzzlesCount = (samplesCount + 1) / 2;
+				options.maxSamples = 100 * samplesCount;
+				std::vector<GeneratedPuzzle> puzzles(GeneratePuzzles(options));
+				options.isUnsolvable = true;
+				options.puzzlesCount = samplesCount - puzzles.size();
+				std::vector<GeneratedPuzzle> unsolvablePuzzles(GeneratePuzzles(options));
+				puzzles.insert(puzzles.end(), unsolvablePuzzles.begin(), unsolvablePuzzles.end());
+				if(puzzles.empty())
+				{
+					continue;
+				}
+
+				for(size_t engine = 0; engine < engines.size(); ++engine)
+				{
+					if(WinningSolution == GetEngineSolution(engines[engine]) || !IsEngineApplicable(engines[engine], PuzzleView(puzzles[0].puzzle), memoryLimit))
+					{
+						continue;
+					}
+					boost::chrono::duration<double> time(0);
+					for(size_t i = 0; i < puzzles.size(); ++i)
+					{
+						std::vector<TiltDirection> solution;
+						SolveStatistics statistics;
+						boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+						CreateEngine(engines[engine], PuzzleView(puzzles[i].puzzle), TrustedPuzzle)->Solve(solution, statistics);
+						time += boost::chrono::steady_clock::now() - start;
+					}
+					calibration.push_back(CalibrationEntry(options.boardSize, options.ballsCount, options.wallsCount, engines[engine], time.count() / puzzles.size()));
+				}
+			}
+		}
+	}
+	return calibration;
+}
+
+CalibrationTable ReadCalibration(std::istream &input)
+{
+	CalibrationTable calibration;
+	std::string line;
+	while(std::getline(input, line))
+	{
+		if(line.empty() || '\r' == line[0])
+		{
+			continue;
+		}
+		std::istringstream ss(line);
+		CalibrationEntry entry;
+		if(!(ss >> entry.boardSize >> entry.ballsCount >> entry.wallsCount >> entry.engine >> entry.seconds))
+		{
+			throw std::invalid_argument("the calibration line is malformed: " + line);
+		}
+		calibration.push_back(entry);
+	}
+	return calibration;
+}
+
+void WriteCalibration(std::ostream &output, const CalibrationTable &calibration)
+{
+	for(size_t i = 0; i < calibration.size(); ++i)
+	{
+		const CalibrationEntry &entry = calibration[i];
+		output << entry.boardSize << " " << entry.ballsCount << " " << entry.wallsCount << " " << entry.engine << " " << entry.seconds << std::endl;
+	}
+}
+
+std::string ChooseEngine(const PuzzleView &puzzle, const CalibrationTable &calibration, unsigned long long memoryLimit)
+{
+	//the nearest kind with an applicable engine and the fastest engine of the kind
+	const CalibrationEntry *best = 0;
+	double bestDistance = 0;
+	for(size_t i = 0; i < calibration.size(); ++i)
+	{
+		const CalibrationEntry &entry = calibration[i];
+		if(WinningSolution == GetEngineSolution(entry.engine) || !IsEngineApplicable(entry.engine, puzzle, memoryLimit))
+		{
+			continue;
+		}
+		double distance = Distance(puzzle, entry);
+		if(!best || distance < bestDistance || (distance == bestDistance && entry.seconds < best->seconds))
+		{
+			best = &entry;
+			bestDistance = distance;
+		}
+	}
+	return best ? best->engine : "sparse";
+}
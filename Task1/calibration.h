@@ -0,0 +1,36 @@
+#pragma once
+
+#include "engine.h"
+
+//The struct CalibrationEntry is the mean time of the solves of an engine for the puzzles of a kind (board size, balls and walls numbers).
+struct CalibrationEntry
+{
+	size_t boardSize;
+	size_t ballsCount;
+	size_t wallsCount;
+	std::string engine;
+	double seconds;
+
+	CalibrationEntry();
+	CalibrationEntry(size_t boardSize, size_t ballsCount, size_t wallsCount, const std::string &engine, double seconds);
+};
+
+typedef std::vector<CalibrationEntry> CalibrationTable;
+
+//The table measured with Calibrate on the development machine, used when no other table is given.
+const CalibrationTable& GetDefaultCalibration();
+
+//Measures each engine on samplesCount generated puzzles (a half of them solvable) for each kind of the calibration grid
+//(the board sizes from 4 to 64, from 1 to 4 balls, no walls or two walls per row). The engines which are not applicable
+//to the kind (with the memory limit) or don't find the shortest solution are not measured. Uses one thread, so the engines are measured without the interference.
+CalibrationTable Calibrate(size_t samplesCount, unsigned int seed, unsigned long long memoryLimit);
+
+//Reads and writes the table as the lines "boardSize ballsCount wallsCount engine seconds".
+//Throws invalid_argument when a line is malformed.
+CalibrationTable ReadCalibration(std::istream &input);
+void WriteCalibration(std::ostream &output, const CalibrationTable &calibration);
+
+//Chooses the engine for the puzzle: the one with the least time among the engines applicable to the puzzle (and finding the shortest solution)
+//in the nearest kind of the table (the distance is taken between the logarithms of the sizes and the numbers).
+//Falls back to "sparse", which is applicable to any puzzle, if the table has no applicable engine.
+std::string ChooseEngine(const PuzzleView &puzzle, const CalibrationTable &calibration, unsigned long long memoryLimit);
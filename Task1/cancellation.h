@@ -0,0 +1,44 @@
+#pragma once
+
+//The exception SolveCancelled is thrown by a search when its cancellation is requested.
+class SolveCancelled : public std::runtime_error
+{
+public:
+	SolveCancelled()
+		:std::runtime_error("the search is cancelled")
+	{
+	}
+};
+
+//The class Cancellation lets one thread stop the searches running in the other ones.
+//The searches check it between their states (it's a relaxed load of a flag), so they stop soon but not at once.
+class Cancellation
+{
+public:
+	Cancellation()
+		:m_isCancelled(false)
+	{
+	}
+	void Cancel()
+	{
+		m_isCancelled.store(true, boost::memory_order_relaxed);
+	}
+	bool IsCancelled() const
+	{
+		return m_isCancelled.load(boost::memory_order_relaxed);
+	}
+	//throws SolveCancelled if the cancellation is requested
+	void Check() const
+	{
+		if(IsCancelled())
+		{
+			throw SolveCancelled();
+		}
+	}
+
+private:
+	Cancellation(const Cancellation&);
+	Cancellation& operator=(const Cancellation&);
+
+	boost::atomic<bool> m_isCancelled;
+};
@@ -0,0 +1,329 @@
+#include "stdafx.h"
+#include "checkpointed_solver.h"
+#include "compressed_states.h"
+#include "trace.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, South, East, North};
+	const size_t g_directionsCount = sizeof(g_directions) / sizeof(g_directions[0]);
+	const char g_headerMagic[] = "tilt checkpoint 1";
+}
+
+bool CheckpointedSolver::Solve(const Puzzle &puzzle, const std::string &checkpointPath, size_t checkpointInterval, std::vector<TiltDirection> &solution, SolveStatistics &statistics)
+{
+	TRACE_SCOPE("CheckpointedSolver::Solve");
+	statistics = SolveStatistics();
+	solution.clear();
+	CheckpointedSolver solver(puzzle, checkpointPath, checkpointInterval);
+	if(solver.m_board.IsGameLost())
+	{
+		return false;
+	}
+	if(solver.m_board.IsGameWon())
+	{
+		return true;
+	}
+	solver.Start();
+	statistics.boardsQueued = 1;
+	return solver.Search(solution, statistics);
+}
+
+bool CheckpointedSolver::Resume(const std::string &checkpointPath, size_t checkpointInterval, std::vector<TiltDirection> &solution, SolveStatistics &statistics)
+{
+	TRACE_SCOPE("CheckpointedSolver::Resume");
+	statistics = SolveStatistics();
+	solution.clear();
+	std::ifstream headerFile(checkpointPath.c_str());
+	std::string magic;
+	std::string puzzleLine;
+	size_t recordsCount = 0;
+	size_t head = 0;
+	if(!std::getline(headerFile, magic) || magic != g_headerMagic || !std::getline(headerFile, puzzleLine)
+		|| !(headerFile >> recordsCount >> head >> statistics.boardsQueued >> statistics.maxQueueSize) || !recordsCount || head > recordsCount)
+	{
+		throw std::invalid_argument("the checkpoint is missing or damaged: " + checkpointPath);
+	}
+	CheckpointedSolver solver(ParsePuzzle(puzzleLine), checkpointPath, checkpointInterval);
+	if(solver.m_board.IsGameLost() || solver.m_board.IsGameWon())
+	{
+		throw std::invalid_argument("the checkpoint puzzle is over before the search: " + checkpointPath);
+	}
+	solver.ReadRecords(recordsCount);
+	solver.m_head = head;
+	return solver.Search(solution, statistics);
+}
+
+CheckpointedSolver::CheckpointedSolver(const Puzzle &puzzle, const std::string &checkpointPath, size_t checkpointInterval)
+	:m_puzzle(puzzle)
+	,m_board(PuzzleView(puzzle))
+	,m_generator(m_board)
+	,m_checkpointPath(checkpointPath)
+	,m_checkpointInterval(boost::chrono::seconds(checkpointInterval))
+	,m_nextCheckpoint(boost::chrono::steady_clock::now())
+	,m_stateSize()
+	,m_recordSize()
+	,m_chunks()
+	,m_record()
+	,m_recordsCount(0)
+	,m_head(0)
+	,m_slots(1024)
+	,m_writtenCount(0)
+	,m_writer()
+	,m_isWriteFailed(false)
+{
+	if(!m_board.IsGameLost())
+	{
+		PackedState start;
+		m_board.GetPackedState(start);
+		m_stateSize = start.size();
+	}
+	m_recordSize = m_stateSize * sizeof(unsigned short) + sizeof(unsigned int) + 1;
+	m_record.resize(m_recordSize);
+}
+
+CheckpointedSolver::~CheckpointedSolver()
+{
+	if(m_writer.joinable())
+	{
+		m_writer.join();
+	}
+}
+
+void CheckpointedSolver::Start()
+{
+	std::ofstream statesFile((m_checkpointPath + ".states").c_str(), std::ios::binary | std::ios::trunc);
+	if(!statesFile.is_open())
+	{
+		throw std::runtime_error("the checkpoint can't be written: " + m_checkpointPath);
+	}
+	PackedState start;
+	m_board.GetPackedState(start);
+	Insert(start, NoParent, West);
+}
+
+void CheckpointedSolver::ReadRecords(size_t recordsCount)
+{
+	TRACE_SCOPE("ReadRecords");
+	std::string statesPath(m_checkpointPath + ".states");
+	unsigned long long bytes = static_cast<unsigned long long>(recordsCount) * m_recordSize;
+	if(!boost::filesystem::exists(statesPath) || boost::filesystem::file_size(statesPath) < bytes)
+	{
+		throw std::invalid_argument("the checkpoint states file is truncated: " + statesPath);
+	}
+	namespace bi = boost::interprocess;
+	bi::file_mapping mapping(statesPath.c_str(), bi::read_only);
+	bi::mapped_region region(mapping, bi::read_only, 0, static_cast<size_t>(bytes));
+	const unsigned char *records = static_cast<const unsigned char*>(region.get_address());
+	PackedState state;
+	for(size_t i = 0; i < recordsCount; ++i)
+	{
+		if((m_recordsCount + 1) * 2 > m_slots.size())
+		{
+			Grow();
+		}
+		AppendRecord(records + i * m_recordSize);
+		GetState(m_recordsCount - 1, state);
+		m_slots[FindSlot(state)] = static_cast<unsigned int>(m_recordsCount);
+	}
+	//the records after these ones are not described by the header, so they are overwritten
+	m_writtenCount = m_recordsCount;
+}
+
+bool CheckpointedSolver::Search(std::vector<TiltDirection> &solution, SolveStatistics &statistics)
+{
+	PackedState state;
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	for(; m_head < m_recordsCount; ++m_head)
+	{
+		if(0 == m_head % CheckpointCheckStates && boost::chrono::steady_clock::now() >= m_nextCheckpoint)
+		{
+			StartCheckpoint(statistics);
+		}
+		GetState(m_head, state);
+		m_generator.Expand(state, successors);
+		for(size_t i = 0; i < g_directionsCount; ++i)
+		{
+			const SuccessorGenerator::Successor &successor = successors[g_directions[i]];
+			++statistics.boardsQueued;
+			if(SuccessorGenerator::Lost == successor.outcome)
+			{
+				continue;
+			}
+			if(SuccessorGenerator::Won == successor.outcome)
+			{
+				statistics.statesMet = m_recordsCount;
+				RestoreSolution(m_head, solution);
+				solution.push_back(g_directions[i]);
+				FinishCheckpoint();
+				return true;
+			}
+			Insert(successor.state, static_cast<unsigned int>(m_head), g_directions[i]);
+		}
+		statistics.maxQueueSize = std::max(statistics.maxQueueSize, m_recordsCount - m_head - 1);
+	}
+	statistics.statesMet = m_recordsCount;
+	FinishCheckpoint();
+	return false;
+}
+
+bool CheckpointedSolver::Insert(const PackedState &state, unsigned int parent, TiltDirection move)
+{
+	if((m_recordsCount + 1) * 2 > m_slots.size())
+	{
+		Grow();
+	}
+	size_t slot = FindSlot(state);
+	if(m_slots[slot])
+	{
+		return false;
+	}
+	std::memcpy(&m_record[0], &state[0], m_stateSize * sizeof(unsigned short));
+	std::memcpy(&m_record[m_stateSize * sizeof(unsigned short)], &parent, sizeof(parent));
+	m_record[m_recordSize - 1] = static_cast<unsigned char>(move);
+	AppendRecord(&m_record[0]);
+	m_slots[slot] = static_cast<unsigned int>(m_recordsCount);
+	return true;
+}
+
+void CheckpointedSolver::AppendRecord(const unsigned char *record)
+{
+	if(m_recordsCount >= NoParent - 1)
+	{
+		throw std::domain_error("too many states for the checkpointed search");
+	}
+	//the chunks are reserved for all their records, so the written records never move
+	if(0 == m_recordsCount % ChunkRecords)
+	{
+		m_chunks.push_back(std::vector<unsigned char>());
+		m_chunks.back().reserve(ChunkRecords * m_recordSize);
+	}
+	m_chunks.back().insert(m_chunks.back().end(), record, record + m_recordSize);
+	++m_recordsCount;
+}
+
+void CheckpointedSolver::Grow()
+{
+	TRACE_SCOPE("Grow");
+	m_slots.assign(m_slots.size() * 2, 0);
+	PackedState state;
+	for(size_t i = 0; i < m_recordsCount; ++i)
+	{
+		GetState(i, state);
+		m_slots[FindSlot(state)] = static_cast<unsigned int>(i + 1);
+	}
+}
+
+size_t CheckpointedSolver::FindSlot(const PackedState &state) const
+{
+	size_t mask = m_slots.size() - 1;
+	size_t i = static_cast<size_t>(StateFingerprints::Hash(state)) & mask;
+	for(; m_slots[i]; i = (i + 1) & mask)
+	{
+		if(0 == std::memcmp(GetRecord(m_slots[i] - 1), &state[0], m_stateSize * sizeof(unsigned short)))
+		{
+			break;
+		}
+	}
+	return i;
+}
+
+const unsigned char* CheckpointedSolver::GetRecord(size_t number) const
+{
+	return &m_chunks[number / ChunkRecords][(number % ChunkRecords) * m_recordSize];
+}
+
+void CheckpointedSolver::GetState(size_t number, PackedState &state) const
+{
+	state.resize(m_stateSize);
+	std::memcpy(&state[0], GetRecord(number), m_stateSize * sizeof(unsigned short));
+}
+
+void CheckpointedSolver::StartCheckpoint(const SolveStatistics &statistics)
+{
+	//the search doesn't wait for the previous checkpoint, it tries again a bit later
+	if(m_writer.joinable() && !m_writer.try_join_for(boost::chrono::milliseconds(0)))
+	{
+		return;
+	}
+	if(m_isWriteFailed)
+	{
+		throw std::runtime_error("the checkpoint can't be written: " + m_checkpointPath);
+	}
+	TRACE_SCOPE("StartCheckpoint");
+	Checkpoint checkpoint;
+	checkpoint.offset = static_cast<unsigned long long>(m_writtenCount) * m_recordSize;
+	for(size_t i = m_writtenCount; i < m_recordsCount; )
+	{
+		size_t piecesEnd = std::min((i / ChunkRecords + 1) * ChunkRecords, m_recordsCount);
+		checkpoint.pieces.push_back(std::make_pair(GetRecord(i), (piecesEnd - i) * m_recordSize));
+		i = piecesEnd;
+	}
+	std::ostringstream header;
+	header << g_headerMagic << "\n" << FormatPuzzle(m_puzzle) << "\n";
+	header << m_recordsCount << " " << m_head << " " << statistics.boardsQueued << " " << statistics.maxQueueSize << "\n";
+	checkpoint.header = header.str();
+	m_writtenCount = m_recordsCount;
+	m_nextCheckpoint = boost::chrono::steady_clock::now() + m_checkpointInterval;
+	m_writer = boost::thread(std::bind(&CheckpointedSolver::WriteCheckpoint, this, checkpoint));
+}
+
+void CheckpointedSolver::WriteCheckpoint(const Checkpoint &checkpoint)
+{
+	TRACE_SCOPE("WriteCheckpoint");
+	try
+	{
+		//the records are written before the header, which describes them, is replaced
+		std::fstream statesFile((m_checkpointPath + ".states").c_str(), std::ios::in | std::ios::out | std::ios::binary);
+		statesFile.seekp(static_cast<std::streamoff>(checkpoint.offset));
+		for(size_t i = 0; i < checkpoint.pieces.size(); ++i)
+		{
+			statesFile.write(reinterpret_cast<const char*>(checkpoint.pieces[i].first), checkpoint.pieces[i].second);
+		}
+		statesFile.flush();
+		std::string temporaryPath(m_checkpointPath + ".tmp");
+		std::ofstream headerFile(temporaryPath.c_str(), std::ios::binary | std::ios::trunc);
+		headerFile << checkpoint.header;
+		headerFile.close();
+		if(!statesFile || !headerFile)
+		{
+			m_isWriteFailed = true;
+			return;
+		}
+		boost::filesystem::rename(temporaryPath, m_checkpointPath);
+	}
+	catch(const std::exception&)
+	{
+		m_isWriteFailed = true;
+	}
+}
+
+void CheckpointedSolver::FinishCheckpoint()
+{
+	if(m_writer.joinable())
+	{
+		m_writer.join();
+	}
+	if(m_isWriteFailed)
+	{
+		throw std::runtime_error("the checkpoint can't be written: " + m_checkpointPath);
+	}
+}
+
+void CheckpointedSolver::RestoreSolution(size_t number, std::vector<TiltDirection> &solution) const
+{
+	solution.clear();
+	for(;;)
+	{
+		const unsigned char *record = GetRecord(number);
+		unsigned int parent;
+		std::memcpy(&parent, record + m_stateSize * sizeof(unsigned short), sizeof(parent));
+		if(NoParent == parent)
+		{
+			break;
+		}
+		solution.push_back(static_cast<TiltDirection>(record[m_recordSize - 1]));
+		number = parent;
+	}
+	std::reverse(solution.begin(), solution.end());
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "board2.h"
+#include "puzzle.h"
+#include "successor_generator.h"
+
+//The class CheckpointedSolver is a breadth-first search for the long solves, which can be killed at any time and resumed.
+//All the met states are kept as records in the order of the search with the number of the parent state and the tilt
+//which moved the parent to the state, so the queue is the records after the head and the solution is restored by the parent links.
+//The records are kept in the chunks which never move, so a checkpoint only hands the new records over to the writer thread
+//and the search goes on: the writer appends them to the file <path>.states and then writes the header (the puzzle,
+//the number of the records, the head of the queue and the statistics) to a temporary file renamed over the file <path>.
+//So the header always describes the records which are completely written, whenever the process is stopped.
+//On resume the records are read from the mapped states file and the search goes on exactly as if it was not stopped.
+//The states are expanded in the same order as Board2::Solve does, so the same solution is found.
+class CheckpointedSolver
+{
+public:
+	//the checkpoints are written each checkpointInterval seconds (0 - as often as the search checks the time)
+	static bool Solve(const Puzzle &puzzle, const std::string &checkpointPath, size_t checkpointInterval, std::vector<TiltDirection> &solution, SolveStatistics &statistics);
+	//throws invalid_argument if the checkpoint is missing or damaged
+	static bool Resume(const std::string &checkpointPath, size_t checkpointInterval, std::vector<TiltDirection> &solution, SolveStatistics &statistics);
+
+	~CheckpointedSolver();
+
+private:
+	//the part of the records and the header to write at a checkpoint
+	struct Checkpoint
+	{
+		unsigned long long offset;	//the offset of the first record in the states file
+		std::vector<std::pair<const unsigned char*, size_t>> pieces;	//the new records in the chunks
+		std::string header;
+	};
+	static const size_t ChunkRecords = 1 << 16;
+	//the number of the states expanded between the checks of the time
+	static const size_t CheckpointCheckStates = 64;
+	static const unsigned int NoParent = 0xFFFFFFFF;
+
+	CheckpointedSolver(const Puzzle &puzzle, const std::string &checkpointPath, size_t checkpointInterval);
+	CheckpointedSolver(const CheckpointedSolver&);
+	CheckpointedSolver& operator=(const CheckpointedSolver&);
+
+	bool Search(std::vector<TiltDirection> &solution, SolveStatistics &statistics);
+	//creates the states file and starts the search from the puzzle
+	void Start();
+	//reads the records of the checkpoint from the states file
+	void ReadRecords(size_t recordsCount);
+	//appends the state if it is not met yet, returns false otherwise
+	bool Insert(const PackedState &state, unsigned int parent, TiltDirection move);
+	void Grow();
+	void AppendRecord(const unsigned char *record);
+	//returns the slot of the state or the empty slot where it should be
+	size_t FindSlot(const PackedState &state) const;
+	const unsigned char* GetRecord(size_t number) const;
+	void GetState(size_t number, PackedState &state) const;
+	void StartCheckpoint(const SolveStatistics &statistics);
+	void WriteCheckpoint(const Checkpoint &checkpoint);
+	void FinishCheckpoint();
+	void RestoreSolution(size_t number, std::vector<TiltDirection> &solution) const;
+
+	Puzzle m_puzzle;
+	Board2 m_board;	//the board of the start state
+	SuccessorGenerator m_generator;	//makes the tilts of the states
+	std::string m_checkpointPath;
+	boost::chrono::steady_clock::duration m_checkpointInterval;
+	boost::chrono::steady_clock::time_point m_nextCheckpoint;
+	size_t m_stateSize;
+	size_t m_recordSize;	//the state, the parent number and the tilt
+	std::deque<std::vector<unsigned char>> m_chunks;
+	std::vector<unsigned char> m_record;	//the record being inserted
+	size_t m_recordsCount;
+	size_t m_head;	//the number of the record to expand next
+	std::vector<unsigned int> m_slots;	//the hash set of the records: the record number + 1, zero is an empty slot
+	size_t m_writtenCount;	//the number of the records handed over to the writer
+	boost::thread m_writer;
+	bool m_isWriteFailed;	//set by the writer, read after it is joined
+};
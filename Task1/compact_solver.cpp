@@ -0,0 +1,241 @@
+#include "stdafx.h"
+#include "compact_solver.h"
+#include "trace.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, South, East, North};
+	const size_t g_directionsCount = sizeof(g_directions) / sizeof(g_directions[0]);
+}
+
+bool CompactSolver::Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, size_t chunkSize,
+	const Cancellation *cancellation)
+{
+	TRACE_SCOPE("CompactSolver::Solve");
+	if(!chunkSize)
+	{
+		throw std::invalid_argument("chunkSize should be possitive");
+	}
+	statistics = SolveStatistics();
+	solution.clear();
+	if(originalBoard.IsGameLost())
+	{
+		return false;
+	}
+	if(originalBoard.IsGameWon())
+	{
+		return true;
+	}
+	CompactSolver solver(originalBoard, chunkSize);
+	return solver.Search(solution, statistics, cancellation);
+}
+
+CompactSolver::CompactSolver(const Board2 &originalBoard, size_t chunkSize)
+	:m_board(originalBoard)
+	,m_generator(originalBoard)
+	,m_stateSize()
+	,m_chunkSize(chunkSize)
+	,m_layers()
+	,m_fingerprints()
+	,m_chunk()
+	,m_chunkOrder()
+	,m_runs()
+{
+	PackedState start;
+	m_board.GetPackedState(start);
+	m_stateSize = start.size();
+	m_layers.push_back(CompressedStateList(m_stateSize));
+	m_layers.back().Append(start);
+	m_fingerprints.Insert(StateFingerprints::Hash(start), 0);
+}
+
+bool CompactSolver::Search(std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+{
+	PackedState state;
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	for(size_t layer = 0; m_layers[layer].Size(); ++layer)
+	{
+		TRACE_SCOPE("Layer");
+		statistics.statesMet += m_layers[layer].Size();
+		statistics.maxQueueSize = std::max(statistics.maxQueueSize, m_layers[layer].Size());
+		CompressedStateList::Reader reader(m_layers[layer]);
+		while(reader.Next(state))
+		{
+			if(cancellation)
+			{
+				cancellation->Check();
+			}
+			m_generator.Expand(state, successors);
+			for(size_t i = 0; i < g_directionsCount; ++i)
+			{
+				const SuccessorGenerator::Successor &successor = successors[g_directions[i]];
+				++statistics.boardsQueued;
+				if(SuccessorGenerator::Lost == successor.outcome)
+				{
+					continue;
+				}
+				if(SuccessorGenerator::Won == successor.outcome)
+				{
+					RestoreSolution(layer, state, solution);
+					solution.push_back(g_directions[i]);
+					return true;
+				}
+				if(IsVisited(successor.state, StateFingerprints::Hash(successor.state)))
+				{
+					continue;
+				}
+				m_chunk.insert(m_chunk.end(), successor.state.begin(), successor.state.end());
+				if(m_chunk.size() >= m_chunkSize * m_stateSize)
+				{
+					FlushRun();
+				}
+			}
+		}
+		FlushRun();
+		MergeRuns();
+	}
+	return false;
+}
+
+bool CompactSolver::IsVisited(const PackedState &state, unsigned long long hash) const
+{
+	const std::vector<CompressedStateList> &layers = m_layers;
+	return m_fingerprints.Find(hash, [&](size_t layer) {
+		return layers[layer].Contains(state);
+	});
+}
+
+void CompactSolver::FlushRun()
+{
+	if(m_chunk.empty())
+	{
+		return;
+	}
+	TRACE_SCOPE("FlushRun");
+	const unsigned short *chunk = &m_chunk[0];
+	size_t stateSize = m_stateSize;
+	m_chunkOrder.resize(m_chunk.size() / stateSize);
+	for(size_t i = 0; i < m_chunkOrder.size(); ++i)
+	{
+		m_chunkOrder[i] = static_cast<unsigned int>(i);
+	}
+	std::sort(m_chunkOrder.begin(), m_chunkOrder.end(), [=](unsigned int left, unsigned int right) {
+		return std::lexicographical_compare(chunk + left * stateSize, chunk + (left + 1) * stateSize, chunk + right * stateSize, chunk + (right + 1) * stateSize);
+	});
+	m_runs.push_back(CompressedStateList(stateSize));
+	PackedState state;
+	for(size_t i = 0; i < m_chunkOrder.size(); ++i)
+	{
+		const unsigned short *current = chunk + m_chunkOrder[i] * stateSize;
+		//the same state may be met several times
+		if(i && std::equal(current, current + stateSize, state.begin()))
+		{
+			continue;
+		}
+		state.assign(current, current + stateSize);
+		m_runs.back().Append(state);
+	}
+	m_chunk.clear();
+}
+
+void CompactSolver::MergeRuns()
+{
+	TRACE_SCOPE("MergeRuns");
+	size_t layer = m_layers.size();
+	m_layers.push_back(CompressedStateList(m_stateSize));
+	CompressedStateList &merged = m_layers.back();
+
+	std::vector<CompressedStateList::Reader> readers;
+	std::vector<PackedState> heads(m_runs.size());
+	std::vector<bool> isRunOver(m_runs.size());
+	for(size_t i = 0; i < m_runs.size(); ++i)
+	{
+		readers.push_back(CompressedStateList::Reader(m_runs[i]));
+		isRunOver[i] = !readers[i].Next(heads[i]);
+	}
+	for(;;)
+	{
+		size_t least = m_runs.size();
+		for(size_t i = 0; i < m_runs.size(); ++i)
+		{
+			if(!isRunOver[i] && (least == m_runs.size() || heads[i] < heads[least]))
+			{
+				least = i;
+			}
+		}
+		if(least == m_runs.size())
+		{
+			break;
+		}
+		PackedState state(heads[least]);
+		//the same state may be in several runs
+		for(size_t i = 0; i < m_runs.size(); ++i)
+		{
+			while(!isRunOver[i] && heads[i] == state)
+			{
+				isRunOver[i] = !readers[i].Next(heads[i]);
+			}
+		}
+		merged.Append(state);
+	}
+	m_runs.clear();
+	InsertFingerprints(layer);
+}
+
+void CompactSolver::InsertFingerprints(size_t layer)
+{
+	TRACE_SCOPE("InsertFingerprints");
+	size_t first = layer;
+	if(!m_fingerprints.Fits(m_layers[layer].Size()))
+	{
+		size_t count = 0;
+		for(size_t i = 0; i <= layer; ++i)
+		{
+			count += m_layers[i].Size();
+		}
+		m_fingerprints.Grow(count);
+		first = 0;
+	}
+	PackedState state;
+	for(size_t i = first; i <= layer; ++i)
+	{
+		CompressedStateList::Reader reader(m_layers[i]);
+		while(reader.Next(state))
+		{
+			m_fingerprints.Insert(StateFingerprints::Hash(state), i);
+		}
+	}
+}
+
+void CompactSolver::RestoreSolution(size_t layer, const PackedState &state, std::vector<TiltDirection> &solution)
+{
+	TRACE_SCOPE("RestoreSolution");
+	solution.clear();
+	PackedState target(state);
+	PackedState parent;
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	for(; layer > 0; --layer)
+	{
+		bool isFound = false;
+		CompressedStateList::Reader reader(m_layers[layer - 1]);
+		while(!isFound && reader.Next(parent))
+		{
+			m_generator.Expand(parent, successors);
+			for(size_t i = 0; i < g_directionsCount && !isFound; ++i)
+			{
+				const SuccessorGenerator::Successor &successor = successors[g_directions[i]];
+				if(SuccessorGenerator::Moved == successor.outcome && successor.state == target)
+				{
+					solution.push_back(g_directions[i]);
+					isFound = true;
+				}
+			}
+		}
+		if(!isFound)
+		{
+			throw std::logic_error("the state has no parent in the previous layer");
+		}
+		target = parent;
+	}
+	std::reverse(solution.begin(), solution.end());
+}
@@ -0,0 +1,44 @@
+#pragma once
+
+#include "board2.h"
+#include "compressed_states.h"
+#include "successor_generator.h"
+#include "cancellation.h"
+
+//The class CompactSolver is a breadth-first search for the large state spaces, which keeps a few bytes per state.
+//Each layer of the search is kept as a sorted CompressedStateList and the visited states are found with StateFingerprints
+//(a found fingerprint is confirmed in the layer it points to, the fingerprints are inserted again from the layers when the set is full).
+//The next layer is collected in sorted runs of chunkSize states, which are merged into one list when the layer is over. No parents are kept: the solution is restored backwards,
+//by finding in each previous layer a state which is moved to the current one by a tilt.
+//Note: the layers are expanded in the sorted order, so the found solution is the shortest one but not necessary the one found by Board2::Solve.
+class CompactSolver
+{
+public:
+	static const size_t DefaultChunkSize = 1 << 16;
+
+	//throws SolveCancelled when the cancellation (if any) is requested
+	static bool Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, size_t chunkSize = DefaultChunkSize,
+		const Cancellation *cancellation = 0);
+
+private:
+	CompactSolver(const Board2 &originalBoard, size_t chunkSize);
+
+	bool Search(std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation);
+	bool IsVisited(const PackedState &state, unsigned long long hash) const;
+	void FlushRun();
+	void MergeRuns();
+	//inserts the fingerprints of the layer, the set is grown and filled from all the layers if they don't fit it
+	void InsertFingerprints(size_t layer);
+	//restores the tilts which move the start to the state of the layer
+	void RestoreSolution(size_t layer, const PackedState &state, std::vector<TiltDirection> &solution);
+
+	Board2 m_board;	//the board of the start state
+	SuccessorGenerator m_generator;	//makes the tilts of the states
+	size_t m_stateSize;
+	size_t m_chunkSize;
+	std::vector<CompressedStateList> m_layers;
+	StateFingerprints m_fingerprints;
+	std::vector<unsigned short> m_chunk;	//unsorted states of the next layer one after another
+	std::vector<unsigned int> m_chunkOrder;	//the numbers of the chunk's states in the sorted order
+	std::vector<CompressedStateList> m_runs;	//sorted states of the next layer
+};
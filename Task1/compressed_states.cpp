@@ -0,0 +1,248 @@
+#include "stdafx.h"
+#include "compressed_states.h"
+
+namespace
+{
+	void WriteNumber(std::vector<unsigned char> &data, unsigned int number)
+	{
+		while(number >= 0x80)
+		{
+			data.push_back(static_cast<unsigned char>(number | 0x80));
+			number >>= 7;
+		}
+		data.push_back(static_cast<unsigned char>(number));
+	}
+
+	unsigned int ReadNumber(const std::vector<unsigned char> &data, size_t &offset)
+	{
+		unsigned int number = 0;
+		for(unsigned int shift = 0; ; shift += 7)
+		{
+			unsigned char byte = data[offset++];
+			number |= static_cast<unsigned int>(byte & 0x7F) << shift;
+			if(!(byte & 0x80))
+			{
+				return number;
+			}
+		}
+	}
+
+	//the sunk balls are the most frequent elements, so they are shifted to take one byte
+	unsigned int EncodeElement(unsigned short element)
+	{
+		return static_cast<unsigned short>(element + 1);
+	}
+
+	unsigned short DecodeElement(unsigned int number)
+	{
+		return static_cast<unsigned short>(number - 1);
+	}
+}
+
+CompressedStateList::CompressedStateList(size_t stateSize)
+	:m_stateSize(stateSize)
+	,m_size(0)
+	,m_data()
+	,m_blockOffsets()
+	,m_blockHeads()
+	,m_last()
+{
+	if(stateSize > 0xFF)
+	{
+		throw std::invalid_argument("stateSize should fit one byte");
+	}
+}
+
+void CompressedStateList::Append(const PackedState &state)
+{
+	if(state.size() != m_stateSize)
+	{
+		throw std::invalid_argument("all the states of the list should have the same size");
+	}
+	if(m_size && !std::lexicographical_compare(m_last.begin(), m_last.end(), state.begin(), state.end()))
+	{
+		throw std::logic_error("the states should be appended in the increasing order");
+	}
+
+	if(0 == m_size % BlockSize)
+	{
+		m_blockHeads.insert(m_blockHeads.end(), state.begin(), state.end());
+		m_blockOffsets.push_back(m_data.size());
+	}
+	else
+	{
+		size_t shared = std::mismatch(state.begin(), state.end(), m_last.begin()).first - state.begin();
+		m_data.push_back(static_cast<unsigned char>(shared));
+		WriteNumber(m_data, state[shared] - m_last[shared]);
+		for(size_t i = shared + 1; i < m_stateSize; ++i)
+		{
+			WriteNumber(m_data, EncodeElement(state[i]));
+		}
+	}
+	m_last = state;
+	++m_size;
+}
+
+bool CompressedStateList::Contains(const PackedState &state) const
+{
+	if(!m_size)
+	{
+		return false;
+	}
+
+	//find the last block with the head not greater than the state
+	size_t first = 0;
+	size_t last = m_blockOffsets.size();
+	while(last - first > 1)
+	{
+		size_t middle = (first + last) / 2;
+		const unsigned short *head = &m_blockHeads[middle * m_stateSize];
+		if(std::lexicographical_compare(state.begin(), state.end(), head, head + m_stateSize))
+		{
+			last = middle;
+		}
+		else
+		{
+			first = middle;
+		}
+	}
+
+	PackedState current(m_blockHeads.begin() + first * m_stateSize, m_blockHeads.begin() + (first + 1) * m_stateSize);
+	size_t offset = m_blockOffsets[first];
+	size_t blockEnd = std::min(m_size, (first + 1) * BlockSize);
+	for(size_t i = first * BlockSize; ; )
+	{
+		if(current == state)
+		{
+			return true;
+		}
+		if(++i == blockEnd || std::lexicographical_compare(state.begin(), state.end(), current.begin(), current.end()))
+		{
+			return false;
+		}
+		DecodeNext(offset, current);
+	}
+}
+
+size_t CompressedStateList::Size() const
+{
+	return m_size;
+}
+
+size_t CompressedStateList::GetBytes() const
+{
+	return m_data.capacity() + m_blockOffsets.capacity() * sizeof(size_t) + m_blockHeads.capacity() * sizeof(unsigned short);
+}
+
+void CompressedStateList::Clear()
+{
+	m_size = 0;
+	std::vector<unsigned char>().swap(m_data);
+	std::vector<size_t>().swap(m_blockOffsets);
+	std::vector<unsigned short>().swap(m_blockHeads);
+	m_last.clear();
+}
+
+void CompressedStateList::DecodeNext(size_t &offset, PackedState &state) const
+{
+	size_t shared = m_data[offset++];
+	state[shared] = static_cast<unsigned short>(state[shared] + ReadNumber(m_data, offset));
+	for(size_t i = shared + 1; i < m_stateSize; ++i)
+	{
+		state[i] = DecodeElement(ReadNumber(m_data, offset));
+	}
+}
+
+CompressedStateList::Reader::Reader(const CompressedStateList &list)
+	:m_list(list)
+	,m_index(0)
+	,m_offset(0)
+{
+}
+
+bool CompressedStateList::Reader::Next(PackedState &state)
+{
+	if(m_index == m_list.m_size)
+	{
+		return false;
+	}
+	if(0 == m_index % BlockSize)
+	{
+		size_t block = m_index / BlockSize;
+		state.assign(m_list.m_blockHeads.begin() + block * m_list.m_stateSize, m_list.m_blockHeads.begin() + (block + 1) * m_list.m_stateSize);
+		m_offset = m_list.m_blockOffsets[block];
+	}
+	else
+	{
+		m_list.DecodeNext(m_offset, state);
+	}
+	++m_index;
+	return true;
+}
+
+unsigned long long StateFingerprints::Hash(const PackedState &state)
+{
+	unsigned long long hash = 0x9E3779B97F4A7C15ULL;
+	for(PackedState::const_iterator it = state.begin(); it != state.end(); ++it)
+	{
+		hash = (hash ^ *it) * 0xFF51AFD7ED558CCDULL;
+		hash ^= hash >> 32;
+	}
+	return hash;
+}
+
+StateFingerprints::StateFingerprints()
+	:m_slots(MinSlotsCount)
+	,m_size(0)
+{
+}
+
+bool StateFingerprints::Fits(size_t count) const
+{
+	return 4 * (m_size + count) <= 3 * m_slots.size();
+}
+
+void StateFingerprints::Grow(size_t count)
+{
+	size_t slotsCount = 2 * m_slots.size();
+	while(4 * count > 3 * slotsCount)
+	{
+		slotsCount *= 2;
+	}
+	//the old slots are freed before the new ones are taken
+	std::vector<unsigned int>().swap(m_slots);
+	m_slots.assign(slotsCount, 0);
+	m_size = 0;
+}
+
+void StateFingerprints::Insert(unsigned long long hash, size_t listNumber)
+{
+	if(listNumber > ListMask)
+	{
+		throw std::domain_error("too many lists for the fingerprints");
+	}
+	if(!Fits(1))
+	{
+		throw std::logic_error("the fingerprints should be grown for more states");
+	}
+	size_t mask = m_slots.size() - 1;
+	size_t i = static_cast<size_t>(hash) & mask;
+	while(m_slots[i])
+	{
+		i = (i + 1) & mask;
+	}
+	m_slots[i] = (Remainder(hash) << 16) | static_cast<unsigned int>(listNumber);
+	++m_size;
+}
+
+size_t StateFingerprints::GetBytes() const
+{
+	return m_slots.capacity() * sizeof(unsigned int);
+}
+
+unsigned int StateFingerprints::Remainder(unsigned long long hash)
+{
+	//zero remainder would make the slot of the list zero look empty
+	unsigned int remainder = static_cast<unsigned int>(hash >> 48);
+	return remainder ? remainder : 1;
+}
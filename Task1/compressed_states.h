@@ -0,0 +1,93 @@
+#pragma once
+
+#include "packed_state.h"
+
+//The class CompressedStateList stores a sorted list of packed states of the same size in blocks of front coded states.
+//The first state of each block is kept as is (so the list can be searched with a binary search over the blocks),
+//the other states keep only the number of the elements shared with the previous state, the delta of the first different element
+//and the rest of the elements, all as variable length numbers. For the sorted states of the search this takes a few bytes per state.
+class CompressedStateList
+{
+public:
+	//The class Reader decodes the states of the list one by one.
+	class Reader
+	{
+	public:
+		explicit Reader(const CompressedStateList &list);
+		//returns false when there are no more states
+		bool Next(PackedState &state);
+
+	private:
+		const CompressedStateList &m_list;
+		size_t m_index;
+		size_t m_offset;
+	};
+
+	explicit CompressedStateList(size_t stateSize);
+	//the states should be appended in the strictly increasing order (logic_error is thrown otherwise)
+	void Append(const PackedState &state);
+	bool Contains(const PackedState &state) const;
+	size_t Size() const;
+	size_t GetBytes() const;
+	void Clear();
+
+private:
+	static const size_t BlockSize = 64;
+
+	void DecodeNext(size_t &offset, PackedState &state) const;
+
+	size_t m_stateSize;
+	size_t m_size;
+	std::vector<unsigned char> m_data;
+	std::vector<size_t> m_blockOffsets;	//offsets in the data of the second states of the blocks
+	std::vector<unsigned short> m_blockHeads;	//the first states of the blocks one after another
+	PackedState m_last;
+};
+
+//The class StateFingerprints is a compact hash set of the states' fingerprints, each with the number of the list (the search layer) the state is stored in.
+//As in a quotient filter, the low bits of a state hash (the quotient) give the slot and only 16 high bits (the remainder)
+//are kept with the list number, so a slot takes 4 bytes. The quotients are not kept and the set can't rehash itself:
+//it's grown empty and the fingerprints are inserted again from the lists.
+//A found fingerprint is only a hint, so membership should be confirmed in the list it points to;
+//an absent fingerprint proves the state is new without touching the lists.
+class StateFingerprints
+{
+public:
+	static unsigned long long Hash(const PackedState &state);
+
+	StateFingerprints();
+	//tells whether count more fingerprints fit the set
+	bool Fits(size_t count) const;
+	//removes all the fingerprints and makes the set twice as large at least and large enough for count ones
+	void Grow(size_t count);
+	//throws logic_error if the set is full (it should be grown first) and domain_error for the list number over 0xFFFF
+	void Insert(unsigned long long hash, size_t listNumber);
+	//calls isInList(listNumber) for each list with the matching fingerprint till it returns true
+	template <class Predicate>
+	bool Find(unsigned long long hash, Predicate isInList) const;
+	size_t GetBytes() const;
+
+private:
+	static const unsigned int ListMask = 0xFFFF;
+	static const size_t MinSlotsCount = 1 << 10;
+
+	static unsigned int Remainder(unsigned long long hash);
+
+	std::vector<unsigned int> m_slots;	//remainder << 16 | listNumber; zero is an empty slot
+	size_t m_size;
+};
+
+template <class Predicate>
+bool StateFingerprints::Find(unsigned long long hash, Predicate isInList) const
+{
+	unsigned int remainder = Remainder(hash);
+	size_t mask = m_slots.size() - 1;
+	for(size_t i = static_cast<size_t>(hash) & mask; m_slots[i]; i = (i + 1) & mask)
+	{
+		if((m_slots[i] >> 16) == remainder && isInList(static_cast<size_t>(m_slots[i] & ListMask)))
+		{
+			return true;
+		}
+	}
+	return false;
+}
@@ -0,0 +1,246 @@
+#include "stdafx.h"
+#include "dead_patterns.h"
+#include "trace.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, East, North, South};
+	const size_t g_directionsCount = sizeof(g_directions) / sizeof(g_directions[0]);
+	const size_t NoParent = static_cast<size_t>(-1);
+}
+
+bool DeadPatterns::IsApplicable(size_t boardSize, size_t ballsCount, unsigned long long memoryLimit)
+{
+	unsigned long long positions = static_cast<unsigned long long>(boardSize * boardSize + 1) * (boardSize * boardSize + 1);
+	unsigned long long pairs = static_cast<unsigned long long>(ballsCount) * (ballsCount ? ballsCount - 1 : 0) / 2;
+	return boardSize * boardSize < NoCell && pairs * positions <= memoryLimit;
+}
+
+DeadPatterns::DeadPatterns(const Board2 &board)
+	:m_ballsCount(board.GetHolesCells().size())
+	,m_cellsCount(board.GetBoardSize() * board.GetBoardSize())
+	,m_holes()
+	,m_statuses(m_ballsCount * m_ballsCount)
+	,m_deadCount(0)
+	,m_marks(MarksCount, 0)
+	,m_markedPositions(MarksCount)
+	,m_stamp(0)
+	,m_queue()
+	,m_parents()
+	,m_children()
+	,m_firstStops()
+	,m_secondStops()
+{
+	if(!IsApplicable(board.GetBoardSize(), m_ballsCount))
+	{
+		throw std::domain_error("the positions of the pairs of the balls don't fit the memory limit");
+	}
+	const std::vector<size_t> &holesCells = board.GetHolesCells();
+	m_holes.assign(m_cellsCount, -1);
+	for(size_t i = 0; i < holesCells.size(); ++i)
+	{
+		m_holes[holesCells[i]] = static_cast<int>(i);
+	}
+	for(size_t i = 0; i < g_directionsCount; ++i)
+	{
+		TiltDirection direction = g_directions[i];
+		std::vector<size_t> offsets;
+		std::vector<unsigned short> cells;
+		board.GetAdjacentSequences(direction, offsets, cells);
+		m_next[direction].resize(m_cellsCount);
+		m_sequences[direction].resize(m_cellsCount);
+		m_places[direction].resize(m_cellsCount);
+		//each sequence starts at the cell the balls move to
+		for(size_t j = 0; j + 1 < offsets.size(); ++j)
+		{
+			for(size_t position = offsets[j]; position < offsets[j + 1]; ++position)
+			{
+				m_next[direction][cells[position]] = position == offsets[j] ? NoCell : cells[position - 1];
+				m_sequences[direction][cells[position]] = static_cast<unsigned short>(j);
+				m_places[direction][cells[position]] = static_cast<unsigned short>(position - offsets[j]);
+			}
+		}
+	}
+}
+
+bool DeadPatterns::IsDead(const PackedState &state)
+{
+	for(size_t first = 0; first < m_ballsCount; ++first)
+	{
+		size_t firstCell = SunkBall == state[first] ? m_cellsCount : state[first];
+		for(size_t second = first + 1; second < m_ballsCount; ++second)
+		{
+			size_t secondCell = SunkBall == state[second] ? m_cellsCount : state[second];
+			if(m_cellsCount == firstCell && m_cellsCount == secondCell)
+			{
+				continue;
+			}
+			std::vector<unsigned char> &statuses = m_statuses[first * m_ballsCount + second];
+			if(statuses.empty())
+			{
+				statuses.assign((m_cellsCount + 1) * (m_cellsCount + 1), Unknown);
+			}
+			size_t position = firstCell * (m_cellsCount + 1) + secondCell;
+			Status status = static_cast<Status>(statuses[position]);
+			if(Unknown == status)
+			{
+				status = Analyse(first, second, position);
+			}
+			if(Dead == status)
+			{
+				return true;
+			}
+		}
+	}
+	return false;
+}
+
+size_t DeadPatterns::GetDeadCount() const
+{
+	return m_deadCount;
+}
+
+DeadPatterns::Status DeadPatterns::Analyse(size_t first, size_t second, size_t position)
+{
+	TRACE_SCOPE("DeadPatterns::Analyse");
+	std::vector<unsigned char> &statuses = m_statuses[first * m_ballsCount + second];
+	if(!++m_stamp)
+	{
+		std::fill(m_marks.begin(), m_marks.end(), 0);
+		m_stamp = 1;
+	}
+	size_t sunkPair = m_cellsCount * (m_cellsCount + 1) + m_cellsCount;
+	m_queue.assign(1, position);
+	m_parents.assign(1, NoParent);
+	Mark(position);
+	for(size_t head = 0; head < m_queue.size(); ++head)
+	{
+		size_t firstCell = m_queue[head] / (m_cellsCount + 1);
+		size_t secondCell = m_queue[head] % (m_cellsCount + 1);
+		for(size_t i = 0; i < g_directionsCount; ++i)
+		{
+			Tilt(g_directions[i], first, second, firstCell, secondCell, m_children);
+			for(size_t j = 0; j < m_children.size(); ++j)
+			{
+				size_t child = m_children[j];
+				if(sunkPair == child || NotDead == statuses[child])
+				{
+					//the positions the search went through to the child are not dead too
+					for(size_t k = head; NoParent != k; k = m_parents[k])
+					{
+						statuses[m_queue[k]] = NotDead;
+					}
+					return NotDead;
+				}
+				if(Dead == statuses[child] || !Mark(child))
+				{
+					continue;
+				}
+				if(m_queue.size() >= MaxSearchPositions)
+				{
+					statuses[position] = NotDead;
+					return NotDead;
+				}
+				m_queue.push_back(child);
+				m_parents.push_back(head);
+			}
+		}
+	}
+	//no position met by the search leads to the sunk pair
+	for(size_t i = 0; i < m_queue.size(); ++i)
+	{
+		statuses[m_queue[i]] = Dead;
+	}
+	m_deadCount += m_queue.size();
+	return Dead;
+}
+
+bool DeadPatterns::Mark(size_t position)
+{
+	size_t mask = MarksCount - 1;
+	size_t i = static_cast<size_t>((position + 1) * 0x9E3779B97F4A7C15ULL >> 32) & mask;
+	for(; m_stamp == m_marks[i]; i = (i + 1) & mask)
+	{
+		if(m_markedPositions[i] == position)
+		{
+			return false;
+		}
+	}
+	m_marks[i] = m_stamp;
+	m_markedPositions[i] = position;
+	return true;
+}
+
+void DeadPatterns::Tilt(size_t direction, size_t first, size_t second, size_t firstCell, size_t secondCell, std::vector<size_t> &positions)
+{
+	positions.clear();
+	bool isFirstOnBoard = firstCell != m_cellsCount;
+	bool isSecondOnBoard = secondCell != m_cellsCount;
+	if(isFirstOnBoard && isSecondOnBoard && m_sequences[direction][firstCell] == m_sequences[direction][secondCell])
+	{
+		//the ball nearer to the border moves first, the other one stops before it or passes its hole if it's sunk
+		bool isFirstAhead = m_places[direction][firstCell] < m_places[direction][secondCell];
+		size_t ahead = isFirstAhead ? first : second;
+		size_t behind = isFirstAhead ? second : first;
+		Slide(direction, ahead, isFirstAhead ? firstCell : secondCell, NoCell, behind, true, m_firstStops);
+		for(size_t i = 0; i < m_firstStops.size(); ++i)
+		{
+			bool isAheadSunk = m_cellsCount == m_firstStops[i];
+			Slide(direction, behind, isFirstAhead ? secondCell : firstCell, isAheadSunk ? NoCell : m_firstStops[i], ahead, !isAheadSunk, m_secondStops);
+			for(size_t j = 0; j < m_secondStops.size(); ++j)
+			{
+				size_t firstStop = isFirstAhead ? m_firstStops[i] : m_secondStops[j];
+				size_t secondStop = isFirstAhead ? m_secondStops[j] : m_firstStops[i];
+				positions.push_back(firstStop * (m_cellsCount + 1) + secondStop);
+			}
+		}
+		return;
+	}
+	//the balls of the different sequences don't meet, the hole of a ball is not sunk during the tilt of another sequence
+	m_firstStops.assign(1, firstCell);
+	m_secondStops.assign(1, secondCell);
+	if(isFirstOnBoard)
+	{
+		Slide(direction, first, firstCell, NoCell, second, isSecondOnBoard, m_firstStops);
+	}
+	if(isSecondOnBoard)
+	{
+		Slide(direction, second, secondCell, NoCell, first, isFirstOnBoard, m_secondStops);
+	}
+	for(size_t i = 0; i < m_firstStops.size(); ++i)
+	{
+		for(size_t j = 0; j < m_secondStops.size(); ++j)
+		{
+			positions.push_back(m_firstStops[i] * (m_cellsCount + 1) + m_secondStops[j]);
+		}
+	}
+}
+
+void DeadPatterns::Slide(size_t direction, size_t ball, size_t cell, size_t obstacle, size_t otherBall, bool isOtherOnBoard, std::vector<size_t> &stops) const
+{
+	stops.clear();
+	const std::vector<unsigned short> &next = m_next[direction];
+	for(size_t current = cell; ; )
+	{
+		size_t following = next[current];
+		if(NoCell == following || following == obstacle)
+		{
+			stops.push_back(current);
+			return;
+		}
+		int hole = m_holes[following];
+		if(hole == static_cast<int>(ball))
+		{
+			stops.push_back(m_cellsCount);
+			return;
+		}
+		//the ball falling to the hole of the other ball loses the game, no ball can stand on the hole to stop it
+		if(isOtherOnBoard && hole == static_cast<int>(otherBall))
+		{
+			return;
+		}
+		//another ball may stand at the following cell (even at another hole, its ball may be sunk already)
+		stops.push_back(current);
+		current = following;
+	}
+}
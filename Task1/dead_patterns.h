@@ -0,0 +1,67 @@
+#pragma once
+
+#include "board2.h"
+
+//The class DeadPatterns finds the pairs of the balls which positions lose the game whatever the other balls are and where they are,
+//so a search doesn't go through all the combinations of the other balls to find out that a state is lost.
+//The pair of the balls is played alone on the board with the other balls replaced by what they could do: a ball of the pair
+//may be stopped before any cell another ball could stand in and may pass any other hole (its ball could be sunk already).
+//So each tilt of the pair has the choice of the cells each ball stops at (the pair's own holes and balls are exact, the balls of a line
+//move from the border they go to, as in Board2::Tilt). If no choices sink both balls, no state of the whole board with the pair there
+//can be won, since each tilt of the whole board is one of the choices for the pair (or loses the game).
+//The positions of each pair are analysed when a state first has them: a breadth-first search over the positions of the pair stops
+//at the sunk pair or at a position known not to be dead, so all the positions met by the exhausted search are dead.
+//The search gives up after MaxSearchPositions positions, then the pair is just not proven dead.
+//Note: the patterns are the pairs only (a single ball which can't reach its hole is dead with any other ball),
+//the patterns of three balls would take (cells + 1)^3 statuses for each triple.
+class DeadPatterns
+{
+public:
+	//the most bytes of the statuses of all the pairs
+	static const unsigned long long DefaultMemoryLimit = 64 << 20;
+
+	//tells whether the statuses of the pairs of the balls fit the memory limit
+	static bool IsApplicable(size_t boardSize, size_t ballsCount, unsigned long long memoryLimit = DefaultMemoryLimit);
+
+	//the board gives the walls and the holes, its balls are not used; domain_error is thrown if the patterns are not applicable
+	explicit DeadPatterns(const Board2 &board);
+	//tells whether a pair of the balls of the state is in a dead position (the new positions of the pairs are analysed first)
+	bool IsDead(const PackedState &state);
+	//the number of the dead positions of the pairs found so far
+	size_t GetDeadCount() const;
+
+private:
+	enum Status {Unknown, NotDead, Dead};
+	static const size_t MaxSearchPositions = 4096;
+	static const size_t MarksCount = 2 * MaxSearchPositions;	//the slots of the marks, a power of two
+	static const unsigned short NoCell = 0xFFFF;
+
+	//finds out the status of the position of the balls of the pair
+	Status Analyse(size_t first, size_t second, size_t position);
+	//marks the position as met by the current search, returns false if it's marked already
+	bool Mark(size_t position);
+	//fills the positions of the pair after the tilt
+	void Tilt(size_t direction, size_t first, size_t second, size_t firstCell, size_t secondCell, std::vector<size_t> &positions);
+	//fills the cells the ball may stop at (or m_cellsCount if it's sunk) before the obstacle cell, the ball of the other hole is still on the board
+	void Slide(size_t direction, size_t ball, size_t cell, size_t obstacle, size_t otherBall, bool isOtherOnBoard, std::vector<size_t> &stops) const;
+
+	size_t m_ballsCount;
+	size_t m_cellsCount;	//also the cell of the sunk balls
+	std::vector<int> m_holes;	//the hole number of each cell or -1
+	//the next cell each cell is tilted to (or NoCell at a wall or the border), the sequence of the cell and its place in it for each direction
+	std::vector<unsigned short> m_next[4];
+	std::vector<unsigned short> m_sequences[4];
+	std::vector<unsigned short> m_places[4];
+	std::vector<std::vector<unsigned char>> m_statuses;	//the statuses of the positions of each pair, allocated when the pair is first met
+	size_t m_deadCount;
+	//the search buffers, the positions met by the current search are marked with its stamp in the hash table of MarksCount slots
+	//(the search meets at most MaxSearchPositions positions, so the marks don't grow with the board)
+	std::vector<unsigned int> m_marks;
+	std::vector<size_t> m_markedPositions;
+	unsigned int m_stamp;
+	std::vector<size_t> m_queue;
+	std::vector<size_t> m_parents;
+	std::vector<size_t> m_children;
+	std::vector<size_t> m_firstStops;
+	std::vector<size_t> m_secondStops;
+};
@@ -0,0 +1,224 @@
+#include "stdafx.h"
+#include "engine.h"
+#include "board2.h"
+#include "sparse_board.h"
+#include "ranked_solver.h"
+#include "best_first_solver.h"
+#include "nogood_solver.h"
+#include "compact_solver.h"
+
+Engine::~Engine()
+{
+}
+
+namespace
+{
+	//the digests of the boards, which keep the real positions
+	template <typename BoardType>
+	BoardStateDigest ExportStateDigest(const BoardType &board)
+	{
+		return board.GetStateDigest();
+	}
+
+	//the board keeps the positions in its matrix with the walls between the cells
+	BoardStateDigest ExportStateDigest(const Board &board)
+	{
+		BoardStateDigest digest(board.GetStateDigest());
+		for(BoardStateDigest::iterator it = digest.begin(); it != digest.end(); ++it)
+		{
+			it->second.row /= 2;
+			it->second.column /= 2;
+		}
+		return digest;
+	}
+
+	bool SolveBoard(const Board &board, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+	{
+		//the board's search can't be cancelled once it's started
+		if(cancellation)
+		{
+			cancellation->Check();
+		}
+		statistics = SolveStatistics();
+		return Board::Solve(board, solution);
+	}
+
+	bool SolveBoard2(const Board2 &board, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+	{
+		return Board2::Solve(board, solution, statistics, cancellation);
+	}
+
+	bool SolveSparseBoard(const SparseBoard &board, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+	{
+		return SparseBoard::Solve(board, solution, statistics, cancellation);
+	}
+
+	bool SolveRanked(const Board2 &board, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+	{
+		//the ranked solver starts the solution from the given state
+		bool isSolved = RankedSolver::Solve(board, solution, statistics, cancellation);
+		solution.insert(solution.begin(), board.GetTiltsSequence().begin(), board.GetTiltsSequence().end());
+		return isSolved;
+	}
+
+	bool SolveBestFirst(const Board2 &board, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+	{
+		//the best-first solver starts the solution from the given state
+		bool isSolved = BestFirstSolver::Solve(board, solution, statistics, cancellation);
+		solution.insert(solution.begin(), board.GetTiltsSequence().begin(), board.GetTiltsSequence().end());
+		return isSolved;
+	}
+
+	bool SolveNogood(const Board2 &board, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+	{
+		//the nogood solver starts the solution from the given state
+		bool isSolved = NogoodSolver::Solve(board, solution, statistics, cancellation);
+		solution.insert(solution.begin(), board.GetTiltsSequence().begin(), board.GetTiltsSequence().end());
+		return isSolved;
+	}
+
+	bool SolveCompact(const Board2 &board, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+	{
+		//the compact solver starts the solution from the given state
+		bool isSolved = CompactSolver::Solve(board, solution, statistics, CompactSolver::DefaultChunkSize, cancellation);
+		solution.insert(solution.begin(), board.GetTiltsSequence().begin(), board.GetTiltsSequence().end());
+		return isSolved;
+	}
+
+	//The class BoardEngine adapts a board and a solver of it to the engine interface.
+	template <typename BoardType>
+	class BoardEngine : public Engine
+	{
+	public:
+		typedef bool (*SolveFunction)(const BoardType &board, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation);
+
+		BoardEngine(const std::string &name, SolveFunction solve, const PuzzleView &puzzle, PuzzleTrust trust)
+			:m_name(name)
+			,m_solve(solve)
+			,m_board(puzzle, trust)
+		{
+		}
+		virtual std::string GetName() const
+		{
+			return m_name;
+		}
+		virtual bool IsGameWon() const
+		{
+			return m_board.IsGameWon();
+		}
+		virtual bool IsGameLost() const
+		{
+			return m_board.IsGameLost();
+		}
+		virtual void Tilt(TiltDirection direction)
+		{
+			m_board.Tilt(direction);
+		}
+		virtual const std::vector<TiltDirection>& GetTiltsSequence() const
+		{
+			return m_board.GetTiltsSequence();
+		}
+		virtual BoardStateDigest GetStateDigest() const
+		{
+			return ExportStateDigest(m_board);
+		}
+		virtual bool Solve(std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation) const
+		{
+			solution.clear();
+			//the solvers give the whole tilts sequence of the won board
+			bool isSolved = m_solve(m_board, solution, statistics, cancellation);
+			solution.erase(solution.begin(), solution.begin() + std::min(solution.size(), m_board.GetTiltsSequence().size()));
+			return isSolved;
+		}
+
+	private:
+		std::string m_name;
+		SolveFunction m_solve;
+		BoardType m_board;
+	};
+
+	template <typename BoardType, bool (*solve)(const BoardType&, std::vector<TiltDirection>&, SolveStatistics&, const Cancellation*)>
+	std::unique_ptr<Engine> CreateBoardEngine(const char *name, const PuzzleView &puzzle, PuzzleTrust trust)
+	{
+		return std::unique_ptr<Engine>(new BoardEngine<BoardType>(name, solve, puzzle, trust));
+	}
+
+	const size_t MaxBoard2Size = 256;
+
+	bool IsAlwaysApplicable(const PuzzleView &/*puzzle*/, unsigned long long /*memoryLimit*/)
+	{
+		return true;
+	}
+
+	bool IsBoard2Applicable(const PuzzleView &puzzle, unsigned long long /*memoryLimit*/)
+	{
+		return puzzle.boardSize <= MaxBoard2Size;
+	}
+
+	bool IsRankedApplicable(const PuzzleView &puzzle, unsigned long long memoryLimit)
+	{
+		return puzzle.boardSize <= MaxBoard2Size && RankedSolver::IsApplicable(puzzle.boardSize, puzzle.ballsCount, memoryLimit);
+	}
+
+	bool IsNogoodApplicable(const PuzzleView &puzzle, unsigned long long /*memoryLimit*/)
+	{
+		return puzzle.boardSize <= MaxBoard2Size && NogoodSolver::IsApplicable(puzzle.boardSize, puzzle.ballsCount);
+	}
+
+	//the registry of the engines: a new engine is a new line here
+	struct EngineRegistration
+	{
+		const char *name;
+		std::unique_ptr<Engine> (*create)(const char *name, const PuzzleView &puzzle, PuzzleTrust trust);
+		bool (*isApplicable)(const PuzzleView &puzzle, unsigned long long memoryLimit);
+		EngineSolution solution;
+	};
+
+	const EngineRegistration g_engines[] = {
+		{"board", CreateBoardEngine<Board, SolveBoard>, IsAlwaysApplicable, Board2Solution},
+		{"board2", CreateBoardEngine<Board2, SolveBoard2>, IsBoard2Applicable, Board2Solution},
+		{"sparse", CreateBoardEngine<SparseBoard, SolveSparseBoard>, IsAlwaysApplicable, Board2Solution},
+		{"ranked", CreateBoardEngine<Board2, SolveRanked>, IsRankedApplicable, Board2Solution},
+		{"best_first", CreateBoardEngine<Board2, SolveBestFirst>, IsBoard2Applicable, WinningSolution},
+		{"nogood", CreateBoardEngine<Board2, SolveNogood>, IsNogoodApplicable, Board2Solution},
+		{"compact", CreateBoardEngine<Board2, SolveCompact>, IsBoard2Applicable, ShortestSolution}};
+	const size_t g_enginesCount = sizeof(g_engines) / sizeof(g_engines[0]);
+
+	const EngineRegistration& FindEngine(const std::string &name)
+	{
+		for(size_t i = 0; i < g_enginesCount; ++i)
+		{
+			if(name == g_engines[i].name)
+			{
+				return g_engines[i];
+			}
+		}
+		throw std::invalid_argument("unknown engine: " + name);
+	}
+}
+
+std::vector<std::string> GetEngineNames()
+{
+	std::vector<std::string> names;
+	for(size_t i = 0; i < g_enginesCount; ++i)
+	{
+		names.push_back(g_engines[i].name);
+	}
+	return names;
+}
+
+bool IsEngineApplicable(const std::string &name, const PuzzleView &puzzle, unsigned long long memoryLimit)
+{
+	return FindEngine(name).isApplicable(puzzle, memoryLimit);
+}
+
+EngineSolution GetEngineSolution(const std::string &name)
+{
+	return FindEngine(name).solution;
+}
+
+std::unique_ptr<Engine> CreateEngine(const std::string &name, const PuzzleView &puzzle, PuzzleTrust trust)
+{
+	const EngineRegistration &engine = FindEngine(name);
+	return engine.create(engine.name, puzzle, trust);
+}
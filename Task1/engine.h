@@ -0,0 +1,42 @@
+#pragma once
+
+#include "board.h"
+#include "solve_statistics.h"
+#include "cancellation.h"
+
+//The class Engine is the common interface of the boards and their solvers, so they can be chosen at run time.
+//The state is exported as the digest with the positions of the balls on the real board (rows' and columns' numbers start from zero),
+//whatever internal representation the engine has.
+class Engine
+{
+public:
+	virtual ~Engine();
+	virtual std::string GetName() const = 0;
+	virtual bool IsGameWon() const = 0;
+	virtual bool IsGameLost() const = 0;
+	//all below methods thow logic_error when game is lost
+	virtual void Tilt(TiltDirection direction) = 0;
+	virtual const std::vector<TiltDirection>& GetTiltsSequence() const = 0;
+	virtual BoardStateDigest GetStateDigest() const = 0;
+	//finds the solution from the current state (the tilts made before are not included) of the engine's kind (see GetEngineSolution);
+	//throws SolveCancelled when the cancellation (if any) is requested (the board engine checks it only before its search)
+	virtual bool Solve(std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation = 0) const = 0;
+};
+
+//the names of the registered engines
+std::vector<std::string> GetEngineNames();
+
+//Tells whether the engine can be used for the puzzle: the boards have the limits of their sizes,
+//the ranked solver needs its bitmap to fit the memory limit. Throws invalid_argument for an unknown name.
+bool IsEngineApplicable(const std::string &name, const PuzzleView &puzzle, unsigned long long memoryLimit);
+
+//The solutions the engines find: the one of Board2::Solve (the states are searched in the same order), another shortest one or just a winning one.
+enum EngineSolution {Board2Solution, ShortestSolution, WinningSolution};
+
+//Tells which solution the engine finds, only the engines of the shortest solutions are chosen by the calibration.
+//Throws invalid_argument for an unknown name.
+EngineSolution GetEngineSolution(const std::string &name);
+
+//Creates the engine for the puzzle. Throws invalid_argument for an unknown name
+//and the exceptions of the boards' constructors for the wrong puzzles (or too large for the engine).
+std::unique_ptr<Engine> CreateEngine(const std::string &name, const PuzzleView &puzzle, PuzzleTrust trust = UntrustedPuzzle);
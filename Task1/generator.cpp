@@ -0,0 +1,341 @@
+#include "stdafx.h"
+#include "generator.h"
+#include "board2.h"
+#include "reachable_index.h"
+
+GeneratorOptions::GeneratorOptions()
+	:boardSize(4)
+	,ballsCount(2)
+	,wallsCount(2)
+	,minSolutionLength(1)
+	,minStatesCount(0)
+	,isUnsolvable(false)
+	,puzzlesCount(1)
+	,climbingSteps(100)
+	,maxSamples(1000)
+	,threadsCount(0)
+	,seed(0)
+{
+}
+
+namespace
+{
+	typedef std::mt19937 Random;
+
+	//The class GeneratorWorker samples and improves the layouts on one thread.
+	class GeneratorWorker
+	{
+	public:
+		GeneratorWorker(const GeneratorOptions &options, unsigned int seed, boost::mutex &resultsMutex, std::vector<GeneratedPuzzle> &results, size_t &samplesLeft)
+			:m_options(options)
+			,m_random(seed)
+			,m_resultsMutex(resultsMutex)
+			,m_results(results)
+			,m_samplesLeft(samplesLeft)
+		{
+		}
+
+		void operator()()
+		{
+			while(TakeSample())
+			{
+				GeneratedPuzzle current;
+				current.puzzle = SampleLayout();
+				Evaluate(current);
+				for(size_t step = 0; step < m_options.climbingSteps; ++step)
+				{
+					GeneratedPuzzle candidate;
+					candidate.puzzle = current.puzzle;
+					Mutate(candidate.puzzle);
+					Evaluate(candidate);
+					if(Score(candidate) >= Score(current))
+					{
+						current = candidate;
+					}
+				}
+				if(IsTargetMet(current) && !AddResult(current))
+				{
+					return;
+				}
+			}
+		}
+
+	private:
+		static const size_t RandomAttempts = 16;
+
+		GeneratorWorker& operator=(const GeneratorWorker&);
+
+		bool TakeSample()
+		{
+			boost::lock_guard<boost::mutex> lock(m_resultsMutex);
+			if(!m_samplesLeft || m_results.size() >= m_options.puzzlesCount)
+			{
+				return false;
+			}
+			--m_samplesLeft;
+			return true;
+		}
+
+		//returns false when all the requested puzzles are generated
+		bool AddResult(const GeneratedPuzzle &puzzle)
+		{
+			boost::lock_guard<boost::mutex> lock(m_resultsMutex);
+			if(m_results.size() < m_options.puzzlesCount)
+			{
+				m_results.push_back(puzzle);
+			}
+			return m_results.size() < m_options.puzzlesCount;
+		}
+
+		size_t RandomNumber(size_t bound)
+		{
+			return std::uniform_int_distribution<size_t>(0, bound - 1)(m_random);
+		}
+
+		Position RandomPosition()
+		{
+			return Position(RandomNumber(m_options.boardSize), RandomNumber(m_options.boardSize));
+		}
+
+		std::pair<Position, Position> RandomWall()
+		{
+			Position first(RandomPosition());
+			Position second(first);
+			//take the border of the cell with its right or bottom neighbour
+			if(RandomNumber(2))
+			{
+				first.column = RandomNumber(m_options.boardSize - 1);
+				second.column = first.column + 1;
+			}
+			else
+			{
+				first.row = RandomNumber(m_options.boardSize - 1);
+				second.row = first.row + 1;
+			}
+			return std::make_pair(first, second);
+		}
+
+		bool IsOccupied(const Puzzle &puzzle, const Position &position) const
+		{
+			return puzzle.balls.end() != std::find(puzzle.balls.begin(), puzzle.balls.end(), position) ||
+				puzzle.holes.end() != std::find(puzzle.holes.begin(), puzzle.holes.end(), position);
+		}
+
+		bool HasWall(const Puzzle &puzzle, const std::pair<Position, Position> &wall) const
+		{
+			for(size_t i = 0; i < puzzle.walls.size(); ++i)
+			{
+				if((puzzle.walls[i].first == wall.first && puzzle.walls[i].second == wall.second) ||
+				   (puzzle.walls[i].first == wall.second && puzzle.walls[i].second == wall.first))
+				{
+					return true;
+				}
+			}
+			return false;
+		}
+
+		//a few random cells are tried first, then one of all the free cells is taken, so a nearly full board doesn't take long
+		//and a full one is reported instead of hanging
+		Position FreePosition(const Puzzle &puzzle)
+		{
+			for(size_t attempt = 0; attempt < RandomAttempts; ++attempt)
+			{
+				Position position(RandomPosition());
+				if(!IsOccupied(puzzle, position))
+				{
+					return position;
+				}
+			}
+			std::vector<Position> positions;
+			for(size_t row = 0; row < m_options.boardSize; ++row)
+			{
+				for(size_t column = 0; column < m_options.boardSize; ++column)
+				{
+					Position position(row, column);
+					if(!IsOccupied(puzzle, position))
+					{
+						positions.push_back(position);
+					}
+				}
+			}
+			if(positions.empty())
+			{
+				throw std::logic_error("no free cell for a ball or a hole");
+			}
+			return positions[RandomNumber(positions.size())];
+		}
+
+		std::pair<Position, Position> FreeWall(const Puzzle &puzzle)
+		{
+			for(size_t attempt = 0; attempt < RandomAttempts; ++attempt)
+			{
+				std::pair<Position, Position> wall(RandomWall());
+				if(!HasWall(puzzle, wall))
+				{
+					return wall;
+				}
+			}
+			std::vector<std::pair<Position, Position>> walls;
+			for(size_t row = 0; row < m_options.boardSize; ++row)
+			{
+				for(size_t column = 0; column < m_options.boardSize; ++column)
+				{
+					if(column + 1 < m_options.boardSize && !HasWall(puzzle, std::make_pair(Position(row, column), Position(row, column + 1))))
+					{
+						walls.push_back(std::make_pair(Position(row, column), Position(row, column + 1)));
+					}
+					if(row + 1 < m_options.boardSize && !HasWall(puzzle, std::make_pair(Position(row, column), Position(row + 1, column))))
+					{
+						walls.push_back(std::make_pair(Position(row, column), Position(row + 1, column)));
+					}
+				}
+			}
+			if(walls.empty())
+			{
+				throw std::logic_error("no free border for a wall");
+			}
+			return walls[RandomNumber(walls.size())];
+		}
+
+		Puzzle SampleLayout()
+		{
+			Puzzle puzzle;
+			puzzle.boardSize = m_options.boardSize;
+			for(size_t i = 0; i < m_options.ballsCount; ++i)
+			{
+				puzzle.balls.push_back(FreePosition(puzzle));
+			}
+			for(size_t i = 0; i < m_options.ballsCount; ++i)
+			{
+				puzzle.holes.push_back(FreePosition(puzzle));
+			}
+			for(size_t i = 0; i < m_options.wallsCount; ++i)
+			{
+				puzzle.walls.push_back(FreeWall(puzzle));
+			}
+			return puzzle;
+		}
+
+		//the moved object is taken off the board first, so its own place is free at least (the full board is not changed then)
+		void Mutate(Puzzle &puzzle)
+		{
+			size_t objectsCount = puzzle.balls.size() + puzzle.holes.size() + puzzle.walls.size();
+			if(!objectsCount)
+			{
+				return;
+			}
+			size_t objectNumber = RandomNumber(objectsCount);
+			if(objectNumber < puzzle.balls.size())
+			{
+				puzzle.balls.erase(puzzle.balls.begin() + objectNumber);
+				Position position(FreePosition(puzzle));
+				puzzle.balls.insert(puzzle.balls.begin() + objectNumber, position);
+				return;
+			}
+			objectNumber -= puzzle.balls.size();
+			if(objectNumber < puzzle.holes.size())
+			{
+				puzzle.holes.erase(puzzle.holes.begin() + objectNumber);
+				Position position(FreePosition(puzzle));
+				puzzle.holes.insert(puzzle.holes.begin() + objectNumber, position);
+				return;
+			}
+			objectNumber -= puzzle.holes.size();
+			puzzle.walls.erase(puzzle.walls.begin() + objectNumber);
+			std::pair<Position, Position> wall(FreeWall(puzzle));
+			puzzle.walls.insert(puzzle.walls.begin() + objectNumber, wall);
+		}
+
+		void Evaluate(GeneratedPuzzle &generated) const
+		{
+			const Puzzle &p = generated.puzzle;
+			//the generated layouts are valid by construction
+			Board2 b(PuzzleView(p), TrustedPuzzle);
+			std::vector<TiltDirection> solution;
+			SolveStatistics statistics;
+			boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+			generated.isSolvable = Board2::Solve(b, solution, statistics);
+			generated.solveSeconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+			generated.solutionLength = solution.size();
+			//the solve stops at the won state, so the states of the solvable puzzle are explored again to count all of them
+			//(the search of the unsolvable one has met all of them)
+			generated.statesCount = generated.isSolvable ? ReachableStateIndex(b).GetStatesCount() : statistics.statesMet;
+		}
+
+		//the climbing maximizes the optimal depth of the solvable puzzles (and the states count of the unsolvable ones)
+		std::pair<size_t, size_t> Score(const GeneratedPuzzle &generated) const
+		{
+			if(generated.isSolvable == m_options.isUnsolvable)
+			{
+				return std::make_pair(size_t(0), size_t(0));
+			}
+			return std::make_pair(generated.isSolvable ? generated.solutionLength : 1, generated.statesCount);
+		}
+
+		bool IsTargetMet(const GeneratedPuzzle &generated) const
+		{
+			if(generated.isSolvable == m_options.isUnsolvable)
+			{
+				return false;
+			}
+			return generated.statesCount >= m_options.minStatesCount && (!generated.isSolvable || generated.solutionLength >= m_options.minSolutionLength);
+		}
+
+		const GeneratorOptions &m_options;
+		Random m_random;
+		boost::mutex &m_resultsMutex;
+		std::vector<GeneratedPuzzle> &m_results;
+		size_t &m_samplesLeft;
+	};
+}
+
+std::vector<GeneratedPuzzle> GeneratePuzzles(const GeneratorOptions &options)
+{
+	if(options.boardSize < 2)
+	{
+		throw std::invalid_argument("boardSize should be at least 2");
+	}
+	if(2 * options.ballsCount > options.boardSize * options.boardSize)
+	{
+		throw std::invalid_argument("balls and holes don't fit the board");
+	}
+	if(options.wallsCount > 2 * options.boardSize * (options.boardSize - 1))
+	{
+		throw std::invalid_argument("walls don't fit the board");
+	}
+
+	size_t threadsCount = options.threadsCount ? options.threadsCount : std::max<size_t>(boost::thread::hardware_concurrency(), 1);
+	boost::mutex resultsMutex;
+	std::vector<GeneratedPuzzle> results;
+	size_t samplesLeft = options.maxSamples;
+	std::vector<GeneratorWorker> workers;
+	for(size_t i = 0; i < threadsCount; ++i)
+	{
+		workers.push_back(GeneratorWorker(options, options.seed + static_cast<unsigned int>(i), resultsMutex, results, samplesLeft));
+	}
+	boost::thread_group threads;
+	for(size_t i = 0; i < workers.size(); ++i)
+	{
+		threads.create_thread(std::ref(workers[i]));
+	}
+	threads.join_all();
+	return results;
+}
+
+void WriteCorpus(std::ostream &output, const std::vector<GeneratedPuzzle> &puzzles)
+{
+	for(std::vector<GeneratedPuzzle>::const_iterator it = puzzles.begin(); it != puzzles.end(); ++it)
+	{
+		output << FormatPuzzle(it->puzzle) << " # depth=";
+		if(it->isSolvable)
+		{
+			output << it->solutionLength;
+		}
+		else
+		{
+			output << "X";
+		}
+		output << " states=" << it->statesCount << " time_ms=" << it->solveSeconds * 1000 << "\n";
+	}
+	output.flush();
+}
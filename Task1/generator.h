@@ -0,0 +1,40 @@
+#pragma once
+
+#include "puzzle.h"
+
+//The struct GeneratorOptions sets the layouts to sample and the targets the kept puzzles should meet.
+struct GeneratorOptions
+{
+	size_t boardSize;
+	size_t ballsCount;
+	size_t wallsCount;
+	size_t minSolutionLength;	//solvable puzzles with a shorter optimal solution are not kept
+	size_t minStatesCount;	//puzzles with less reachable states are not kept
+	bool isUnsolvable;	//keep the unsolvable puzzles instead of the solvable ones
+	size_t puzzlesCount;	//number of the puzzles to generate
+	size_t climbingSteps;	//number of the mutations tried for each sampled layout
+	size_t maxSamples;	//the generation stops after this number of the sampled layouts even if not all the puzzles are found
+	size_t threadsCount;	//0 means the number of the hardware threads
+	unsigned int seed;
+
+	GeneratorOptions();
+};
+
+//The struct GeneratedPuzzle is a puzzle together with the results of its solving.
+struct GeneratedPuzzle
+{
+	Puzzle puzzle;
+	bool isSolvable;
+	size_t solutionLength;
+	size_t statesCount;	//the number of the reachable states which are not lost (the won one included)
+	double solveSeconds;	//the reference time of the solving with Board2::Solve
+};
+
+//Samples random layouts, improves each of them with hill climbing (one ball, hole or wall is moved at a time and the change is kept
+//if the puzzle doesn't become easier) and keeps the puzzles meeting the targets. Uses options.threadsCount threads.
+//The order of the generated puzzles depends on the threads' timing.
+std::vector<GeneratedPuzzle> GeneratePuzzles(const GeneratorOptions &options);
+
+//Writes the puzzles one per line in the input format followed by the metadata after '#'
+//(optimal depth or X for the unsolvable puzzles, reachable states count and the reference solve time).
+void WriteCorpus(std::ostream &output, const std::vector<GeneratedPuzzle> &puzzles);
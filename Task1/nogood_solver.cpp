@@ -0,0 +1,145 @@
+#include "stdafx.h"
+#include "nogood_solver.h"
+#include "compressed_states.h"
+#include "trace.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, South, East, North};
+	const size_t g_directionsCount = sizeof(g_directions) / sizeof(g_directions[0]);
+}
+
+bool NogoodSolver::IsApplicable(size_t boardSize, size_t ballsCount)
+{
+	return boardSize * boardSize <= SunkBall && DeadPatterns::IsApplicable(boardSize, ballsCount);
+}
+
+bool NogoodSolver::Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+{
+	TRACE_SCOPE("NogoodSolver::Solve");
+	statistics = SolveStatistics();
+	solution.clear();
+	if(originalBoard.IsGameLost())
+	{
+		return false;
+	}
+	if(originalBoard.IsGameWon())
+	{
+		return true;
+	}
+	if(!IsApplicable(originalBoard.GetBoardSize(), originalBoard.GetHolesCells().size()))
+	{
+		throw std::domain_error("the positions of the pairs of the balls don't fit the memory limit");
+	}
+	NogoodSolver solver(originalBoard);
+	return solver.Search(solution, statistics, cancellation);
+}
+
+NogoodSolver::NogoodSolver(const Board2 &originalBoard)
+	:m_board(originalBoard)
+	,m_generator(originalBoard)
+	,m_deadPatterns(originalBoard)
+	,m_stateSize()
+	,m_states()
+	,m_parents()
+	,m_moves()
+	,m_slots(1024)
+{
+	PackedState start;
+	m_board.GetPackedState(start);
+	m_stateSize = start.size();
+	Insert(start, NoParent, West);
+}
+
+bool NogoodSolver::Search(std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+{
+	PackedState state;
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	statistics.boardsQueued = 1;
+	for(size_t head = 0; head < m_parents.size(); ++head)
+	{
+		if(cancellation)
+		{
+			cancellation->Check();
+		}
+		state.assign(m_states.begin() + head * m_stateSize, m_states.begin() + (head + 1) * m_stateSize);
+		m_generator.Expand(state, successors);
+		for(size_t i = 0; i < g_directionsCount; ++i)
+		{
+			const SuccessorGenerator::Successor &successor = successors[g_directions[i]];
+			++statistics.boardsQueued;
+			if(SuccessorGenerator::Lost == successor.outcome)
+			{
+				continue;
+			}
+			if(SuccessorGenerator::Won == successor.outcome)
+			{
+				statistics.statesMet = m_parents.size();
+				RestoreSolution(head, solution);
+				solution.push_back(g_directions[i]);
+				return true;
+			}
+			Insert(successor.state, static_cast<unsigned int>(head), g_directions[i]);
+		}
+		statistics.maxQueueSize = std::max(statistics.maxQueueSize, m_parents.size() - head - 1);
+	}
+	statistics.statesMet = m_parents.size();
+	return false;
+}
+
+void NogoodSolver::Insert(const PackedState &state, unsigned int parent, TiltDirection move)
+{
+	size_t slot = FindSlot(state);
+	if(m_slots[slot] || m_deadPatterns.IsDead(state))
+	{
+		return;
+	}
+	if(m_parents.size() >= NoParent - 1)
+	{
+		throw std::domain_error("too many states for the search");
+	}
+	m_states.insert(m_states.end(), state.begin(), state.end());
+	m_parents.push_back(parent);
+	m_moves.push_back(static_cast<unsigned char>(move));
+	m_slots[slot] = static_cast<unsigned int>(m_parents.size());
+	if(m_parents.size() * 2 > m_slots.size())
+	{
+		Grow();
+	}
+}
+
+void NogoodSolver::Grow()
+{
+	TRACE_SCOPE("Grow");
+	m_slots.assign(m_slots.size() * 2, 0);
+	PackedState state;
+	for(size_t i = 0; i < m_parents.size(); ++i)
+	{
+		state.assign(m_states.begin() + i * m_stateSize, m_states.begin() + (i + 1) * m_stateSize);
+		m_slots[FindSlot(state)] = static_cast<unsigned int>(i + 1);
+	}
+}
+
+size_t NogoodSolver::FindSlot(const PackedState &state) const
+{
+	size_t mask = m_slots.size() - 1;
+	size_t i = static_cast<size_t>(StateFingerprints::Hash(state)) & mask;
+	for(; m_slots[i]; i = (i + 1) & mask)
+	{
+		if(std::equal(state.begin(), state.end(), m_states.begin() + (m_slots[i] - 1) * m_stateSize))
+		{
+			break;
+		}
+	}
+	return i;
+}
+
+void NogoodSolver::RestoreSolution(size_t number, std::vector<TiltDirection> &solution) const
+{
+	solution.clear();
+	for(; NoParent != m_parents[number]; number = m_parents[number])
+	{
+		solution.push_back(static_cast<TiltDirection>(m_moves[number]));
+	}
+	std::reverse(solution.begin(), solution.end());
+}
@@ -0,0 +1,43 @@
+#pragma once
+
+#include "board2.h"
+#include "successor_generator.h"
+#include "dead_patterns.h"
+
+//The class NogoodSolver is a breadth-first search which doesn't queue the states with a pair of the balls in a dead position
+//(see DeadPatterns), so the states which are lost for the same local reason are cut off once instead of being searched
+//with each combination of the other balls. The dead states can't be won, so the search finds the same solution as Board2::Solve
+//(the states are expanded in the same order) and meets fewer states on the puzzles with many of them, most of all on the unsolvable ones.
+//The met states are kept in a flat array in the order of the search with the parent number and the tilt of each one,
+//the hash set of their numbers finds the repeated ones.
+class NogoodSolver
+{
+public:
+	//tells whether the board can be solved and the positions of the pairs fit the memory limit of DeadPatterns
+	static bool IsApplicable(size_t boardSize, size_t ballsCount);
+	//the board should be applicable (domain_error is thrown otherwise), the solution is searched from its state
+	//throws SolveCancelled when the cancellation (if any) is requested
+	static bool Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation = 0);
+
+private:
+	static const unsigned int NoParent = 0xFFFFFFFF;
+
+	explicit NogoodSolver(const Board2 &originalBoard);
+
+	bool Search(std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation);
+	//appends the state if it is not met yet and not dead
+	void Insert(const PackedState &state, unsigned int parent, TiltDirection move);
+	void Grow();
+	//returns the slot of the state or the empty slot where it should be
+	size_t FindSlot(const PackedState &state) const;
+	void RestoreSolution(size_t number, std::vector<TiltDirection> &solution) const;
+
+	Board2 m_board;	//the board of the start state
+	SuccessorGenerator m_generator;	//makes the tilts of the states
+	DeadPatterns m_deadPatterns;
+	size_t m_stateSize;
+	std::vector<unsigned short> m_states;	//the met states one after another
+	std::vector<unsigned int> m_parents;
+	std::vector<unsigned char> m_moves;	//the tilt from the parent to each state
+	std::vector<unsigned int> m_slots;	//the hash set of the states: the state number + 1, zero is an empty slot
+};
@@ -0,0 +1,8 @@
+#pragma once
+
+//The PackedState is a compact equivalent of the BoardStateDigest: its i-th element is the linear number (row * boardSize + column)
+//of the cell of the i-th ball or SunkBall if the ball has been sunk. As the holes are sunk together with their balls,
+//the packed state together with the initial holes positions describes the board completely.
+typedef std::vector<unsigned short> PackedState;
+
+const unsigned short SunkBall = 0xFFFF;
@@ -0,0 +1,115 @@
+#include "stdafx.h"
+#include "portfolio_solver.h"
+#include "engine.h"
+#include "trace.h"
+
+namespace
+{
+	const size_t NoWinner = static_cast<size_t>(-1);
+}
+
+PortfolioSolver::PortfolioSolver(const std::vector<std::string> &engines, unsigned long long memoryLimit)
+	:m_engines(engines)
+	,m_memoryLimit(memoryLimit)
+	,m_winsMutex()
+	,m_wins(engines.size())
+{
+	if(engines.empty())
+	{
+		throw std::invalid_argument("the portfolio should have an engine");
+	}
+	std::vector<std::string> names(GetEngineNames());
+	for(size_t i = 0; i < engines.size(); ++i)
+	{
+		if(names.end() == std::find(names.begin(), names.end(), engines[i]))
+		{
+			throw std::invalid_argument("unknown engine: " + engines[i]);
+		}
+	}
+}
+
+bool PortfolioSolver::Solve(const Puzzle &puzzle, std::vector<TiltDirection> &solution, SolveStatistics &statistics)
+{
+	TRACE_SCOPE("PortfolioSolver::Solve");
+	//the puzzle is validated once, so the errors are the ones of the puzzle and the engines trust it
+	ValidatePuzzle(PuzzleView(puzzle));
+	Race race;
+	race.winner = NoWinner;
+	race.isSolved = false;
+	{
+		boost::thread_group threads;
+		for(size_t i = 0; i < m_engines.size(); ++i)
+		{
+			threads.create_thread(std::bind(&PortfolioSolver::Run, this, i, std::cref(puzzle), std::ref(race)));
+		}
+		threads.join_all();
+	}
+	if(race.error)
+	{
+		std::rethrow_exception(race.error);
+	}
+	if(NoWinner == race.winner)
+	{
+		throw std::domain_error("no engine of the portfolio can be used for the puzzle");
+	}
+	solution.swap(race.solution);
+	statistics = race.statistics;
+	statistics.winner = m_engines[race.winner];
+	boost::lock_guard<boost::mutex> lock(m_winsMutex);
+	++m_wins[race.winner];
+	for(size_t i = 0; i < m_engines.size(); ++i)
+	{
+		statistics.engineWins[m_engines[i]] += m_wins[i];
+	}
+	return race.isSolved;
+}
+
+const std::vector<std::string>& PortfolioSolver::GetEngines() const
+{
+	return m_engines;
+}
+
+void PortfolioSolver::Run(size_t engine, const Puzzle &puzzle, Race &race) const
+{
+	TRACE_SCOPE("PortfolioSolver::Run");
+	std::vector<TiltDirection> solution;
+	SolveStatistics statistics;
+	bool isSolved = false;
+	try
+	{
+		if(!IsEngineApplicable(m_engines[engine], PuzzleView(puzzle), m_memoryLimit))
+		{
+			return;
+		}
+		isSolved = CreateEngine(m_engines[engine], PuzzleView(puzzle), TrustedPuzzle)->Solve(solution, statistics, &race.cancellation);
+	}
+	catch(const SolveCancelled&)
+	{
+		return;
+	}
+	catch(const std::domain_error&)
+	{
+		//the engine can't be used for the puzzle
+		return;
+	}
+	catch(...)
+	{
+		//the error is thrown by Solve, the other engines are stopped
+		boost::lock_guard<boost::mutex> lock(race.mutex);
+		if(!race.error)
+		{
+			race.error = std::current_exception();
+		}
+		race.cancellation.Cancel();
+		return;
+	}
+	boost::lock_guard<boost::mutex> lock(race.mutex);
+	if(NoWinner == race.winner)
+	{
+		race.winner = engine;
+		race.isSolved = isSolved;
+		race.solution.swap(solution);
+		race.statistics = statistics;
+		race.cancellation.Cancel();
+	}
+}
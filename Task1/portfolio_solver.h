@@ -0,0 +1,46 @@
+#pragma once
+
+#include "puzzle.h"
+#include "solve_statistics.h"
+#include "cancellation.h"
+#include "ranked_solver.h"
+
+//The class PortfolioSolver races several registered engines (see CreateEngine) on the same puzzle, each in its own thread.
+//The first engine to give a proven answer (a winning solution or the search over all the reachable states) wins
+//and the others are cancelled, so the time of a solve is the time of the engine which is the best for the puzzle.
+//An engine which can't be used for the puzzle (not IsEngineApplicable with the memory limit or domain_error) just doesn't take part in the race,
+//any other error of an engine stops the race and is thrown by Solve.
+//The number of the wins of each engine is counted over all the puzzles the portfolio has solved and given in the statistics.
+class PortfolioSolver
+{
+public:
+	//throws invalid_argument for an unknown engine name or for no engines
+	explicit PortfolioSolver(const std::vector<std::string> &engines, unsigned long long memoryLimit = RankedSolver::DefaultMemoryLimit);
+	//the puzzle is validated as the boards do it; domain_error is thrown if no engine can be used for the puzzle,
+	//the statistics are the winner's ones with its name and the wins of all the engines
+	bool Solve(const Puzzle &puzzle, std::vector<TiltDirection> &solution, SolveStatistics &statistics);
+	const std::vector<std::string>& GetEngines() const;
+
+private:
+	//the state of the race for one puzzle shared by the engines' threads
+	struct Race
+	{
+		boost::mutex mutex;
+		Cancellation cancellation;
+		size_t winner;
+		bool isSolved;
+		std::vector<TiltDirection> solution;
+		SolveStatistics statistics;
+		std::exception_ptr error;	//the first error of an engine which is not a cancellation or an inapplicable engine
+	};
+
+	PortfolioSolver(const PortfolioSolver&);
+	PortfolioSolver& operator=(const PortfolioSolver&);
+
+	void Run(size_t engine, const Puzzle &puzzle, Race &race) const;
+
+	std::vector<std::string> m_engines;
+	unsigned long long m_memoryLimit;
+	boost::mutex m_winsMutex;
+	std::vector<size_t> m_wins;
+};
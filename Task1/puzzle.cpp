@@ -0,0 +1,130 @@
+#include "stdafx.h"
+#include "puzzle.h"
+#include "trace.h"
+
+Puzzle::Puzzle()
+	:boardSize()
+	,balls()
+	,holes()
+	,walls()
+{
+}
+
+Puzzle ParsePuzzle(const std::string &inputData)
+{
+	TRACE_SCOPE("ParsePuzzle");
+	Puzzle puzzle;
+	//Note: in the input we recieve positions starting from (1,1), so we fix them
+	std::stringstream ss(inputData);
+	size_t readNumber;
+	ss >> readNumber;
+	puzzle.boardSize = readNumber;
+	ss >> readNumber;
+	puzzle.balls.resize(readNumber);
+	puzzle.holes.resize(readNumber);
+	ss >> readNumber;
+	puzzle.walls.resize(readNumber);
+	if(!ss)
+	{
+		throw std::invalid_argument("the puzzle header should contain three numbers");
+	}
+	for(size_t i = 0; i < puzzle.balls.size(); ++i)
+	{
+		ss >> readNumber;
+		puzzle.balls[i].column = readNumber - 1;
+		ss >> readNumber;
+		puzzle.balls[i].row = readNumber - 1;
+	}
+	for(size_t i = 0; i < puzzle.holes.size(); ++i)
+	{
+		ss >> readNumber;
+		puzzle.holes[i].column = readNumber - 1;
+		ss >> readNumber;
+		puzzle.holes[i].row = readNumber - 1;
+	}
+	for(size_t i = 0; i < puzzle.walls.size(); ++i)
+	{
+		ss >> readNumber;
+		puzzle.walls[i].first.column = readNumber - 1;
+		ss >> readNumber;
+		puzzle.walls[i].first.row = readNumber - 1;
+		ss >> readNumber;
+		puzzle.walls[i].second.column = readNumber - 1;
+		ss >> readNumber;
+		puzzle.walls[i].second.row = readNumber - 1;
+	}
+	if(!ss)
+	{
+		throw std::invalid_argument("the puzzle data is truncated or malformed");
+	}
+	return puzzle;
+}
+
+std::string FormatPuzzle(const Puzzle &puzzle)
+{
+	std::ostringstream ss;
+	ss << puzzle.boardSize << " " << puzzle.balls.size() << " " << puzzle.walls.size();
+	for(size_t i = 0; i < puzzle.balls.size(); ++i)
+	{
+		ss << " " << puzzle.balls[i].column + 1 << " " << puzzle.balls[i].row + 1;
+	}
+	for(size_t i = 0; i < puzzle.holes.size(); ++i)
+	{
+		ss << " " << puzzle.holes[i].column + 1 << " " << puzzle.holes[i].row + 1;
+	}
+	for(size_t i = 0; i < puzzle.walls.size(); ++i)
+	{
+		ss << " " << puzzle.walls[i].first.column + 1 << " " << puzzle.walls[i].first.row + 1;
+		ss << " " << puzzle.walls[i].second.column + 1 << " " << puzzle.walls[i].second.row + 1;
+	}
+	return ss.str();
+}
+
+std::vector<TiltDirection> ParseSolution(const std::string &solutionData)
+{
+	std::vector<TiltDirection> solution;
+	solution.reserve(solutionData.size());
+	for(std::string::const_iterator it = solutionData.begin(); it != solutionData.end(); ++it)
+	{
+		switch(*it)
+		{
+			case 'W':
+				solution.push_back(West);
+				break;
+			case 'E':
+				solution.push_back(East);
+				break;
+			case 'N':
+				solution.push_back(North);
+				break;
+			case 'S':
+				solution.push_back(South);
+				break;
+			case 'X':
+			case ' ':
+			case '\t':
+			case '\r':
+				break;
+			default:
+				throw std::invalid_argument("unexpected character in the solution");
+		}
+	}
+	return solution;
+}
+
+char DirectionToLetter(TiltDirection direction)
+{
+	switch(direction)
+	{
+		case West:
+			return 'W';
+		case East:
+			return 'E';
+		case North:
+			return 'N';
+		case South:
+			return 'S';
+		default:
+			throw std::logic_error("Unexpected direction value.");
+	}
+}
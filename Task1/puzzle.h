@@ -0,0 +1,29 @@
+#pragma once
+
+#include "board.h"
+
+//The struct Puzzle holds the game parameters as they are read from the input data.
+//Positions are already fixed to start from zero, so the fields can be passed to the boards' constructors as is.
+struct Puzzle
+{
+	size_t boardSize;
+	std::vector<Position> balls;
+	std::vector<Position> holes;
+	std::vector<std::pair<Position, Position>> walls;
+
+	Puzzle();
+};
+
+//Parses the puzzle from the line in the input format (n m k, m balls, m holes, k walls; positions start from (1,1)).
+//Throws invalid_argument when the line is truncated or contains not a number.
+Puzzle ParsePuzzle(const std::string &inputData);
+
+//Formats the puzzle to the line in the input format (the reverse of ParsePuzzle).
+std::string FormatPuzzle(const Puzzle &puzzle);
+
+//Parses the solution printed by the application (letters W, E, N, S optionally separated by spaces).
+//"X" (no solution) is parsed as an empty sequence. Throws invalid_argument on an unexpected character.
+std::vector<TiltDirection> ParseSolution(const std::string &solutionData);
+
+//Returns the letter the application uses to print the direction. Throws logic_error on an unexpected value.
+char DirectionToLetter(TiltDirection direction);
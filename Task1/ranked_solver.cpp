@@ -0,0 +1,239 @@
+#include "stdafx.h"
+#include "ranked_solver.h"
+#include "trace.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, South, East, North};
+	const size_t g_directionsCount = sizeof(g_directions) / sizeof(g_directions[0]);
+	const unsigned long long g_noBitmap = std::numeric_limits<unsigned long long>::max();
+}
+
+unsigned long long RankedSolver::GetBitmapBytes(size_t boardSize, size_t ballsCount)
+{
+	unsigned long long radix = static_cast<unsigned long long>(boardSize) * boardSize + 1;
+	//the number of the ranks is radix ^ balls
+	unsigned long long ranksCount = 1;
+	for(size_t i = 0; i < ballsCount; ++i)
+	{
+		if(ranksCount > g_noBitmap / radix)
+		{
+			return g_noBitmap;
+		}
+		ranksCount *= radix;
+	}
+	return ranksCount / 8 + 1;
+}
+
+bool RankedSolver::IsApplicable(size_t boardSize, size_t ballsCount, unsigned long long memoryLimit)
+{
+	if(static_cast<unsigned long long>(boardSize) * boardSize > SunkBall)
+	{
+		return false;
+	}
+	return GetBitmapBytes(boardSize, ballsCount) <= memoryLimit;
+}
+
+bool RankedSolver::Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+{
+	TRACE_SCOPE("RankedSolver::Solve");
+	statistics = SolveStatistics();
+	solution.clear();
+	if(originalBoard.IsGameLost())
+	{
+		return false;
+	}
+	if(originalBoard.IsGameWon())
+	{
+		return true;
+	}
+	PackedState start;
+	originalBoard.GetPackedState(start);
+	if(GetBitmapBytes(originalBoard.GetBoardSize(), start.size()) == g_noBitmap)
+	{
+		throw std::domain_error("the ranks of the board states don't fit 64 bits");
+	}
+	RankedSolver solver(originalBoard);
+	return solver.Search(solution, statistics, cancellation);
+}
+
+RankedSolver::RankedSolver(const Board2 &originalBoard)
+	:m_board(originalBoard)
+	,m_stateSize()
+	,m_isBatched()
+	,m_batch()
+	,m_tiltedBatch()
+	,m_children()
+	,m_generator(originalBoard)
+	,m_successors(StateBatch::Lanes * SuccessorGenerator::DirectionsCount)
+	,m_radix(static_cast<unsigned long long>(originalBoard.GetBoardSize()) * originalBoard.GetBoardSize() + 1)
+	,m_visited()
+	,m_ranks()
+	,m_layerStarts()
+{
+	PackedState start;
+	m_board.GetPackedState(start);
+	m_stateSize = start.size();
+	m_isBatched = originalBoard.GetBoardSize() * originalBoard.GetBoardSize() < BatchMaxCellsPerBall * m_stateSize;
+	if(m_isBatched)
+	{
+		m_batch.reset(new StateBatch(originalBoard));
+		m_tiltedBatch.reset(new StateBatch(originalBoard));
+	}
+	m_visited.resize(static_cast<size_t>(GetBitmapBytes(originalBoard.GetBoardSize(), m_stateSize) / sizeof(unsigned long long) + 1));
+	unsigned long long startRank = Rank(start);
+	Visit(startRank);
+	m_ranks.push_back(startRank);
+	m_layerStarts.push_back(0);
+}
+
+bool RankedSolver::Search(std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+{
+	statistics.boardsQueued = 1;
+	for(size_t layer = 0; m_layerStarts[layer] != m_ranks.size(); ++layer)
+	{
+		TRACE_SCOPE("Layer");
+		size_t layerEnd = m_ranks.size();
+		m_layerStarts.push_back(layerEnd);
+		statistics.maxQueueSize = std::max(statistics.maxQueueSize, layerEnd - m_layerStarts[layer]);
+		for(size_t first = m_layerStarts[layer]; first != layerEnd; )
+		{
+			if(cancellation)
+			{
+				cancellation->Check();
+			}
+			size_t last = first + std::min(StateBatch::Lanes, layerEnd - first);
+			Expand(first, last);
+			//the children are visited in the order of the scalar search
+			for(size_t i = first; i != last; ++i)
+			{
+				const SuccessorGenerator::Successor *successors = &m_successors[(i - first) * SuccessorGenerator::DirectionsCount];
+				for(size_t j = 0; j < g_directionsCount; ++j)
+				{
+					const SuccessorGenerator::Successor &successor = successors[g_directions[j]];
+					++statistics.boardsQueued;
+					if(SuccessorGenerator::Lost == successor.outcome)
+					{
+						continue;
+					}
+					if(SuccessorGenerator::Won == successor.outcome)
+					{
+						statistics.statesMet = m_ranks.size();
+						RestoreSolution(layer, m_ranks[i], solution);
+						solution.push_back(g_directions[j]);
+						return true;
+					}
+					unsigned long long rank = Rank(successor.state);
+					if(Visit(rank))
+					{
+						m_ranks.push_back(rank);
+					}
+				}
+			}
+			first = last;
+		}
+	}
+	statistics.statesMet = m_ranks.size();
+	return false;
+}
+
+void RankedSolver::Expand(size_t first, size_t last)
+{
+	PackedState state;
+	if(!m_isBatched)
+	{
+		for(size_t i = first; i != last; ++i)
+		{
+			Unrank(m_ranks[i], state);
+			m_generator.Expand(state, &m_successors[(i - first) * SuccessorGenerator::DirectionsCount]);
+		}
+		return;
+	}
+	m_batch->Clear();
+	for(size_t i = first; i != last; ++i)
+	{
+		Unrank(m_ranks[i], state);
+		m_batch->SetState(i - first, state);
+	}
+	for(size_t j = 0; j < g_directionsCount; ++j)
+	{
+		*m_tiltedBatch = *m_batch;
+		m_tiltedBatch->Tilt(g_directions[j]);
+		m_tiltedBatch->GetStates(m_children);
+		unsigned int lostMask = m_tiltedBatch->GetLostMask();
+		unsigned int wonMask = m_tiltedBatch->GetWonMask();
+		for(size_t i = 0; i != last - first; ++i)
+		{
+			SuccessorGenerator::Successor &successor = m_successors[i * SuccessorGenerator::DirectionsCount + g_directions[j]];
+			successor.outcome = (lostMask >> i) & 1 ? SuccessorGenerator::Lost : ((wonMask >> i) & 1 ? SuccessorGenerator::Won : SuccessorGenerator::Moved);
+			successor.state.swap(m_children[i]);
+		}
+	}
+}
+
+unsigned long long RankedSolver::Rank(const PackedState &state) const
+{
+	//the sunk balls are the digit radix - 1
+	unsigned long long rank = 0;
+	for(size_t i = state.size(); i > 0; --i)
+	{
+		rank = rank * m_radix + (SunkBall == state[i - 1] ? m_radix - 1 : state[i - 1]);
+	}
+	return rank;
+}
+
+void RankedSolver::Unrank(unsigned long long rank, PackedState &state) const
+{
+	state.resize(m_stateSize);
+	for(size_t i = 0; i < m_stateSize; ++i)
+	{
+		unsigned long long digit = rank % m_radix;
+		state[i] = m_radix - 1 == digit ? SunkBall : static_cast<unsigned short>(digit);
+		rank /= m_radix;
+	}
+}
+
+bool RankedSolver::Visit(unsigned long long rank)
+{
+	unsigned long long &word = m_visited[static_cast<size_t>(rank / 64)];
+	unsigned long long bit = 1ULL << (rank % 64);
+	if(word & bit)
+	{
+		return false;
+	}
+	word |= bit;
+	return true;
+}
+
+void RankedSolver::RestoreSolution(size_t layer, unsigned long long rank, std::vector<TiltDirection> &solution)
+{
+	TRACE_SCOPE("RestoreSolution");
+	solution.clear();
+	unsigned long long target = rank;
+	PackedState parent;
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	for(; layer > 0; --layer)
+	{
+		bool isFound = false;
+		for(size_t i = m_layerStarts[layer - 1]; i != m_layerStarts[layer] && !isFound; ++i)
+		{
+			Unrank(m_ranks[i], parent);
+			m_generator.Expand(parent, successors);
+			for(size_t j = 0; j < g_directionsCount && !isFound; ++j)
+			{
+				const SuccessorGenerator::Successor &successor = successors[g_directions[j]];
+				if(SuccessorGenerator::Moved == successor.outcome && Rank(successor.state) == target)
+				{
+					solution.push_back(g_directions[j]);
+					target = m_ranks[i];
+					isFound = true;
+				}
+			}
+		}
+		if(!isFound)
+		{
+			throw std::logic_error("the state has no parent in the previous layer");
+		}
+	}
+	std::reverse(solution.begin(), solution.end());
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include "board2.h"
+#include "state_batch.h"
+#include "successor_generator.h"
+
+//The class RankedSolver is a breadth-first search for the small state spaces (a few balls on a small board).
+//Each state is ranked to a number with the mixed radix of boardSize * boardSize + 1 (a cell of each ball or sunk),
+//so all the possible states are numbered without gaps and collisions and the visited states are a flat bitmap of the ranks.
+//The queue is the array of the ranks of the met states in the order of the search (with the starts of the layers),
+//so there are no hashes and no pointers per state; the solution is restored backwards through the previous layers.
+//The states of a layer are tilted by StateBatch on the dense boards (where its passes through the cells are cheaper than sorting the balls)
+//and by SuccessorGenerator on the others, but expanded in the same order as Board2::Solve does, so the same solution is found.
+class RankedSolver
+{
+public:
+	static const size_t DefaultMemoryLimit = 256 << 20;
+
+	//returns the size of the visited bitmap for the boards or the largest number if the ranks don't fit 64 bits
+	static unsigned long long GetBitmapBytes(size_t boardSize, size_t ballsCount);
+	//tells whether the boards can be solved and their visited bitmap fits the memory limit
+	static bool IsApplicable(size_t boardSize, size_t ballsCount, unsigned long long memoryLimit = DefaultMemoryLimit);
+	//the board should have no more than SunkBall cells and the ranks should fit 64 bits (domain_error is thrown otherwise)
+	//throws SolveCancelled when the cancellation (if any) is requested
+	static bool Solve(const Board2 &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation = 0);
+
+private:
+	explicit RankedSolver(const Board2 &originalBoard);
+
+	bool Search(std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation);
+	unsigned long long Rank(const PackedState &state) const;
+	void Unrank(unsigned long long rank, PackedState &state) const;
+	//fills the successors of the states of the ranks [first, last), DirectionsCount successors of each state
+	void Expand(size_t first, size_t last);
+	//marks the rank visited, returns false if it has been visited already
+	bool Visit(unsigned long long rank);
+	//restores the tilts which move the start to the state of the layer
+	void RestoreSolution(size_t layer, unsigned long long rank, std::vector<TiltDirection> &solution);
+
+	//the boards with fewer cells per ball than this are dense enough for the batches
+	static const size_t BatchMaxCellsPerBall = 5;
+
+	Board2 m_board;	//the board used to make the tilts of the states
+	size_t m_stateSize;
+	bool m_isBatched;
+	std::unique_ptr<StateBatch> m_batch;	//the batches are made only for the dense boards
+	std::unique_ptr<StateBatch> m_tiltedBatch;
+	std::vector<PackedState> m_children;	//the states of the tilted batch
+	SuccessorGenerator m_generator;
+	std::vector<SuccessorGenerator::Successor> m_successors;
+	unsigned long long m_radix;
+	std::vector<unsigned long long> m_visited;	//the bit of each rank
+	std::vector<unsigned long long> m_ranks;	//the met states in the order of the search
+	std::vector<size_t> m_layerStarts;	//the index in the ranks of the first state of each layer
+};
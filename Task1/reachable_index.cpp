@@ -0,0 +1,272 @@
+#include "stdafx.h"
+#include "reachable_index.h"
+#include "compressed_states.h"
+#include "trace.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, South, East, North};
+	const size_t g_directionsCount = sizeof(g_directions) / sizeof(g_directions[0]);
+	const char g_fileMagic[] = "TILTIDX1";
+
+	//returns the slot of the state or the empty slot where it should be (the slots are the state numbers + 1, zero is an empty slot)
+	size_t FindSlot(const std::vector<unsigned int> &slots, const std::vector<unsigned short> &states, const PackedState &state)
+	{
+		size_t mask = slots.size() - 1;
+		size_t i = static_cast<size_t>(StateFingerprints::Hash(state)) & mask;
+		for(; slots[i]; i = (i + 1) & mask)
+		{
+			if(std::equal(state.begin(), state.end(), states.begin() + (slots[i] - 1) * state.size()))
+			{
+				break;
+			}
+		}
+		return i;
+	}
+}
+
+ReachableStateIndex::ReachableStateIndex(const Board2 &start, const Cancellation *cancellation)
+	:m_boardSize(start.GetBoardSize())
+	,m_ballsCount(start.GetHolesCells().size())
+	,m_stateBytes(m_ballsCount * sizeof(unsigned short))
+	,m_recordSize(m_stateBytes + 2 * sizeof(unsigned int) + 1)
+	,m_recordsCount(0)
+	,m_builtRecords()
+	,m_region()
+	,m_records(0)
+{
+	TRACE_SCOPE("ReachableStateIndex::Explore");
+	PackedState state;
+	start.GetPackedState(state);
+	SuccessorGenerator generator(start);
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	const PackedState wonState(m_ballsCount, SunkBall);
+	//the states in the order of the breadth-first search (a state after another one) with their parents, depths and tilts
+	std::vector<unsigned short> states(state);
+	std::vector<unsigned int> parents(1, NoParent);
+	std::vector<unsigned int> depths(1, 0);
+	std::vector<unsigned char> moves(1, 0);
+	std::vector<unsigned int> slots(1024);
+	slots[FindSlot(slots, states, state)] = 1;
+	for(size_t head = 0; head < parents.size(); ++head)
+	{
+		if(cancellation)
+		{
+			cancellation->Check();
+		}
+		state.assign(states.begin() + head * m_ballsCount, states.begin() + (head + 1) * m_ballsCount);
+		//the won state has no tilts
+		if(state == wonState)
+		{
+			continue;
+		}
+		generator.Expand(state, successors);
+		for(size_t i = 0; i < g_directionsCount; ++i)
+		{
+			const SuccessorGenerator::Successor &successor = successors[g_directions[i]];
+			if(SuccessorGenerator::Lost == successor.outcome)
+			{
+				continue;
+			}
+			const PackedState &child = SuccessorGenerator::Won == successor.outcome ? wonState : successor.state;
+			size_t slot = FindSlot(slots, states, child);
+			if(slots[slot])
+			{
+				continue;
+			}
+			if(parents.size() >= NoParent - 1)
+			{
+				throw std::domain_error("too many states for the reachable state index");
+			}
+			states.insert(states.end(), child.begin(), child.end());
+			parents.push_back(static_cast<unsigned int>(head));
+			depths.push_back(depths[head] + 1);
+			moves.push_back(static_cast<unsigned char>(g_directions[i]));
+			slots[slot] = static_cast<unsigned int>(parents.size());
+			if(parents.size() * 2 > slots.size())
+			{
+				TRACE_SCOPE("Grow");
+				slots.assign(slots.size() * 2, 0);
+				PackedState met;
+				for(size_t j = 0; j < parents.size(); ++j)
+				{
+					met.assign(states.begin() + j * m_ballsCount, states.begin() + (j + 1) * m_ballsCount);
+					slots[FindSlot(slots, states, met)] = static_cast<unsigned int>(j + 1);
+				}
+			}
+		}
+	}
+
+	//sort the records by their states and renumber the parents
+	TRACE_SCOPE("Sort");
+	m_recordsCount = parents.size();
+	std::vector<unsigned int> order(m_recordsCount);
+	for(size_t i = 0; i < m_recordsCount; ++i)
+	{
+		order[i] = static_cast<unsigned int>(i);
+	}
+	const unsigned char *stateBytes = reinterpret_cast<const unsigned char*>(states.data());
+	size_t bytes = m_stateBytes;
+	std::sort(order.begin(), order.end(), [stateBytes, bytes](unsigned int left, unsigned int right) {
+		return std::memcmp(stateBytes + left * bytes, stateBytes + right * bytes, bytes) < 0;
+	});
+	std::vector<unsigned int> ranks(m_recordsCount);
+	for(size_t i = 0; i < m_recordsCount; ++i)
+	{
+		ranks[order[i]] = static_cast<unsigned int>(i);
+	}
+	m_builtRecords.resize(m_recordsCount * m_recordSize);
+	for(size_t i = 0; i < m_recordsCount; ++i)
+	{
+		unsigned char *record = &m_builtRecords[i * m_recordSize];
+		unsigned int parent = NoParent == parents[order[i]] ? NoParent : ranks[parents[order[i]]];
+		std::memcpy(record, stateBytes + order[i] * m_stateBytes, m_stateBytes);
+		std::memcpy(record + m_stateBytes, &parent, sizeof(parent));
+		std::memcpy(record + m_stateBytes + sizeof(parent), &depths[order[i]], sizeof(unsigned int));
+		record[m_recordSize - 1] = moves[order[i]];
+	}
+	m_records = m_builtRecords.data();
+}
+
+ReachableStateIndex::ReachableStateIndex(const std::string &fileName)
+	:m_boardSize(0)
+	,m_ballsCount(0)
+	,m_stateBytes(0)
+	,m_recordSize(0)
+	,m_recordsCount(0)
+	,m_builtRecords()
+	,m_region()
+	,m_records(0)
+{
+	TRACE_SCOPE("ReachableStateIndex::Map");
+	if(!boost::filesystem::exists(fileName) || boost::filesystem::file_size(fileName) < sizeof(FileHeader))
+	{
+		throw std::invalid_argument("the reachable state index is missing or damaged: " + fileName);
+	}
+	namespace bi = boost::interprocess;
+	bi::file_mapping mapping(fileName.c_str(), bi::read_only);
+	m_region.reset(new bi::mapped_region(mapping, bi::read_only));
+	const unsigned char *data = static_cast<const unsigned char*>(m_region->get_address());
+	FileHeader header;
+	std::memcpy(&header, data, sizeof(header));
+	m_boardSize = static_cast<size_t>(header.boardSize);
+	m_ballsCount = static_cast<size_t>(header.ballsCount);
+	m_stateBytes = m_ballsCount * sizeof(unsigned short);
+	m_recordSize = m_stateBytes + 2 * sizeof(unsigned int) + 1;
+	m_recordsCount = static_cast<size_t>(header.recordsCount);
+	if(0 != std::memcmp(header.magic, g_fileMagic, sizeof(header.magic)) || m_boardSize * m_boardSize > SunkBall || !m_recordsCount
+		|| m_recordsCount >= NoParent || m_region->get_size() != sizeof(FileHeader) + m_recordsCount * m_recordSize)
+	{
+		throw std::invalid_argument("the reachable state index is missing or damaged: " + fileName);
+	}
+	m_records = data + sizeof(FileHeader);
+}
+
+void ReachableStateIndex::Save(const std::string &fileName) const
+{
+	TRACE_SCOPE("ReachableStateIndex::Save");
+	FileHeader header;
+	std::memcpy(header.magic, g_fileMagic, sizeof(header.magic));
+	header.boardSize = m_boardSize;
+	header.ballsCount = m_ballsCount;
+	header.recordsCount = m_recordsCount;
+	std::ofstream file(fileName.c_str(), std::ios::binary | std::ios::trunc);
+	file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+	file.write(reinterpret_cast<const char*>(m_records), m_recordsCount * m_recordSize);
+	file.close();
+	if(!file)
+	{
+		throw std::runtime_error("the reachable state index can't be written: " + fileName);
+	}
+}
+
+size_t ReachableStateIndex::GetBoardSize() const
+{
+	return m_boardSize;
+}
+
+size_t ReachableStateIndex::GetStatesCount() const
+{
+	return m_recordsCount;
+}
+
+bool ReachableStateIndex::IsReachable(const BoardStateDigest &target) const
+{
+	return NotReachable != Find(target);
+}
+
+size_t ReachableStateIndex::GetDistance(const BoardStateDigest &target) const
+{
+	size_t number = Find(target);
+	return NotReachable == number ? NotReachable : GetDepth(number);
+}
+
+bool ReachableStateIndex::GetPath(const BoardStateDigest &target, std::vector<TiltDirection> &path) const
+{
+	path.clear();
+	size_t number = Find(target);
+	if(NotReachable == number)
+	{
+		return false;
+	}
+	path.resize(GetDepth(number));
+	for(size_t i = path.size(); i > 0; --i)
+	{
+		path[i - 1] = static_cast<TiltDirection>(GetRecord(number)[m_recordSize - 1]);
+		number = GetParent(number);
+	}
+	return true;
+}
+
+size_t ReachableStateIndex::Find(const BoardStateDigest &target) const
+{
+	PackedState state(m_ballsCount, SunkBall);
+	for(BoardStateDigest::const_iterator it = target.begin(); it != target.end(); ++it)
+	{
+		if(it->first >= m_ballsCount || it->second.row >= m_boardSize || it->second.column >= m_boardSize)
+		{
+			throw std::invalid_argument("the target state doesn't fit the board of the index");
+		}
+		state[it->first] = static_cast<unsigned short>(it->second.row * m_boardSize + it->second.column);
+	}
+	const unsigned char *stateBytes = reinterpret_cast<const unsigned char*>(state.data());
+	size_t first = 0;
+	size_t last = m_recordsCount;
+	while(first < last)
+	{
+		size_t middle = first + (last - first) / 2;
+		int order = std::memcmp(GetRecord(middle), stateBytes, m_stateBytes);
+		if(!order)
+		{
+			return middle;
+		}
+		if(order < 0)
+		{
+			first = middle + 1;
+		}
+		else
+		{
+			last = middle;
+		}
+	}
+	return NotReachable;
+}
+
+const unsigned char* ReachableStateIndex::GetRecord(size_t number) const
+{
+	return m_records + number * m_recordSize;
+}
+
+unsigned int ReachableStateIndex::GetParent(size_t number) const
+{
+	unsigned int parent;
+	std::memcpy(&parent, GetRecord(number) + m_stateBytes, sizeof(parent));
+	return parent;
+}
+
+unsigned int ReachableStateIndex::GetDepth(size_t number) const
+{
+	unsigned int depth;
+	std::memcpy(&depth, GetRecord(number) + m_stateBytes + sizeof(unsigned int), sizeof(depth));
+	return depth;
+}
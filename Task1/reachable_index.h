@@ -0,0 +1,64 @@
+#pragma once
+
+#include "board2.h"
+#include "successor_generator.h"
+
+//The class ReachableStateIndex is the graph of the states reachable from a start explored once, so the questions whether
+//another state of the same board is reachable, in how many tilts and by which ones are answered without solving again.
+//The index is the array of the records sorted by their states: the state (the cell of each ball or SunkBall), the number
+//of the record of the parent state, the depth (the number of the tilts from the start) and the tilt from the parent.
+//A state is found with a binary search and its path goes back through the parents, so a query costs the logarithm
+//of the states count plus the path length. The lost states are not kept, the won one (all balls sunk) is kept if it's reachable.
+//The file written by Save is the header and the records as they are, so a loaded index maps the file instead of reading it
+//and the processes loading the same file share its pages.
+class ReachableStateIndex
+{
+public:
+	static const size_t NotReachable = static_cast<size_t>(-1);
+
+	//explores the states reachable from the board, throws domain_error for the boards with more than SunkBall cells
+	//or too many states, SolveCancelled when the cancellation (if any) is requested and logic_error if the board is lost
+	explicit ReachableStateIndex(const Board2 &start, const Cancellation *cancellation = 0);
+	//maps the index written by Save, throws invalid_argument if the file is missing or damaged
+	explicit ReachableStateIndex(const std::string &fileName);
+	//throws runtime_error if the file can't be written
+	void Save(const std::string &fileName) const;
+
+	size_t GetBoardSize() const;
+	size_t GetStatesCount() const;
+	//the queries throw invalid_argument if the target has a ball the board doesn't have or a position off the board
+	bool IsReachable(const BoardStateDigest &target) const;
+	//the number of the tilts of the shortest path from the start or NotReachable
+	size_t GetDistance(const BoardStateDigest &target) const;
+	//fills the tilts of the shortest path from the start, returns false if the target is not reachable
+	bool GetPath(const BoardStateDigest &target, std::vector<TiltDirection> &path) const;
+
+private:
+	static const unsigned int NoParent = 0xFFFFFFFF;
+	//the header of the file, the records follow it
+	struct FileHeader
+	{
+		char magic[8];
+		unsigned long long boardSize;
+		unsigned long long ballsCount;
+		unsigned long long recordsCount;
+	};
+
+	ReachableStateIndex(const ReachableStateIndex&);
+	ReachableStateIndex& operator=(const ReachableStateIndex&);
+
+	//the number of the record of the target or NoParent
+	size_t Find(const BoardStateDigest &target) const;
+	const unsigned char* GetRecord(size_t number) const;
+	unsigned int GetParent(size_t number) const;
+	unsigned int GetDepth(size_t number) const;
+
+	size_t m_boardSize;
+	size_t m_ballsCount;
+	size_t m_stateBytes;
+	size_t m_recordSize;	//the state, the parent, the depth and the tilt
+	size_t m_recordsCount;
+	std::vector<unsigned char> m_builtRecords;	//the records of the explored index
+	std::unique_ptr<boost::interprocess::mapped_region> m_region;	//the mapped file of the loaded index
+	const unsigned char *m_records;
+};
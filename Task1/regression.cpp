@@ -0,0 +1,168 @@
+#include "stdafx.h"
+#include "regression.h"
+#include "puzzle.h"
+#include "board2.h"
+#include "trace.h"
+
+RegressionCase::RegressionCase()
+	:puzzle()
+	,solution()
+	,statistics()
+	,seconds(0)
+	,isMeasured(false)
+{
+}
+
+namespace
+{
+	const double g_timeNoiseSeconds = 0.001;
+
+	//reads "name=value" from the results, throws invalid_argument if it's not there
+	template <typename T>
+	void ReadResult(std::istream &results, const std::string &name, T &value, const std::string &line)
+	{
+		std::string field;
+		results >> field;
+		std::istringstream valueStream(field.substr(std::min(field.size(), name.size() + 1)));
+		if(0 != field.compare(0, name.size() + 1, name + "=") || !(valueStream >> value))
+		{
+			throw std::invalid_argument("the regression results are malformed: " + line);
+		}
+	}
+
+	std::string FormatDelta(double baseline, double measured)
+	{
+		std::ostringstream ss;
+		ss << (measured >= baseline ? "+" : "") << (baseline > 0 ? (measured - baseline) / baseline * 100 : 0) << "%";
+		return ss.str();
+	}
+}
+
+std::vector<RegressionCase> ReadRegressionCorpus(std::istream &input)
+{
+	std::vector<RegressionCase> cases;
+	std::string line;
+	while(std::getline(input, line))
+	{
+		if(!line.empty() && '\r' == line[line.size() - 1])
+		{
+			line.erase(line.size() - 1);
+		}
+		if(line.empty() || 0 == line.compare(0, 2, "//"))
+		{
+			continue;
+		}
+		RegressionCase regressionCase;
+		std::string::size_type resultsStart = line.find('#');
+		regressionCase.puzzle = line.substr(0, resultsStart);
+		regressionCase.puzzle.erase(regressionCase.puzzle.find_last_not_of(' ') + 1);
+		if(std::string::npos != resultsStart)
+		{
+			std::istringstream results(line.substr(resultsStart + 1));
+			ReadResult(results, "solution", regressionCase.solution, line);
+			ReadResult(results, "states", regressionCase.statistics.statesMet, line);
+			ReadResult(results, "queued", regressionCase.statistics.boardsQueued, line);
+			ReadResult(results, "peak_queue", regressionCase.statistics.maxQueueSize, line);
+			double milliseconds = 0;
+			ReadResult(results, "time_ms", milliseconds, line);
+			regressionCase.seconds = milliseconds / 1000;
+			regressionCase.isMeasured = true;
+		}
+		cases.push_back(regressionCase);
+	}
+	return cases;
+}
+
+void WriteRegressionCorpus(std::ostream &output, const std::vector<RegressionCase> &cases)
+{
+	for(std::vector<RegressionCase>::const_iterator it = cases.begin(); it != cases.end(); ++it)
+	{
+		output << it->puzzle;
+		if(it->isMeasured)
+		{
+			output << " # solution=" << it->solution << " states=" << it->statistics.statesMet << " queued=" << it->statistics.boardsQueued;
+			output << " peak_queue=" << it->statistics.maxQueueSize << " time_ms=" << it->seconds * 1000;
+		}
+		output << "\n";
+	}
+	output.flush();
+}
+
+RegressionCase MeasureRegressionCase(const std::string &puzzle, size_t repeats)
+{
+	TRACE_SCOPE("MeasureRegressionCase");
+	RegressionCase measured;
+	measured.puzzle = puzzle;
+	measured.isMeasured = true;
+	Puzzle p(ParsePuzzle(puzzle));
+	Board2 board((PuzzleView(p)));
+	for(size_t i = 0; i < std::max<size_t>(repeats, 1); ++i)
+	{
+		std::vector<TiltDirection> solution;
+		boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+		bool isSolved = Board2::Solve(board, solution, measured.statistics);
+		double seconds = boost::chrono::duration<double>(boost::chrono::steady_clock::now() - start).count();
+		measured.seconds = i ? std::min(measured.seconds, seconds) : seconds;
+		measured.solution.clear();
+		for(size_t j = 0; j < solution.size(); ++j)
+		{
+			measured.solution += DirectionToLetter(solution[j]);
+		}
+		if(!isSolved)
+		{
+			measured.solution = "X";
+		}
+	}
+	return measured;
+}
+
+size_t RunRegression(const std::vector<RegressionCase> &baseline, size_t repeats, double tolerance, bool isTimeGated, bool isVerbose, std::ostream &report)
+{
+	TRACE_SCOPE("RunRegression");
+	size_t regressionsCount = 0;
+	for(size_t i = 0; i < baseline.size(); ++i)
+	{
+		const RegressionCase &expected = baseline[i];
+		RegressionCase measured(MeasureRegressionCase(expected.puzzle, repeats));
+		std::vector<std::string> problems;
+		bool isSlower = false;
+		if(!expected.isMeasured)
+		{
+			problems.push_back("no baseline");
+		}
+		else
+		{
+			if(measured.solution != expected.solution)
+			{
+				problems.push_back("solution " + measured.solution + " instead of " + expected.solution);
+			}
+			if(measured.statistics.statesMet != expected.statistics.statesMet || measured.statistics.boardsQueued != expected.statistics.boardsQueued
+				|| measured.statistics.maxQueueSize != expected.statistics.maxQueueSize)
+			{
+				problems.push_back("nodes or peak queue changed");
+			}
+			isSlower = measured.seconds > expected.seconds * (1 + tolerance) + g_timeNoiseSeconds;
+			if(isSlower && isTimeGated)
+			{
+				problems.push_back("slower than the tolerance");
+			}
+		}
+		regressionsCount += problems.empty() ? 0 : 1;
+		if(!isVerbose && problems.empty() && !isSlower)
+		{
+			continue;
+		}
+		report << "case " << i + 1 << ": " << (!problems.empty() ? "REGRESSION" : isSlower ? "slower than the tolerance (not gated)" : "ok");
+		for(size_t j = 0; j < problems.size(); ++j)
+		{
+			report << (j ? ", " : " (") << problems[j] << (j + 1 == problems.size() ? ")" : "");
+		}
+		report << "\n";
+		report << "\tstates " << measured.statistics.statesMet << " (" << FormatDelta(static_cast<double>(expected.statistics.statesMet), static_cast<double>(measured.statistics.statesMet)) << ")";
+		report << " queued " << measured.statistics.boardsQueued << " (" << FormatDelta(static_cast<double>(expected.statistics.boardsQueued), static_cast<double>(measured.statistics.boardsQueued)) << ")";
+		report << " peak_queue " << measured.statistics.maxQueueSize << " (" << FormatDelta(static_cast<double>(expected.statistics.maxQueueSize), static_cast<double>(measured.statistics.maxQueueSize)) << ")";
+		report << " time_ms " << measured.seconds * 1000 << " (" << FormatDelta(expected.seconds, measured.seconds) << ")\n";
+	}
+	report << baseline.size() << " cases, " << regressionsCount << " regressions" << std::endl;
+	return regressionsCount;
+}
@@ -0,0 +1,33 @@
+#pragma once
+
+#include "solve_statistics.h"
+
+//The struct RegressionCase is a puzzle of the regression corpus with the results of its solving by Board2::Solve.
+//The peak memory of the search is given by the numbers of the met states and of the queued boards at once,
+//so they are compared instead of the memory of the process, which depends on the allocator and is not exact.
+struct RegressionCase
+{
+	std::string puzzle;	//in the input format
+	std::string solution;	//the letters of the tilts or X
+	SolveStatistics statistics;
+	double seconds;	//the least time of the repeated solves
+	bool isMeasured;	//false for a new puzzle without the baseline
+
+	RegressionCase();
+};
+
+//Reads the cases one per line: the puzzle, '#' and the results "solution=... states=... queued=... peak_queue=... time_ms=...".
+//A line without '#' is a new puzzle without the baseline. Empty lines and lines starting with "//" are skipped.
+//Throws invalid_argument when the results are malformed.
+std::vector<RegressionCase> ReadRegressionCorpus(std::istream &input);
+void WriteRegressionCorpus(std::ostream &output, const std::vector<RegressionCase> &cases);
+
+//Solves the puzzle with Board2::Solve repeats times and takes the least time.
+RegressionCase MeasureRegressionCase(const std::string &puzzle, size_t repeats);
+
+//Measures the cases and compares them with their baselines: the solution and the statistics exactly, they don't depend on the machine.
+//The time longer than the baseline * (1 + tolerance) + 1 ms (the noise of the short solves) is reported as slower,
+//it's a regression only if isTimeGated (the baseline times are the ones of the machine the corpus was recorded on).
+//Reports the regressions (or all the cases with the deltas if isVerbose) and returns the number of the regressions.
+//A case without the baseline is reported and counted as a regression.
+size_t RunRegression(const std::vector<RegressionCase> &baseline, size_t repeats, double tolerance, bool isTimeGated, bool isVerbose, std::ostream &report);
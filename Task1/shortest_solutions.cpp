@@ -0,0 +1,140 @@
+#include "stdafx.h"
+#include "shortest_solutions.h"
+
+const size_t ShortestSolutionsGraph::NoState = static_cast<size_t>(-1);
+
+ShortestSolutionsGraph::ShortestSolutionsGraph()
+	:m_states()
+	,m_finalState(NoState)
+	,m_solutionLength(0)
+{
+}
+
+bool ShortestSolutionsGraph::IsSolvable() const
+{
+	return NoState != m_finalState;
+}
+
+size_t ShortestSolutionsGraph::GetSolutionLength() const
+{
+	if(!IsSolvable())
+	{
+		throw std::logic_error("the game has no solution");
+	}
+	return m_solutionLength;
+}
+
+size_t ShortestSolutionsGraph::GetStatesCount() const
+{
+	return m_states.size();
+}
+
+BigUnsigned ShortestSolutionsGraph::CountSolutions() const
+{
+	if(!IsSolvable())
+	{
+		return BigUnsigned();
+	}
+
+	//the states are added layer by layer, so all parents of a state precede it
+	std::vector<BigUnsigned> pathsCount(m_finalState + 1);
+	pathsCount[0] = 1;
+	for(size_t i = 1; i <= m_finalState; ++i)
+	{
+		const std::vector<Parent> &parents = m_states[i].parents;
+		for(std::vector<Parent>::const_iterator it = parents.begin(); it != parents.end(); ++it)
+		{
+			pathsCount[i] += pathsCount[it->state];
+		}
+	}
+	return pathsCount[m_finalState];
+}
+
+std::vector<std::vector<TiltDirection>> ShortestSolutionsGraph::EnumerateSolutions(size_t limit) const
+{
+	std::vector<std::vector<TiltDirection>> solutions;
+	Enumerator enumerator(*this);
+	std::vector<TiltDirection> solution;
+	while(solutions.size() < limit && enumerator.Next(solution))
+	{
+		solutions.push_back(solution);
+	}
+	return solutions;
+}
+
+void ShortestSolutionsGraph::Clear()
+{
+	m_states.clear();
+	m_finalState = NoState;
+	m_solutionLength = 0;
+}
+
+size_t ShortestSolutionsGraph::AddState(size_t layer)
+{
+	m_states.push_back(State());
+	m_states.back().layer = layer;
+	return m_states.size() - 1;
+}
+
+void ShortestSolutionsGraph::AddParent(size_t state, size_t parent, TiltDirection direction)
+{
+	Parent p;
+	p.state = parent;
+	p.direction = direction;
+	m_states[state].parents.push_back(p);
+}
+
+ShortestSolutionsGraph::Enumerator::Enumerator(const ShortestSolutionsGraph &graph)
+	:m_graph(graph)
+	,m_path()
+	,m_isStarted(false)
+{
+}
+
+bool ShortestSolutionsGraph::Enumerator::Next(std::vector<TiltDirection> &solution)
+{
+	if(!m_graph.IsSolvable())
+	{
+		return false;
+	}
+
+	if(!m_isStarted)
+	{
+		m_isStarted = true;
+		Step s = {m_graph.m_finalState, 0};
+		m_path.push_back(s);
+	}
+	else
+	{
+		//backtrack to the deepest step which has an untried parent
+		while(!m_path.empty())
+		{
+			Step &last = m_path.back();
+			if(++last.parentNumber < m_graph.m_states[last.state].parents.size())
+			{
+				break;
+			}
+			m_path.pop_back();
+		}
+		if(m_path.empty())
+		{
+			return false;
+		}
+	}
+
+	//go through the first parents down to the start
+	while(0 != m_path.back().state)
+	{
+		const Step &last = m_path.back();
+		Step s = {m_graph.m_states[last.state].parents[last.parentNumber].state, 0};
+		m_path.push_back(s);
+	}
+
+	//the path goes from the final state to the start, so the tilts are collected in the reverse order
+	solution.clear();
+	for(size_t i = m_path.size() - 1; i-- > 0; )
+	{
+		solution.push_back(m_graph.m_states[m_path[i].state].parents[m_path[i].parentNumber].direction);
+	}
+	return true;
+}
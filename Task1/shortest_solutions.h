@@ -0,0 +1,135 @@
+#pragma once
+
+#include "board.h"
+#include "big_unsigned.h"
+
+//The class ShortestSolutionsGraph keeps all the shortest solutions of a game as a layered graph instead of a list of paths.
+//The breadth-first search goes on till the end of the layer where the first won board appears and every state of the layers
+//remembers all its parents from the previous layer (a parent and a tilt which moves the parent to the state).
+//All won boards are merged into one final state, so the number of the shortest solutions is the number of paths from the start to the final state.
+//It is counted with one pass over the layers, so it costs as much as the search itself however large the number is.
+class ShortestSolutionsGraph
+{
+public:
+	//The class Enumerator lists the solutions one by one (depth-first through the parents, from the final state back to the start),
+	//so getting the first k solutions doesn't require to build all of them.
+	class Enumerator
+	{
+	public:
+		explicit Enumerator(const ShortestSolutionsGraph &graph);
+		//returns false when there are no more solutions
+		bool Next(std::vector<TiltDirection> &solution);
+
+	private:
+		struct Step
+		{
+			size_t state;
+			size_t parentNumber;
+		};
+
+		const ShortestSolutionsGraph &m_graph;
+		std::vector<Step> m_path;
+		bool m_isStarted;
+	};
+
+	template <class BoardType>
+	static bool Build(const BoardType &originalBoard, ShortestSolutionsGraph &graph);
+
+	ShortestSolutionsGraph();
+	bool IsSolvable() const;
+	size_t GetSolutionLength() const;
+	size_t GetStatesCount() const;
+	BigUnsigned CountSolutions() const;
+	//returns at most limit solutions
+	std::vector<std::vector<TiltDirection>> EnumerateSolutions(size_t limit) const;
+
+private:
+	struct Parent
+	{
+		size_t state;
+		TiltDirection direction;
+	};
+	struct State
+	{
+		size_t layer;
+		std::vector<Parent> parents;
+	};
+
+	void Clear();
+	size_t AddState(size_t layer);
+	void AddParent(size_t state, size_t parent, TiltDirection direction);
+
+	static const size_t NoState;
+
+	std::vector<State> m_states;	//the states are added layer by layer, the start is the first one
+	size_t m_finalState;
+	size_t m_solutionLength;
+};
+
+template <class BoardType>
+bool ShortestSolutionsGraph::Build(const BoardType &originalBoard, ShortestSolutionsGraph &graph)
+{
+	graph.Clear();
+	graph.AddState(0);
+	if(originalBoard.IsGameLost())
+	{
+		return false;
+	}
+	if(originalBoard.IsGameWon() || originalBoard.GetStateDigest().empty())
+	{
+		graph.m_finalState = 0;
+		graph.m_solutionLength = 0;
+		return true;
+	}
+
+	const TiltDirection directions[] = {West, South, East, North};
+	std::map<BoardStateDigest, size_t> statesMet;
+	statesMet[originalBoard.GetStateDigest()] = 0;
+	std::vector<std::pair<BoardType, size_t>> curLayer(1, std::make_pair(originalBoard, size_t(0)));
+	std::vector<std::pair<BoardType, size_t>> nextLayer;
+	for(size_t layer = 1; !curLayer.empty(); ++layer)
+	{
+		nextLayer.clear();
+		for(size_t i = 0; i < curLayer.size(); ++i)
+		{
+			for(size_t j = 0; j < sizeof(directions) / sizeof(directions[0]); ++j)
+			{
+				BoardType b(curLayer[i].first);
+				b.Tilt(directions[j]);
+				if(b.IsGameLost())
+				{
+					continue;
+				}
+				if(b.IsGameWon())
+				{
+					if(NoState == graph.m_finalState)
+					{
+						graph.m_finalState = graph.AddState(layer);
+					}
+					graph.AddParent(graph.m_finalState, curLayer[i].second, directions[j]);
+					continue;
+				}
+				std::map<BoardStateDigest, size_t>::iterator stateIt = statesMet.find(b.GetStateDigest());
+				if(statesMet.end() == stateIt)
+				{
+					size_t state = graph.AddState(layer);
+					statesMet.insert(std::make_pair(b.GetStateDigest(), state));
+					graph.AddParent(state, curLayer[i].second, directions[j]);
+					nextLayer.push_back(std::make_pair(b, state));
+				}
+				//the state met on the previous layers is not a part of any shortest path
+				else if(graph.m_states[stateIt->second].layer == layer)
+				{
+					graph.AddParent(stateIt->second, curLayer[i].second, directions[j]);
+				}
+			}
+		}
+		if(NoState != graph.m_finalState)
+		{
+			graph.m_solutionLength = layer;
+			return true;
+		}
+		curLayer.swap(nextLayer);
+	}
+	return false;
+}
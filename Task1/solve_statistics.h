@@ -0,0 +1,22 @@
+#pragma once
+
+//The struct SolveStatistics describes the work done by a solver.
+struct SolveStatistics
+{
+	size_t statesMet;	//number of the different states the search has met (the won state is not counted)
+	size_t boardsQueued;	//number of the boards (or states) put to the queue, including the lost ones and the repeated ones
+	size_t maxQueueSize;	//the largest number of the boards (or states) waiting in the queue at once
+	//the portfolio's engine which has answered and the number of the puzzles each of its engines has answered first so far
+	//(the other solvers leave them empty)
+	std::string winner;
+	std::map<std::string, size_t> engineWins;
+
+	SolveStatistics()
+		:statesMet(0)
+		,boardsQueued(0)
+		,maxQueueSize(0)
+		,winner()
+		,engineWins()
+	{
+	}
+};
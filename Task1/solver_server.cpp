@@ -0,0 +1,298 @@
+#include "stdafx.h"
+#include "solver_server.h"
+#include "puzzle.h"
+#include "board2.h"
+#include "ranked_solver.h"
+#include "trace.h"
+
+SolverServer::Connection::Connection(const std::function<void(const std::string&)> &write)
+	:m_write(write)
+	,m_mutex()
+	,m_responded()
+	,m_pendingRequests(0)
+{
+}
+
+void SolverServer::Connection::AddRequest()
+{
+	boost::lock_guard<boost::mutex> lock(m_mutex);
+	++m_pendingRequests;
+}
+
+void SolverServer::Connection::Respond(const std::string &response)
+{
+	boost::lock_guard<boost::mutex> lock(m_mutex);
+	try
+	{
+		m_write(response);
+	}
+	catch(const std::exception&)
+	{
+		//the client has gone, the rest of its responses are dropped too
+	}
+	if(!--m_pendingRequests)
+	{
+		m_responded.notify_all();
+	}
+}
+
+void SolverServer::Connection::WaitForResponses()
+{
+	boost::unique_lock<boost::mutex> lock(m_mutex);
+	while(m_pendingRequests)
+	{
+		m_responded.wait(lock);
+	}
+}
+
+SolverServer::SolverServer(size_t threadsCount, size_t cacheSize)
+	:m_cacheSize(cacheSize)
+	,m_cacheMutex()
+	,m_cache()
+	,m_queueMutex()
+	,m_queueChanged()
+	,m_queue()
+	,m_isStopping(false)
+	,m_workers()
+{
+	if(!threadsCount)
+	{
+		threadsCount = std::max<size_t>(boost::thread::hardware_concurrency(), 1);
+	}
+	for(size_t i = 0; i < threadsCount; ++i)
+	{
+		m_workers.create_thread(std::bind(&SolverServer::Work, this));
+	}
+}
+
+SolverServer::~SolverServer()
+{
+	{
+		boost::lock_guard<boost::mutex> lock(m_queueMutex);
+		m_isStopping = true;
+	}
+	m_queueChanged.notify_all();
+	m_workers.join_all();
+}
+
+void SolverServer::ServeStream(std::istream &input, std::ostream &output)
+{
+	std::shared_ptr<Connection> connection(std::make_shared<Connection>([&output](const std::string &response) {
+		output << response << '\n';
+		output.flush();
+	}));
+	std::string line;
+	while(std::getline(input, line))
+	{
+		Enqueue(line, connection);
+	}
+	connection->WaitForResponses();
+}
+
+void SolverServer::ServeSocket(const std::string &path)
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	typedef boost::asio::local::stream_protocol Protocol;
+	boost::asio::io_service service;
+	::unlink(path.c_str());
+	Protocol::acceptor acceptor(service, Protocol::endpoint(path));
+	for(;;)
+	{
+		std::shared_ptr<Protocol::socket> socket(std::make_shared<Protocol::socket>(service));
+		acceptor.accept(*socket);
+		//the connection thread reads the requests, the workers write the responses
+		boost::thread([this, socket]() {
+			std::shared_ptr<Connection> connection(std::make_shared<Connection>([socket](const std::string &response) {
+				std::string line(response + '\n');
+				boost::asio::write(*socket, boost::asio::buffer(line));
+			}));
+			boost::asio::streambuf buffer;
+			std::istream input(&buffer);
+			std::string line;
+			boost::system::error_code error;
+			//read_until keeps the data after the line in the buffer, so the pipelined requests are not lost
+			while(boost::asio::read_until(*socket, buffer, '\n', error) && !error)
+			{
+				std::getline(input, line);
+				Enqueue(line, connection);
+			}
+			connection->WaitForResponses();
+		}).detach();
+	}
+#else
+	throw std::logic_error("unix domain sockets are not supported on this platform: " + path);
+#endif
+}
+
+std::string SolverServer::Solve(const std::string &puzzle)
+{
+	TRACE_SCOPE("SolverServer::Solve");
+	{
+		boost::lock_guard<boost::mutex> lock(m_cacheMutex);
+		std::map<std::string, std::string>::const_iterator it = m_cache.find(puzzle);
+		if(m_cache.end() != it)
+		{
+			return it->second;
+		}
+	}
+
+	std::string response;
+	try
+	{
+		Puzzle p(ParsePuzzle(puzzle));
+		std::vector<TiltDirection> solution;
+		//the workers share the memory limit of the ranked states bitmaps
+		bool isSolved = false;
+		if(RankedSolver::IsApplicable(p.boardSize, p.balls.size(), RankedSolver::DefaultMemoryLimit / m_workers.size()))
+		{
+			SolveStatistics statistics;
+			isSolved = RankedSolver::Solve(Board2(PuzzleView(p)), solution, statistics);
+		}
+		else
+		{
+			isSolved = Board2::Solve(Board2(PuzzleView(p)), solution);
+		}
+		if(isSolved)
+		{
+			for(size_t i = 0; i < solution.size(); ++i)
+			{
+				response += DirectionToLetter(solution[i]);
+				response += ' ';
+			}
+		}
+		else
+		{
+			response = "X";
+		}
+	}
+	catch(const std::exception &e)
+	{
+		return std::string("ERROR ") + e.what();
+	}
+
+	boost::lock_guard<boost::mutex> lock(m_cacheMutex);
+	//the simplest eviction: the cache is started anew when it is full
+	if(m_cache.size() >= m_cacheSize)
+	{
+		m_cache.clear();
+	}
+	if(m_cacheSize)
+	{
+		m_cache[puzzle] = response;
+	}
+	return response;
+}
+
+void SolverServer::Enqueue(const std::string &line, const std::shared_ptr<Connection> &connection)
+{
+	Request request;
+	std::string::size_type idEnd = line.find(' ');
+	request.id = line.substr(0, idEnd);
+	request.puzzle = std::string::npos == idEnd ? std::string() : line.substr(idEnd + 1);
+	if(!request.puzzle.empty() && '\r' == request.puzzle[request.puzzle.size() - 1])
+	{
+		request.puzzle.resize(request.puzzle.size() - 1);
+	}
+	if(request.id.empty())
+	{
+		return;
+	}
+	request.connection = connection;
+	connection->AddRequest();
+	{
+		boost::lock_guard<boost::mutex> lock(m_queueMutex);
+		m_queue.push_back(request);
+	}
+	m_queueChanged.notify_one();
+}
+
+void SolverServer::Work()
+{
+	for(;;)
+	{
+		Request request;
+		{
+			boost::unique_lock<boost::mutex> lock(m_queueMutex);
+			while(m_queue.empty() && !m_isStopping)
+			{
+				m_queueChanged.wait(lock);
+			}
+			if(m_queue.empty())
+			{
+				return;
+			}
+			request = m_queue.front();
+			m_queue.pop_front();
+		}
+		request.connection->Respond(request.id + " " + Solve(request.puzzle));
+	}
+}
+
+void RunLoadGenerator(const std::string &path, const std::vector<std::string> &puzzles, size_t requestsCount, size_t inFlight, std::ostream &report)
+{
+#if defined(BOOST_ASIO_HAS_LOCAL_SOCKETS)
+	typedef boost::asio::local::stream_protocol Protocol;
+	typedef boost::chrono::steady_clock Clock;
+	if(!inFlight)
+	{
+		throw std::invalid_argument("inFlight should be possitive");
+	}
+	if(puzzles.empty())
+	{
+		throw std::invalid_argument("no puzzles to send");
+	}
+
+	boost::asio::io_service service;
+	Protocol::socket socket(service);
+	socket.connect(Protocol::endpoint(path));
+
+	std::vector<Clock::time_point> sendTimes(requestsCount);
+	std::vector<double> latencies;
+	latencies.reserve(requestsCount);
+	boost::asio::streambuf buffer;
+	std::istream input(&buffer);
+	std::string line;
+	size_t sent = 0;
+	Clock::time_point start = Clock::now();
+	while(latencies.size() < requestsCount)
+	{
+		//keep the pipeline full
+		std::string requests;
+		for(; sent < requestsCount && sent - latencies.size() < inFlight; ++sent)
+		{
+			std::ostringstream request;
+			request << sent << ' ' << puzzles[sent % puzzles.size()] << '\n';
+			requests += request.str();
+			sendTimes[sent] = Clock::now();
+		}
+		if(!requests.empty())
+		{
+			boost::asio::write(socket, boost::asio::buffer(requests));
+		}
+
+		boost::asio::read_until(socket, buffer, '\n');
+		std::getline(input, line);
+		size_t id = static_cast<size_t>(std::strtoul(line.c_str(), 0, 10));
+		if(id >= sent)
+		{
+			throw std::runtime_error("unexpected response: " + line);
+		}
+		latencies.push_back(boost::chrono::duration<double, boost::micro>(Clock::now() - sendTimes[id]).count());
+	}
+	double seconds = boost::chrono::duration<double>(Clock::now() - start).count();
+
+	std::sort(latencies.begin(), latencies.end());
+	report << "requests: " << requestsCount << ", distinct puzzles: " << std::min(puzzles.size(), requestsCount) << ", in flight: " << inFlight << ", throughput: " << requestsCount / seconds << " requests/s" << std::endl;
+	if(!latencies.empty())
+	{
+		report << "latency, us: p50 " << latencies[latencies.size() / 2] << ", p99 " << latencies[latencies.size() * 99 / 100]
+			<< ", max " << latencies.back() << std::endl;
+	}
+#else
+	(void)puzzles;
+	(void)requestsCount;
+	(void)inFlight;
+	(void)report;
+	throw std::logic_error("unix domain sockets are not supported on this platform: " + path);
+#endif
+}
@@ -0,0 +1,66 @@
+#pragma once
+
+//The class SolverServer solves the puzzles coming as the lines of a simple protocol, keeping its worker threads and caches
+//between the requests (so the requests don't pay for the process startup).
+//Each request line is "<id> <puzzle in the input format>" and gets the response line "<id> <solution>",
+//where the solution is printed as by the application ("E S " or "X") or is "ERROR <message>" for an invalid puzzle.
+//Many requests can be sent without waiting for the responses; the responses come in the order the requests are solved,
+//so the client should match them by the ids.
+class SolverServer
+{
+public:
+	//threadsCount is the number of the worker threads (0 means the number of the hardware threads),
+	//cacheSize is the number of the puzzles which solutions are remembered
+	SolverServer(size_t threadsCount, size_t cacheSize);
+	~SolverServer();
+
+	//serves the requests read from the input till its end, returns when all the responses are written to the output
+	void ServeStream(std::istream &input, std::ostream &output);
+	//listens on the unix domain socket at the path, serving each connection on its own thread; returns only on an error
+	void ServeSocket(const std::string &path);
+	//returns the response text (without the id) for the puzzle
+	std::string Solve(const std::string &puzzle);
+
+private:
+	//The class Connection writes the responses of one client and counts its requests which are not responded yet.
+	class Connection
+	{
+	public:
+		explicit Connection(const std::function<void(const std::string&)> &write);
+		void AddRequest();
+		void Respond(const std::string &response);
+		void WaitForResponses();
+
+	private:
+		std::function<void(const std::string&)> m_write;
+		boost::mutex m_mutex;
+		boost::condition_variable m_responded;
+		size_t m_pendingRequests;
+	};
+	struct Request
+	{
+		std::string id;
+		std::string puzzle;
+		std::shared_ptr<Connection> connection;
+	};
+
+	SolverServer(const SolverServer&);
+	SolverServer& operator=(const SolverServer&);
+
+	void Enqueue(const std::string &line, const std::shared_ptr<Connection> &connection);
+	void Work();
+
+	size_t m_cacheSize;
+	boost::mutex m_cacheMutex;
+	std::map<std::string, std::string> m_cache;
+	boost::mutex m_queueMutex;
+	boost::condition_variable m_queueChanged;
+	std::deque<Request> m_queue;
+	bool m_isStopping;
+	boost::thread_group m_workers;
+};
+
+//Sends requestsCount requests with the puzzles in turn to the server listening on the unix domain socket at the path,
+//keeping at most inFlight requests waiting for the responses, and reports the throughput and the latency percentiles.
+//Note: the server answers a repeated puzzle from its cache, so the puzzles should outnumber the cache to measure the solving.
+void RunLoadGenerator(const std::string &path, const std::vector<std::string> &puzzles, size_t requestsCount, size_t inFlight, std::ostream &report);
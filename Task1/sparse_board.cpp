@@ -0,0 +1,326 @@
+#include "stdafx.h"
+#include "sparse_board.h"
+#include "trace.h"
+
+bool SparseBoard::Solve(const SparseBoard &originalBoard, std::vector<TiltDirection> &solution)
+{
+	SolveStatistics statistics;
+	return Solve(originalBoard, solution, statistics);
+}
+
+bool SparseBoard::Solve(const SparseBoard &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation)
+{
+	TRACE_SCOPE("Solve");
+	statistics = SolveStatistics();
+	std::deque<SparseBoard> boardsQueue;
+	std::set<BoardStateDigest> statesMet;
+	boardsQueue.push_back(originalBoard);
+	statistics.boardsQueued = 1;
+	statistics.maxQueueSize = 1;
+
+	//the boards are queued in the order of their tilts sequences length, so a layer ends when the length changes
+	TRACE_NAMED_SCOPE(layerScope, "Layer");
+	size_t layerDepth = 0;
+	while(!boardsQueue.empty())
+	{
+		SparseBoard &curBoard = boardsQueue.front();
+		if(curBoard.GetTiltsSequence().size() != layerDepth)
+		{
+			layerDepth = curBoard.GetTiltsSequence().size();
+			TRACE_RESTART(layerScope);
+		}
+		if(curBoard.IsGameWon())
+		{
+			solution.assign(curBoard.GetTiltsSequence().begin(), curBoard.GetTiltsSequence().end());
+			statistics.statesMet = statesMet.size();
+			return true;
+		}
+		//if the game is not lost and we didn't meet the cycle (returned to a previous state)
+		if(!curBoard.IsGameLost() && statesMet.insert(curBoard.GetStateDigest()).second)
+		{
+			if(cancellation)
+			{
+				cancellation->Check();
+			}
+			TRACE_SCOPE("TiltBatch");
+			const TiltDirection directions[] = {West, South, East, North};
+			for(size_t i = 0; i < sizeof(directions) / sizeof(directions[0]); ++i)
+			{
+				boardsQueue.push_back(curBoard);
+				boardsQueue.back().Tilt(directions[i]);
+			}
+			statistics.boardsQueued += 4;
+			statistics.maxQueueSize = std::max(statistics.maxQueueSize, boardsQueue.size());
+		}
+		boardsQueue.pop_front();
+	}
+	statistics.statesMet = statesMet.size();
+	return false;
+}
+
+SparseBoard::SparseBoard(size_t boardSize, const std::vector<Position> &balls, const std::vector<Position> &holes, const std::vector<std::pair<Position, Position>> &walls)
+	:m_isGameWon(false)
+	,m_isGameLost(false)
+	,m_tilts()
+	,m_layout()
+	,m_stateDigest()
+{
+	Initialize(PuzzleView(boardSize, balls, holes, walls), UntrustedPuzzle);
+}
+
+SparseBoard::SparseBoard(const PuzzleView &puzzle, PuzzleTrust trust)
+	:m_isGameWon(false)
+	,m_isGameLost(false)
+	,m_tilts()
+	,m_layout()
+	,m_stateDigest()
+{
+	Initialize(puzzle, trust);
+}
+
+void SparseBoard::Initialize(const PuzzleView &puzzle, PuzzleTrust trust)
+{
+	TRACE_SCOPE("SparseBoard::SparseBoard");
+	if(UntrustedPuzzle == trust)
+	{
+		ValidatePuzzle(puzzle);
+	}
+	size_t boardSize = puzzle.boardSize;
+	const Position *balls = puzzle.balls;
+	const Position *holes = puzzle.holes;
+	const std::pair<Position, Position> *walls = puzzle.walls;
+
+	//a wall between two cells of a row starts a new segment of the row at the right cell (the same for the columns)
+	std::vector<std::set<size_t>> rowsStarts(boardSize);
+	std::vector<std::set<size_t>> columnsStarts(boardSize);
+	for(const std::pair<Position, Position> *it = walls; it != walls + puzzle.wallsCount; ++it)
+	{
+		if(it->first.row == it->second.row)
+		{
+			rowsStarts[it->first.row].insert(std::max(it->first.column, it->second.column));
+		}
+		else
+		{
+			columnsStarts[it->first.column].insert(std::max(it->first.row, it->second.row));
+		}
+	}
+	auto fillSegments = [boardSize](const std::set<size_t> &starts, std::vector<Segment> &segments) {
+		Segment segment;
+		segment.begin = 0;
+		for(std::set<size_t>::const_iterator it = starts.begin(); it != starts.end(); ++it)
+		{
+			segment.end = *it;
+			segments.push_back(segment);
+			segment.begin = *it;
+		}
+		segment.end = boardSize;
+		segments.push_back(segment);
+	};
+	std::shared_ptr<Layout> layout(std::make_shared<Layout>());
+	layout->boardSize = boardSize;
+	layout->holesCount = puzzle.holesCount;
+	layout->rows.resize(boardSize);
+	layout->columns.resize(boardSize);
+	for(size_t line = 0; line < boardSize; ++line)
+	{
+		fillSegments(rowsStarts[line], layout->rows[line]);
+		fillSegments(columnsStarts[line], layout->columns[line]);
+	}
+	//the holes are placed in the order of their numbers, so they are sorted by the positions afterwards
+	for(size_t i = 0; i < puzzle.holesCount; ++i)
+	{
+		std::vector<Segment> &row = layout->rows[holes[i].row];
+		std::vector<Segment> &column = layout->columns[holes[i].column];
+		row[FindSegment(row, holes[i].column)].holes.push_back(std::make_pair(holes[i].column, i));
+		column[FindSegment(column, holes[i].row)].holes.push_back(std::make_pair(holes[i].row, i));
+	}
+	auto sortHoles = [](Segment &segment) {
+		std::sort(segment.holes.begin(), segment.holes.end());
+	};
+	for(size_t line = 0; line < boardSize; ++line)
+	{
+		std::for_each(layout->rows[line].begin(), layout->rows[line].end(), sortHoles);
+		std::for_each(layout->columns[line].begin(), layout->columns[line].end(), sortHoles);
+	}
+	m_layout = layout;
+
+	//fill the state digest
+	for(size_t i = 0; i < puzzle.ballsCount; ++i)
+	{
+		m_stateDigest[i] = balls[i];
+	}
+}
+
+bool SparseBoard::IsGameWon() const
+{
+	return m_isGameWon;
+}
+
+bool SparseBoard::IsGameLost() const
+{
+	return m_isGameLost;
+}
+
+void SparseBoard::Tilt(TiltDirection direction)
+{
+	if(m_isGameLost)
+	{
+		throw std::logic_error("the board is not valid anymore");
+	}
+
+	if(m_isGameWon)
+	{
+		return;
+	}
+
+	bool isHorizontal = West == direction || East == direction;
+	bool isTowardBegin = West == direction || North == direction;
+	const std::vector<std::vector<Segment>> &lines = isHorizontal ? m_layout->rows : m_layout->columns;
+
+	//order the balls by the lines and by the order they reach the starting cells
+	std::vector<LineBall> lineBalls(m_stateDigest.size());
+	std::vector<LineBall>::iterator lineBallIt = lineBalls.begin();
+	for(BoardStateDigest::const_iterator it = m_stateDigest.begin(); it != m_stateDigest.end(); ++it, ++lineBallIt)
+	{
+		lineBallIt->line = isHorizontal ? it->second.row : it->second.column;
+		lineBallIt->coordinate = isHorizontal ? it->second.column : it->second.row;
+		lineBallIt->ballNumber = it->first;
+	}
+	std::sort(lineBalls.begin(), lineBalls.end(), [isTowardBegin](const LineBall &first, const LineBall &second) -> bool {
+		if(first.line != second.line)
+		{
+			return first.line < second.line;
+		}
+		return isTowardBegin ? first.coordinate < second.coordinate : first.coordinate > second.coordinate;
+	});
+
+	const Segment *segment = 0;
+	size_t line = 0;
+	size_t stop = 0;	//the cell where the next ball of the segment stops if it doesn't meet a hole
+	for(lineBallIt = lineBalls.begin(); lineBallIt != lineBalls.end(); ++lineBallIt)
+	{
+		if(!segment || line != lineBallIt->line || lineBallIt->coordinate < segment->begin || lineBallIt->coordinate >= segment->end)
+		{
+			line = lineBallIt->line;
+			segment = &lines[line][FindSegment(lines[line], lineBallIt->coordinate)];
+			stop = isTowardBegin ? segment->begin : segment->end - 1;
+		}
+
+		//find the nearest hole (which is not sunk yet) between the ball and the stop cell
+		const std::pair<size_t, size_t> *hole = 0;
+		if(isTowardBegin)
+		{
+			std::vector<std::pair<size_t, size_t>>::const_iterator it = std::lower_bound(segment->holes.begin(), segment->holes.end(), std::make_pair(lineBallIt->coordinate, size_t(0)));
+			while(segment->holes.begin() != it && (--it)->first >= stop)
+			{
+				if(m_stateDigest.count(it->second))
+				{
+					hole = &*it;
+					break;
+				}
+			}
+		}
+		else
+		{
+			std::vector<std::pair<size_t, size_t>>::const_iterator it = std::lower_bound(segment->holes.begin(), segment->holes.end(), std::make_pair(lineBallIt->coordinate + 1, size_t(0)));
+			for(; segment->holes.end() != it && it->first <= stop; ++it)
+			{
+				if(m_stateDigest.count(it->second))
+				{
+					hole = &*it;
+					break;
+				}
+			}
+		}
+
+		if(!hole)
+		{
+			Position &position = m_stateDigest[lineBallIt->ballNumber];
+			(isHorizontal ? position.column : position.row) = stop;
+			stop = isTowardBegin ? stop + 1 : stop - 1;
+		}
+		//if the ball and the hole numbers match
+		else if(hole->second == lineBallIt->ballNumber)
+		{
+			m_stateDigest.erase(lineBallIt->ballNumber);
+			//if no balls is left
+			if(m_stateDigest.empty())
+			{
+				m_isGameWon = true;
+				break;
+			}
+		}
+		else
+		{
+			m_isGameLost = true;
+			break;
+		}
+	}
+
+	m_tilts.push_back(direction);
+}
+
+const std::vector<TiltDirection>& SparseBoard::GetTiltsSequence() const
+{
+	return m_tilts;
+}
+
+const BoardStateDigest& SparseBoard::GetStateDigest() const
+{
+	if(m_isGameLost)
+	{
+		throw std::logic_error("the board is not valid anymore");
+	}
+	return m_stateDigest;
+}
+
+void SparseBoard::GetPackedState(PackedState &state) const
+{
+	if(m_isGameLost)
+	{
+		throw std::logic_error("the board is not valid anymore");
+	}
+	size_t boardSize = m_layout->boardSize;
+	if(boardSize * boardSize > SunkBall)
+	{
+		throw std::domain_error("the board is too large for the packed state");
+	}
+	state.assign(m_layout->holesCount, SunkBall);
+	for(BoardStateDigest::const_iterator it = m_stateDigest.begin(); it != m_stateDigest.end(); ++it)
+	{
+		state[it->first] = static_cast<unsigned short>(it->second.row * boardSize + it->second.column);
+	}
+}
+
+void SparseBoard::SetPackedState(const PackedState &state)
+{
+	if(state.size() != m_layout->holesCount)
+	{
+		throw std::invalid_argument("the state should have a cell for each ball");
+	}
+	size_t boardSize = m_layout->boardSize;
+	if(boardSize * boardSize > SunkBall)
+	{
+		throw std::domain_error("the board is too large for the packed state");
+	}
+
+	m_stateDigest.clear();
+	for(size_t i = 0; i < state.size(); ++i)
+	{
+		if(SunkBall != state[i])
+		{
+			m_stateDigest[i] = Position(state[i] / boardSize, state[i] % boardSize);
+		}
+	}
+	m_isGameWon = m_stateDigest.empty();
+	m_isGameLost = false;
+	m_tilts.clear();
+}
+
+size_t SparseBoard::FindSegment(const std::vector<Segment> &segments, size_t coordinate)
+{
+	//the last segment starting not after the coordinate
+	return std::upper_bound(segments.begin(), segments.end(), coordinate, [](size_t coordinate, const Segment &segment) {
+		return coordinate < segment.begin;
+	}) - segments.begin() - 1;
+}
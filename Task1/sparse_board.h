@@ -0,0 +1,67 @@
+#pragma once
+
+#include "board.h"
+#include "solve_statistics.h"
+#include "packed_state.h"
+#include "cancellation.h"
+
+//The class SparseBoard represents the game the same way as the class Board2 does, but it doesn't keep the cells:
+//the board state is only the positions of the balls (the state digest), so a tilt takes the time depending on the balls count
+//rather than on the board area, which suits the huge boards with a few balls.
+//Each row and column is split by the walls into the segments; each segment knows the holes on it (sorted by their positions).
+//A tilt sorts the balls by the segments and by the order they reach the starting cell of the segment,
+//then each ball stops next to the previous one unless the nearest hole on its way (which is not sunk yet) is closer.
+//The segments depend only on the walls and the holes, so they are shared by the copies of the board.
+class SparseBoard
+{
+public:
+	static bool Solve(const SparseBoard &originalBoard, std::vector<TiltDirection> &solution);
+	//throws SolveCancelled when the cancellation (if any) is requested
+	static bool Solve(const SparseBoard &originalBoard, std::vector<TiltDirection> &solution, SolveStatistics &statistics, const Cancellation *cancellation = 0);
+
+	SparseBoard(size_t boardSize, const std::vector<Position> &balls, const std::vector<Position> &holes, const std::vector<std::pair<Position, Position>> &walls);
+	explicit SparseBoard(const PuzzleView &puzzle, PuzzleTrust trust = UntrustedPuzzle);
+	bool IsGameWon() const;
+	bool IsGameLost() const;
+	//all below methods thow logic_error when game is lost
+	void Tilt(TiltDirection direction);
+	const std::vector<TiltDirection>& GetTiltsSequence() const;
+	const BoardStateDigest& GetStateDigest() const;
+	//the packed state can be used only for the boards with no more than SunkBall cells (otherwise domain_error is thrown)
+	void GetPackedState(PackedState &state) const;
+	//replaces the balls with the ones of the state (of a board with the same walls and holes) and starts the tilts sequence anew
+	void SetPackedState(const PackedState &state);
+
+private:
+	//the adjacent cells of a row (or a column) between the walls
+	struct Segment
+	{
+		size_t begin;	//the first column (or row) of the segment
+		size_t end;	//the column (or row) after the last one
+		std::vector<std::pair<size_t, size_t>> holes;	//the columns (or rows) and the numbers of the holes sorted by the columns (or rows)
+	};
+	struct Layout
+	{
+		size_t boardSize;
+		std::vector<std::vector<Segment>> rows;	//the segments of each row from left to right
+		std::vector<std::vector<Segment>> columns;	//the segments of each column from top to bottom
+		size_t holesCount;
+	};
+	//a ball on a row (or a column) for the tilt
+	struct LineBall
+	{
+		size_t line;	//the row (or the column)
+		size_t coordinate;	//the column (or the row)
+		size_t ballNumber;
+	};
+
+	void Initialize(const PuzzleView &puzzle, PuzzleTrust trust);
+	//returns the number of the segment of the line containing the column (or the row)
+	static size_t FindSegment(const std::vector<Segment> &segments, size_t coordinate);
+
+	bool m_isGameWon;
+	bool m_isGameLost;
+	std::vector<TiltDirection> m_tilts;
+	std::shared_ptr<const Layout> m_layout;
+	BoardStateDigest m_stateDigest;
+};
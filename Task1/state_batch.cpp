@@ -0,0 +1,182 @@
+#include "stdafx.h"
+#include "state_batch.h"
+#include "trace.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, East, North, South};
+
+	inline __m128i Load(const unsigned char *lanes)
+	{
+		return _mm_loadu_si128(reinterpret_cast<const __m128i*>(lanes));
+	}
+
+	inline void Store(unsigned char *lanes, __m128i value)
+	{
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(lanes), value);
+	}
+}
+
+bool StateBatch::IsApplicable(size_t ballsCount)
+{
+	return ballsCount < 0xFF;
+}
+
+StateBatch::StateBatch(const Board2 &board)
+	:m_ballsCount(board.GetHolesCells().size())
+	,m_size(0)
+	,m_layout()
+	,m_cells(board.GetBoardSize() * board.GetBoardSize() * Lanes)
+	,m_balls(board.GetHolesCells().size() * Lanes)
+	,m_lost(Lanes)
+{
+	if(!IsApplicable(m_ballsCount))
+	{
+		throw std::domain_error("the balls numbers don't fit the bytes of the lanes");
+	}
+	std::shared_ptr<Layout> layout(std::make_shared<Layout>());
+	for(size_t i = 0; i < sizeof(g_directions) / sizeof(g_directions[0]); ++i)
+	{
+		board.GetAdjacentSequences(g_directions[i], layout->offsets[g_directions[i]], layout->cells[g_directions[i]]);
+	}
+	layout->holes.assign(board.GetBoardSize() * board.GetBoardSize(), -1);
+	for(size_t i = 0; i < m_ballsCount; ++i)
+	{
+		layout->holes[board.GetHolesCells()[i]] = static_cast<int>(i);
+	}
+	m_layout = layout;
+}
+
+void StateBatch::Clear()
+{
+	std::fill(m_cells.begin(), m_cells.end(), 0);
+	std::fill(m_balls.begin(), m_balls.end(), 0);
+	std::fill(m_lost.begin(), m_lost.end(), 0);
+	m_size = 0;
+}
+
+void StateBatch::SetState(size_t lane, const PackedState &state)
+{
+	if(lane >= Lanes)
+	{
+		throw std::out_of_range("the batch has no such lane");
+	}
+	if(state.size() != m_ballsCount)
+	{
+		throw std::invalid_argument("the state should have a cell for each ball");
+	}
+	for(size_t i = 0; i < state.size(); ++i)
+	{
+		if(SunkBall != state[i])
+		{
+			m_cells[state[i] * Lanes + lane] = static_cast<unsigned char>(i + 1);
+			m_balls[i * Lanes + lane] = 0xFF;
+		}
+	}
+	m_size = std::max(m_size, lane + 1);
+}
+
+size_t StateBatch::GetSize() const
+{
+	return m_size;
+}
+
+void StateBatch::Tilt(TiltDirection direction)
+{
+	const std::vector<size_t> &offsets = m_layout->offsets[direction];
+	const unsigned short *cells = m_layout->cells[direction].data();
+	for(size_t i = 0; i + 1 < offsets.size(); ++i)
+	{
+		if(offsets[i + 1] - offsets[i] > 1)
+		{
+			TiltSequence(cells + offsets[i], offsets[i + 1] - offsets[i]);
+		}
+	}
+}
+
+void StateBatch::TiltSequence(const unsigned short *sequence, size_t length)
+{
+	const std::vector<int> &holes = m_layout->holes;
+	const __m128i zero = _mm_setzero_si128();
+	__m128i lost = Load(m_lost.data());
+	for(bool isMoved = true; isMoved; )
+	{
+		//the content of the current cell is carried to the previous one, so a ball slides through the free cells in one pass
+		__m128i moved = zero;
+		unsigned char *curCell = &m_cells[sequence[length - 1] * Lanes];
+		__m128i cur = Load(curCell);
+		for(size_t i = length - 1; i > 0; --i)
+		{
+			unsigned char *prevCell = &m_cells[sequence[i - 1] * Lanes];
+			__m128i prev = Load(prevCell);
+			__m128i isEmpty = _mm_cmpeq_epi8(cur, zero);
+			__m128i isFree = _mm_cmpeq_epi8(prev, zero);
+			int hole = holes[sequence[i - 1]];
+			if(hole >= 0)
+			{
+				//the ball falls to the hole if the hole is still there, the lane is lost if their numbers don't match
+				unsigned char *holeBall = &m_balls[hole * Lanes];
+				__m128i isHole = Load(holeBall);
+				__m128i isFalling = _mm_andnot_si128(isEmpty, isHole);
+				__m128i isSunk = _mm_and_si128(isFalling, _mm_cmpeq_epi8(cur, _mm_set1_epi8(static_cast<char>(hole + 1))));
+				lost = _mm_or_si128(lost, _mm_andnot_si128(isSunk, isFalling));
+				Store(holeBall, _mm_andnot_si128(isSunk, isHole));
+				cur = _mm_andnot_si128(isFalling, cur);
+				isEmpty = _mm_or_si128(isEmpty, isFalling);
+				isFree = _mm_andnot_si128(isHole, isFree);
+				moved = _mm_or_si128(moved, isFalling);
+			}
+			__m128i isMoving = _mm_andnot_si128(isEmpty, isFree);
+			Store(curCell, _mm_andnot_si128(isMoving, cur));
+			cur = _mm_or_si128(prev, _mm_and_si128(isMoving, cur));
+			moved = _mm_or_si128(moved, isMoving);
+			curCell = prevCell;
+		}
+		Store(curCell, cur);
+		isMoved = 0 != _mm_movemask_epi8(moved);
+	}
+	Store(m_lost.data(), lost);
+}
+
+unsigned int StateBatch::GetLanesMask() const
+{
+	return (1u << m_size) - 1;
+}
+
+unsigned int StateBatch::GetLostMask() const
+{
+	return _mm_movemask_epi8(Load(m_lost.data())) & GetLanesMask();
+}
+
+unsigned int StateBatch::GetWonMask() const
+{
+	__m128i isLeft = _mm_setzero_si128();
+	for(size_t i = 0; i < m_ballsCount; ++i)
+	{
+		isLeft = _mm_or_si128(isLeft, Load(&m_balls[i * Lanes]));
+	}
+	return ~_mm_movemask_epi8(_mm_or_si128(isLeft, Load(m_lost.data()))) & GetLanesMask();
+}
+
+void StateBatch::GetStates(std::vector<PackedState> &states) const
+{
+	states.resize(m_size);
+	for(size_t i = 0; i < m_size; ++i)
+	{
+		states[i].assign(m_ballsCount, SunkBall);
+	}
+	const __m128i zero = _mm_setzero_si128();
+	unsigned int lanesMask = GetLanesMask();
+	for(size_t cell = 0; cell * Lanes < m_cells.size(); ++cell)
+	{
+		const unsigned char *lanes = &m_cells[cell * Lanes];
+		unsigned int ballsMask = ~_mm_movemask_epi8(_mm_cmpeq_epi8(Load(lanes), zero)) & lanesMask;
+		for(size_t lane = 0; ballsMask; ++lane, ballsMask >>= 1)
+		{
+			if(ballsMask & 1)
+			{
+				states[lane][lanes[lane] - 1] = static_cast<unsigned short>(cell);
+			}
+		}
+	}
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include "board2.h"
+
+//The class StateBatch holds up to Lanes states of a board in the structure-of-arrays form and tilts all of them at once with SSE2.
+//Each cell is a vector of Lanes bytes (the ball number + 1 or 0 in each lane) and each ball has a vector of the bytes telling
+//in which lanes it's still on the board (and its hole is there too), so one vector instruction does the work of a cell for all the lanes.
+//A sequence of the adjacent cells is tilted with the passes from its end to its start, each moving the balls to the previous cell while it's free:
+//a pass brings the first not stopped ball of each lane to its place (the border, a ball or a hole), so the passes repeat until no lane changes.
+//The balls keep their order and meet the holes in the same order as in Board2::Tilt, so the states are the same as the scalar tilts give.
+//The lost and won states are the bit masks of the lanes instead of the flags of the boards.
+class StateBatch
+{
+public:
+	static const size_t Lanes = 16;
+
+	//tells whether the balls numbers fit the bytes of the lanes
+	static bool IsApplicable(size_t ballsCount);
+
+	//the board gives the walls and the holes, its balls are not used; domain_error is thrown if the batch is not applicable
+	explicit StateBatch(const Board2 &board);
+	//removes the states of all the lanes
+	void Clear();
+	//puts the state to the cleared lane, the lanes till the last one put are the states of the batch
+	void SetState(size_t lane, const PackedState &state);
+	size_t GetSize() const;
+	//tilts the states of all the lanes
+	void Tilt(TiltDirection direction);
+	//the bit of each lane which state is lost (won) by the tilts
+	unsigned int GetLostMask() const;
+	unsigned int GetWonMask() const;
+	//fills the states of the lanes (the states of the lost lanes are undefined)
+	void GetStates(std::vector<PackedState> &states) const;
+
+private:
+	//the sequences of the adjacent cells of each tilt direction and the holes, which are shared by the copies of the batch
+	struct Layout
+	{
+		std::vector<size_t> offsets[4];
+		std::vector<unsigned short> cells[4];
+		std::vector<int> holes;	//the hole number of each cell or -1
+	};
+
+	void TiltSequence(const unsigned short *sequence, size_t length);
+	unsigned int GetLanesMask() const;
+
+	size_t m_ballsCount;
+	size_t m_size;
+	std::shared_ptr<const Layout> m_layout;
+	std::vector<unsigned char> m_cells;	//Lanes bytes of each cell
+	std::vector<unsigned char> m_balls;	//Lanes bytes of each ball, 0xFF while it's on the board
+	std::vector<unsigned char> m_lost;	//Lanes bytes, 0xFF for the lost lanes
+};
@@ -17,11 +17,15 @@
 #pragma warning(disable : 4996)
 
 #include <stdexcept>
+#include <exception>
 #include <functional>
 #include <utility>
 #include <algorithm>
+#include <numeric>
+#include <cmath>
 #include <vector>
 #include <map>
+#include <set>
 #include <deque>
 #include <queue>
 #include <array>
@@ -30,10 +34,24 @@
 #include <string>
 #include <memory>
 #include <iterator>
+#include <sstream>
+#include <random>
+#include <limits>
+#include <cstring>
+#include <cstdlib>
+#include <new>
+#include <emmintrin.h>
 
 //#define BOOST_ALL_DYN_LINK
 #include <boost/functional.hpp>
 #include <boost/numeric/ublas/matrix.hpp>
 #include <boost/program_options.hpp>
+#include <boost/thread.hpp>
+#include <boost/chrono.hpp>
+#include <boost/asio.hpp>
+#include <boost/atomic.hpp>
+#include <boost/filesystem.hpp>
+#include <boost/interprocess/file_mapping.hpp>
+#include <boost/interprocess/mapped_region.hpp>
 
 #pragma warning( pop )
@@ -0,0 +1,118 @@
+#include "stdafx.h"
+#include "successor_generator.h"
+
+namespace
+{
+	const TiltDirection g_directions[] = {West, East, North, South};
+}
+
+SuccessorGenerator::SuccessorGenerator(const Board2 &board)
+	:m_holes()
+	,m_horizontalBalls()
+	,m_verticalBalls()
+	,m_holesLeft()
+{
+	size_t cellsCount = board.GetBoardSize() * board.GetBoardSize();
+	if(cellsCount > SunkBall)
+	{
+		throw std::domain_error("the board is too large for the packed state");
+	}
+	const std::vector<size_t> &holesCells = board.GetHolesCells();
+	m_holes.assign(cellsCount, -1);
+	for(size_t i = 0; i < holesCells.size(); ++i)
+	{
+		m_holes[holesCells[i]] = static_cast<int>(i);
+	}
+	for(size_t i = 0; i < DirectionsCount; ++i)
+	{
+		Direction &direction = m_directions[g_directions[i]];
+		std::vector<size_t> offsets;
+		board.GetAdjacentSequences(g_directions[i], offsets, direction.cells);
+		direction.positions.resize(cellsCount);
+		direction.sequenceStarts.resize(cellsCount);
+		direction.previousHoles.resize(cellsCount);
+		for(size_t j = 0; j + 1 < offsets.size(); ++j)
+		{
+			unsigned short previousHole = NoPosition;
+			for(size_t position = offsets[j]; position < offsets[j + 1]; ++position)
+			{
+				direction.positions[direction.cells[position]] = static_cast<unsigned short>(position);
+				direction.sequenceStarts[position] = static_cast<unsigned short>(offsets[j]);
+				direction.previousHoles[position] = previousHole;
+				if(m_holes[direction.cells[position]] >= 0)
+				{
+					previousHole = static_cast<unsigned short>(position);
+				}
+			}
+		}
+	}
+}
+
+void SuccessorGenerator::Expand(const PackedState &state, Successor successors[DirectionsCount])
+{
+	//read the balls of the parent once for both axes
+	m_horizontalBalls.clear();
+	m_verticalBalls.clear();
+	const std::vector<unsigned short> &horizontalPositions = m_directions[West].positions;
+	const std::vector<unsigned short> &verticalPositions = m_directions[North].positions;
+	for(size_t i = 0; i < state.size(); ++i)
+	{
+		if(SunkBall != state[i])
+		{
+			m_horizontalBalls.push_back(BallPosition(horizontalPositions[state[i]], static_cast<unsigned short>(i)));
+			m_verticalBalls.push_back(BallPosition(verticalPositions[state[i]], static_cast<unsigned short>(i)));
+		}
+	}
+	std::sort(m_horizontalBalls.begin(), m_horizontalBalls.end());
+	std::sort(m_verticalBalls.begin(), m_verticalBalls.end());
+	Tilt(m_directions[West], state, m_horizontalBalls, false, successors[West]);
+	Tilt(m_directions[East], state, m_horizontalBalls, true, successors[East]);
+	Tilt(m_directions[North], state, m_verticalBalls, false, successors[North]);
+	Tilt(m_directions[South], state, m_verticalBalls, true, successors[South]);
+}
+
+void SuccessorGenerator::Tilt(const Direction &direction, const PackedState &state, const std::vector<BallPosition> &balls, bool isBackwards, Successor &successor)
+{
+	successor.state = state;
+	m_holesLeft.resize(state.size());
+	for(size_t i = 0; i < state.size(); ++i)
+	{
+		m_holesLeft[i] = SunkBall != state[i];
+	}
+	size_t ballsLeft = balls.size();
+	//the position the next ball of the sequence stops at
+	size_t sequenceStart = NoPosition;
+	size_t next = 0;
+	for(size_t i = 0; i < balls.size(); ++i)
+	{
+		size_t ball = balls[isBackwards ? balls.size() - 1 - i : i].second;
+		size_t position = direction.positions[state[ball]];
+		if(direction.sequenceStarts[position] != sequenceStart)
+		{
+			sequenceStart = direction.sequenceStarts[position];
+			next = sequenceStart;
+		}
+		//the nearest hole left between the ball and the next position
+		size_t hole = position;
+		do
+		{
+			hole = direction.previousHoles[hole];
+		}
+		while(NoPosition != hole && hole >= next && !m_holesLeft[m_holes[direction.cells[hole]]]);
+		if(NoPosition == hole || hole < next)
+		{
+			successor.state[ball] = direction.cells[next];
+			++next;
+			continue;
+		}
+		if(m_holes[direction.cells[hole]] != static_cast<int>(ball))
+		{
+			successor.outcome = Lost;
+			return;
+		}
+		successor.state[ball] = SunkBall;
+		m_holesLeft[ball] = false;
+		--ballsLeft;
+	}
+	successor.outcome = ballsLeft ? Moved : Won;
+}
@@ -0,0 +1,49 @@
+#pragma once
+
+#include "board2.h"
+
+//The class SuccessorGenerator makes the four tilts of a packed state at once, without a board and without going through the cells.
+//The layout of the board is turned into the tables of each direction: the position of each cell in the sequences of the adjacent cells
+//(all the sequences one after another, each from the cell the balls move to), the start of the sequence of each position
+//and the previous position of a hole in the same sequence. The balls of the parent are read once, their positions of both axes
+//are sorted (a vertical tilt goes through the order of the other vertical one backwards, the same is for the horizontal ones),
+//then the balls of each sequence are moved in their order: a ball falls to the nearest hole left between it and the previous stopped ball
+//or stops next to that ball (or the border).
+//The balls keep their order and meet the holes in the same order as in Board2::Tilt, so the children are the same as the tilts of the board give.
+class SuccessorGenerator
+{
+public:
+	enum Outcome {Moved, Lost, Won};
+	struct Successor
+	{
+		Outcome outcome;
+		PackedState state;	//the child for the Moved outcome
+	};
+	static const size_t DirectionsCount = 4;
+
+	//the board gives the walls and the holes, its balls are not used; domain_error is thrown for the boards with more than SunkBall cells
+	explicit SuccessorGenerator(const Board2 &board);
+	//fills the successors of the state for each tilt direction (the successors are indexed by the directions)
+	void Expand(const PackedState &state, Successor successors[DirectionsCount]);
+
+private:
+	//the tables of a tilt direction
+	struct Direction
+	{
+		std::vector<unsigned short> cells;	//the cell of each position
+		std::vector<unsigned short> positions;	//the position of each cell
+		std::vector<unsigned short> sequenceStarts;	//the first position of the sequence of each position
+		std::vector<unsigned short> previousHoles;	//the previous position of a hole in the sequence (or NoPosition) of each position
+	};
+	typedef std::pair<unsigned short, unsigned short> BallPosition;	//the position and the number of a ball
+	static const unsigned short NoPosition = 0xFFFF;
+
+	//moves the balls given in the order of the positions of the direction (or backwards)
+	void Tilt(const Direction &direction, const PackedState &state, const std::vector<BallPosition> &balls, bool isBackwards, Successor &successor);
+
+	std::vector<int> m_holes;	//the hole number of each cell or -1
+	Direction m_directions[DirectionsCount];
+	std::vector<BallPosition> m_horizontalBalls;	//the balls sorted by their positions of the West tilt
+	std::vector<BallPosition> m_verticalBalls;	//the balls sorted by their positions of the North tilt
+	std::vector<bool> m_holesLeft;
+};
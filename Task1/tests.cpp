@@ -1,6 +1,66 @@
 #include "stdafx.h"
 #include "board.h"
 #include "board2.h"
+#include "sparse_board.h"
+#include "puzzle.h"
+#include "verifier.h"
+#include "shortest_solutions.h"
+#include "generator.h"
+#include "compact_solver.h"
+#include "ranked_solver.h"
+#include "nogood_solver.h"
+#include "state_batch.h"
+#include "successor_generator.h"
+#include "reachable_index.h"
+#include "checkpointed_solver.h"
+#include "portfolio_solver.h"
+#include "engine.h"
+#include "calibration.h"
+#include "regression.h"
+#include "solver_server.h"
+#include "trace.h"
+
+namespace
+{
+	//the heap bytes taken now and the most of them since they were last reset, so the tests can measure the memory of the solvers
+	boost::atomic<long long> g_heapBytes(0);
+	boost::atomic<long long> g_peakHeapBytes(0);
+	//the size of each block is kept before it, the header keeps the block aligned as malloc does
+	const size_t HeapHeaderSize = 16;
+}
+
+void* operator new(size_t size)
+{
+	void *block = std::malloc(size + HeapHeaderSize);
+	if(!block)
+	{
+		throw std::bad_alloc();
+	}
+	*static_cast<size_t*>(block) = size;
+	long long heapBytes = g_heapBytes.fetch_add(static_cast<long long>(size)) + static_cast<long long>(size);
+	long long peakHeapBytes = g_peakHeapBytes.load();
+	while(heapBytes > peakHeapBytes && !g_peakHeapBytes.compare_exchange_weak(peakHeapBytes, heapBytes))
+	{
+	}
+	return static_cast<char*>(block) + HeapHeaderSize;
+}
+
+void operator delete(void *pointer) throw()
+{
+	if(!pointer)
+	{
+		return;
+	}
+	char *block = static_cast<char*>(pointer) - HeapHeaderSize;
+	g_heapBytes.fetch_sub(static_cast<long long>(*reinterpret_cast<size_t*>(block)));
+	std::free(block);
+}
+
+//the sized deallocation of C++14 may not call the unsized one
+void operator delete(void *pointer, size_t /*size*/) throw()
+{
+	operator delete(pointer);
+}
 
 //example 2 from the task
 //	-------------
@@ -231,6 +291,1234 @@ void Test2()
 }
 
 
+//Test for the verification of the claimed solutions (example 1 from the task)
+void TestVerification()
+{
+	std::vector<VerificationTask> tasks(5);
+	for(size_t i = 0; i < tasks.size(); ++i)
+	{
+		tasks[i].puzzle = "4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4";
+	}
+	tasks[0].solution = "E S ";
+	tasks[1].solution = "ES";
+	tasks[2].solution = "E";
+	tasks[3].solution = "S E N";
+	tasks[4].solution = "E Q";
+	std::array<VerificationResult, 5> resultsStandard = {VerificationWon, VerificationWon, VerificationIncomplete, VerificationLost, VerificationInvalid};
+
+	std::vector<VerificationResult> results;
+	VerifySolutions(tasks, results, 2);
+	if(results.size() != resultsStandard.size() || !std::equal(resultsStandard.begin(), resultsStandard.end(), results.begin()))
+	{
+		std::cerr << "TestVerification failed: wrong verdicts!" << std::endl;
+	}
+
+	std::stringstream input;
+	std::stringstream output;
+	for(size_t i = 0; i < tasks.size(); ++i)
+	{
+		input << tasks[i].puzzle << '\n' << tasks[i].solution << '\n';
+	}
+	VerifySolutionsStream(input, output, 2, 2);
+	if(output.str() != "won\nwon\nincomplete\nlost\ninvalid\n")
+	{
+		std::cerr << "TestVerification failed: wrong verdicts in the stream mode!" << std::endl;
+	}
+}
+
+//Test for counting the shortest solutions:
+//	-------------------
+//	| >1< |     |     |
+//	-------------------
+//	|     |     |     |
+//	-------------------
+//	|     |     | (1) |
+//	-------------------
+template <class BoardType>
+void TestShortestSolutions()
+{
+	Puzzle puzzle(ParsePuzzle("3 1 0 1 1 3 3"));
+	BoardType b(puzzle.boardSize, puzzle.balls, puzzle.holes, puzzle.walls);
+	ShortestSolutionsGraph graph;
+	if(!ShortestSolutionsGraph::Build(b, graph))
+	{
+		std::cerr << "TestShortestSolutions failed: solution is not found!" << std::endl;
+		return;
+	}
+	if(2 != graph.GetSolutionLength() || BigUnsigned(2) != graph.CountSolutions())
+	{
+		std::cerr << "TestShortestSolutions failed: wrong solutions count!" << std::endl;
+	}
+	std::vector<std::vector<TiltDirection>> solutions(graph.EnumerateSolutions(10));
+	if(2 != solutions.size() || solutions[0] == solutions[1])
+	{
+		std::cerr << "TestShortestSolutions failed: wrong solutions enumerated!" << std::endl;
+	}
+	for(size_t i = 0; i < solutions.size(); ++i)
+	{
+		if(VerificationWon != VerifySolution<BoardType>(puzzle, solutions[i]))
+		{
+			std::cerr << "TestShortestSolutions failed: enumerated solution doesn't win!" << std::endl;
+		}
+	}
+
+	puzzle = ParsePuzzle("3  1  2   2 1   1 2   1 1 1 2  1 2 1 3");
+	if(ShortestSolutionsGraph::Build(BoardType(puzzle.boardSize, puzzle.balls, puzzle.holes, puzzle.walls), graph) || !graph.CountSolutions().IsZero())
+	{
+		std::cerr << "TestShortestSolutions failed: solution found!" << std::endl;
+	}
+}
+
+//Test for the generator of the puzzles
+void TestGenerator()
+{
+	GeneratorOptions options;
+	options.boardSize = 4;
+	options.ballsCount = 2;
+	options.wallsCount = 3;
+	options.minSolutionLength = 4;
+	options.puzzlesCount = 2;
+	options.threadsCount = 2;
+	std::vector<GeneratedPuzzle> puzzles(GeneratePuzzles(options));
+	if(puzzles.size() != options.puzzlesCount)
+	{
+		std::cerr << "TestGenerator failed: wrong number of the puzzles!" << std::endl;
+	}
+	for(size_t i = 0; i < puzzles.size(); ++i)
+	{
+		//the puzzle should survive the round trip through the corpus format
+		Puzzle p(ParsePuzzle(FormatPuzzle(puzzles[i].puzzle)));
+		std::vector<TiltDirection> solution;
+		if(!Board2::Solve(Board2(p.boardSize, p.balls, p.holes, p.walls), solution) || solution.size() != puzzles[i].solutionLength || solution.size() < options.minSolutionLength)
+		{
+			std::cerr << "TestGenerator failed: wrong puzzle generated!" << std::endl;
+		}
+	}
+	//the states count is the one of all the reachable states, not only the ones met before the solution is found
+	options.isUnsolvable = false;
+	options.minSolutionLength = 0;
+	options.puzzlesCount = 4;
+	std::vector<GeneratedPuzzle> solvablePuzzles(GeneratePuzzles(options));
+	options.isUnsolvable = true;
+	std::vector<GeneratedPuzzle> unsolvablePuzzles(GeneratePuzzles(options));
+	puzzles.assign(solvablePuzzles.begin(), solvablePuzzles.end());
+	puzzles.insert(puzzles.end(), unsolvablePuzzles.begin(), unsolvablePuzzles.end());
+	for(size_t i = 0; i < puzzles.size(); ++i)
+	{
+		Board2 b((PuzzleView(puzzles[i].puzzle)));
+		if(!b.IsGameLost() && puzzles[i].statesCount != ReachableStateIndex(b).GetStatesCount())
+		{
+			std::cerr << "TestGenerator failed: wrong states count!" << std::endl;
+		}
+	}
+}
+
+//Test for the generator on the boards full of the objects: the sampling and the mutations should take the free places
+//(or none) instead of hanging
+void TestGeneratorFullBoards()
+{
+	//the balls and the holes take all the cells, the walls take all the borders, there are no objects at all
+	const size_t layouts[][3] = {{2, 1, 4}, {2, 2, 0}, {3, 0, 0}, {3, 0, 12}, {3, 4, 1}};
+	for(size_t i = 0; i < sizeof(layouts) / sizeof(layouts[0]); ++i)
+	{
+		GeneratorOptions options;
+		options.boardSize = layouts[i][0];
+		options.ballsCount = layouts[i][1];
+		options.wallsCount = layouts[i][2];
+		options.minSolutionLength = 0;
+		options.isUnsolvable = false;
+		options.climbingSteps = 20;
+		options.maxSamples = 4;
+		options.threadsCount = 1;
+		std::vector<GeneratedPuzzle> puzzles(GeneratePuzzles(options));
+		for(size_t j = 0; j < puzzles.size(); ++j)
+		{
+			const Puzzle &p = puzzles[j].puzzle;
+			if(p.balls.size() != options.ballsCount || p.holes.size() != options.ballsCount || p.walls.size() != options.wallsCount)
+			{
+				std::cerr << "TestGeneratorFullBoards failed: wrong number of the objects!" << std::endl;
+			}
+			ValidatePuzzle(PuzzleView(p));
+		}
+	}
+	//more objects than the places are rejected
+	const size_t wrongLayouts[][3] = {{2, 3, 0}, {2, 0, 5}, {1, 0, 0}};
+	for(size_t i = 0; i < sizeof(wrongLayouts) / sizeof(wrongLayouts[0]); ++i)
+	{
+		GeneratorOptions options;
+		options.boardSize = wrongLayouts[i][0];
+		options.ballsCount = wrongLayouts[i][1];
+		options.wallsCount = wrongLayouts[i][2];
+		try
+		{
+			GeneratePuzzles(options);
+			std::cerr << "TestGeneratorFullBoards failed: wrong options are accepted!" << std::endl;
+		}
+		catch(const std::invalid_argument&)
+		{
+		}
+	}
+}
+
+//Test for the puzzle validation: each kind of the wrong positions should be reported, the trusted puzzle should make the same board
+void TestPuzzleValidation()
+{
+	//the same balls, a ball on a hole, the same holes, a wall not on a border, a ball out of the board
+	const char *puzzles[] = {"2 2 1 1 1 1 1 1 2 2 2 1 1 1 2", "2 2 1 1 1 2 1 1 1 2 2 1 1 1 2", "2 2 1 1 1 2 1 1 2 1 2 1 1 1 2",
+		"2 2 1 1 1 2 1 1 2 2 2 1 1 2 2", "2 1 0 3 1 1 1"};
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		try
+		{
+			ValidatePuzzle(PuzzleView(ParsePuzzle(puzzles[i])));
+			std::cerr << "TestPuzzleValidation failed: wrong puzzle is accepted!" << std::endl;
+		}
+		catch(const std::domain_error&)
+		{
+		}
+	}
+
+	Puzzle p(ParsePuzzle("4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4"));
+	ValidatePuzzle(PuzzleView(p));
+	Board2 b(p.boardSize, p.balls, p.holes, p.walls);
+	Board2 trustedBoard(PuzzleView(p), TrustedPuzzle);
+	SparseBoard trustedSparseBoard(PuzzleView(p), TrustedPuzzle);
+	std::vector<TiltDirection> solution;
+	std::vector<TiltDirection> trustedSolution;
+	std::vector<TiltDirection> trustedSparseSolution;
+	if(Board2::Solve(b, solution) != Board2::Solve(trustedBoard, trustedSolution) || solution != trustedSolution ||
+	   !SparseBoard::Solve(trustedSparseBoard, trustedSparseSolution) || trustedSparseSolution.size() != solution.size())
+	{
+		std::cerr << "TestPuzzleValidation failed: trusted puzzle makes a different board!" << std::endl;
+	}
+}
+
+//Test for the large boards (Board2 keeps the column-major cells for them, SparseBoard doesn't keep the cells at all):
+//the tilts should move the balls as the reference Board does
+void TestLargeBoard()
+{
+	const size_t boardSize = 100;
+	std::mt19937 random(7);
+	std::uniform_int_distribution<size_t> coordinate(0, boardSize - 1);
+	//the first ball is in the corner pocket next to its hole, so the first West tilt sinks it
+	std::set<Position> used;
+	std::vector<Position> balls(1, Position(0, 1));
+	std::vector<Position> holes(1, Position(0, 0));
+	used.insert(balls[0]);
+	used.insert(holes[0]);
+	while(holes.size() < 40)
+	{
+		Position p(coordinate(random), coordinate(random));
+		if(used.insert(p).second)
+		{
+			(balls.size() == holes.size() ? balls : holes).push_back(p);
+		}
+	}
+	std::vector<std::pair<Position, Position>> walls;
+	for(size_t i = 0; i < 200; ++i)
+	{
+		Position p(coordinate(random), coordinate(random) % (boardSize - 1));
+		walls.push_back(0 == i % 2 ? std::make_pair(p, Position(p.row, p.column + 1)) : std::make_pair(Position(p.column, p.row), Position(p.column + 1, p.row)));
+	}
+	walls.push_back(std::make_pair(Position(0, 1), Position(0, 2)));
+	walls.push_back(std::make_pair(Position(0, 1), Position(1, 1)));
+	walls.push_back(std::make_pair(Position(0, 0), Position(1, 0)));
+	//the other holes are walled, so the game is not lost and lasts all the tilts
+	for(size_t i = 1; i < holes.size(); ++i)
+	{
+		const Position &h = holes[i];
+		if(h.row + 1 < boardSize)
+		{
+			walls.push_back(std::make_pair(h, Position(h.row + 1, h.column)));
+		}
+		if(h.column + 1 < boardSize)
+		{
+			walls.push_back(std::make_pair(h, Position(h.row, h.column + 1)));
+		}
+		if(h.row)
+		{
+			walls.push_back(std::make_pair(h, Position(h.row - 1, h.column)));
+		}
+		if(h.column)
+		{
+			walls.push_back(std::make_pair(h, Position(h.row, h.column - 1)));
+		}
+	}
+
+	//Board keeps the positions in its matrix with the cells between the walls, so they are doubled
+	auto isSameState = [](const BoardStateDigest &digest, const BoardStateDigest &digest2) -> bool {
+		if(digest.size() != digest2.size())
+		{
+			return false;
+		}
+		for(BoardStateDigest::const_iterator it = digest.begin(), it2 = digest2.begin(); it != digest.end(); ++it, ++it2)
+		{
+			if(it->first != it2->first || !(it->second == Position(it2->second.row * 2, it2->second.column * 2)))
+			{
+				return false;
+			}
+		}
+		return true;
+	};
+	const TiltDirection directions[] = {West, South, East, North};
+	Board board(boardSize, balls, holes, walls);
+	Board2 board2(boardSize, balls, holes, walls);
+	SparseBoard sparseBoard(boardSize, balls, holes, walls);
+	for(size_t i = 0; i < 100 && !board.IsGameLost() && !board.IsGameWon(); ++i)
+	{
+		TiltDirection direction = directions[random() % 4];
+		board.Tilt(direction);
+		board2.Tilt(direction);
+		sparseBoard.Tilt(direction);
+		if(board.IsGameLost() != board2.IsGameLost() || board.IsGameWon() != board2.IsGameWon() ||
+		   (!board.IsGameLost() && !isSameState(board.GetStateDigest(), board2.GetStateDigest())))
+		{
+			std::cerr << "TestLargeBoard failed: the boards differ after " << i + 1 << " tilts!" << std::endl;
+			return;
+		}
+		if(board2.IsGameLost() != sparseBoard.IsGameLost() || board2.IsGameWon() != sparseBoard.IsGameWon() ||
+		   (!board2.IsGameLost() && !(board2.GetStateDigest() == sparseBoard.GetStateDigest())))
+		{
+			std::cerr << "TestLargeBoard failed: the sparse board differs after " << i + 1 << " tilts!" << std::endl;
+			return;
+		}
+		//the column-major cells should follow the packed state too
+		if(!board2.IsGameLost())
+		{
+			PackedState state;
+			board2.GetPackedState(state);
+			board2.SetPackedState(state);
+		}
+	}
+}
+
+//Test for the solver keeping the compressed layers: it should find the solutions of the same length as Board2::Solve
+void TestCompactSolver()
+{
+	CompressedStateList list(2);
+	std::vector<PackedState> states;
+	for(unsigned short i = 0; i < 300; ++i)
+	{
+		PackedState s(2);
+		s[0] = i / 7;
+		s[1] = (i % 7) ? i : SunkBall;
+		states.push_back(s);
+	}
+	std::sort(states.begin(), states.end());
+	for(size_t i = 0; i < states.size(); i += 2)
+	{
+		list.Append(states[i]);
+	}
+	PackedState decoded;
+	CompressedStateList::Reader reader(list);
+	for(size_t i = 0; i < states.size(); ++i)
+	{
+		if(list.Contains(states[i]) != (0 == i % 2) || (0 == i % 2 && (!reader.Next(decoded) || decoded != states[i])))
+		{
+			std::cerr << "TestCompactSolver failed: wrong compressed list!" << std::endl;
+			break;
+		}
+	}
+
+	const char *puzzles[] = {"2 2 1 1 1 2 2 1 2 2 1 1 1 1 2", "4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4", "3  1  2   2 1   1 2   1 1 1 2  1 2 1 3",
+		"5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5"};
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		Board2 b(p.boardSize, p.balls, p.holes, p.walls);
+		std::vector<TiltDirection> solutionStandard;
+		std::vector<TiltDirection> solution;
+		SolveStatistics statisticsStandard;
+		SolveStatistics statistics;
+		bool isSolvedStandard = Board2::Solve(b, solutionStandard, statisticsStandard);
+		//small chunks make the layers to be merged from several runs
+		if(CompactSolver::Solve(b, solution, statistics, 3) != isSolvedStandard || solution.size() != solutionStandard.size())
+		{
+			std::cerr << "TestCompactSolver failed: wrong solution found!" << std::endl;
+		}
+		else if(isSolvedStandard && VerificationWon != VerifySolution<Board2>(p, solution))
+		{
+			std::cerr << "TestCompactSolver failed: solution doesn't win!" << std::endl;
+		}
+		else if(!isSolvedStandard && statistics.statesMet != statisticsStandard.statesMet)
+		{
+			std::cerr << "TestCompactSolver failed: wrong states count!" << std::endl;
+		}
+	}
+}
+
+//Test of the memory saved by the compact solver: its peak heap bytes per state should be 4 times fewer than the ones of Board2::Solve
+//(the bytes and the speed of both are reported)
+void TestCompactSolverBytes()
+{
+	//the pseudo-random walls stop the balls in many cells, so the unsolvable puzzle has tens of thousands of states
+	Puzzle p;
+	p.boardSize = 20;
+	unsigned int seed = 4;
+	std::set<Position> cells;
+	while(cells.size() < 6)
+	{
+		seed = seed * 1103515245 + 12345;
+		cells.insert(Position((seed >> 8) % p.boardSize, (seed >> 20) % p.boardSize));
+	}
+	std::vector<Position> places(cells.begin(), cells.end());
+	p.balls.assign(places.begin(), places.begin() + 3);
+	p.holes.assign(places.begin() + 3, places.end());
+	std::set<std::pair<Position, Position>> walls;
+	while(walls.size() < 150)
+	{
+		seed = seed * 1103515245 + 12345;
+		size_t row = (seed >> 8) % p.boardSize;
+		size_t column = (seed >> 20) % p.boardSize;
+		if((seed & 0x80000000) && column + 1 < p.boardSize)
+		{
+			walls.insert(std::make_pair(Position(row, column), Position(row, column + 1)));
+		}
+		else if(!(seed & 0x80000000) && row + 1 < p.boardSize)
+		{
+			walls.insert(std::make_pair(Position(row, column), Position(row + 1, column)));
+		}
+	}
+	p.walls.assign(walls.begin(), walls.end());
+	Board2 board((PuzzleView(p)));
+
+	const char *solvers[] = {"Board2::Solve", "CompactSolver"};
+	double bytesPerState[2];
+	size_t statesMet[2];
+	for(size_t i = 0; i < 2; ++i)
+	{
+		std::vector<TiltDirection> solution;
+		SolveStatistics statistics;
+		long long heapBytes = g_heapBytes.load();
+		g_peakHeapBytes.store(heapBytes);
+		boost::chrono::steady_clock::time_point start = boost::chrono::steady_clock::now();
+		bool isSolved = 0 == i ? Board2::Solve(board, solution, statistics) : CompactSolver::Solve(board, solution, statistics);
+		boost::chrono::duration<double> time = boost::chrono::steady_clock::now() - start;
+		statesMet[i] = isSolved ? 0 : statistics.statesMet;
+		bytesPerState[i] = static_cast<double>(g_peakHeapBytes.load() - heapBytes) / std::max<size_t>(statistics.statesMet, 1);
+		std::cout << solvers[i] << ": " << statistics.statesMet << " states, " << bytesPerState[i] << " bytes per state, "
+			<< statistics.statesMet / std::max(time.count(), 1e-9) << " states per second" << std::endl;
+	}
+	if(!statesMet[0] || statesMet[0] != statesMet[1])
+	{
+		std::cerr << "TestCompactSolverBytes failed: wrong states count!" << std::endl;
+	}
+	else if(4 * bytesPerState[1] > bytesPerState[0])
+	{
+		std::cerr << "TestCompactSolverBytes failed: too many bytes per state!" << std::endl;
+	}
+}
+
+void TestRankedSolver()
+{
+	const char *puzzles[] = {"2 2 1 1 1 2 2 1 2 2 1 1 1 1 2", "4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4", "3  1  2   2 1   1 2   1 1 1 2  1 2 1 3",
+		"5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5", "2 1 2 1 1 2 2 1 1 1 2 1 1 2 1"};
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		Board2 b(p.boardSize, p.balls, p.holes, p.walls);
+		std::vector<TiltDirection> solutionStandard;
+		std::vector<TiltDirection> solution;
+		SolveStatistics statisticsStandard;
+		SolveStatistics statistics;
+		bool isSolvedStandard = Board2::Solve(b, solutionStandard, statisticsStandard);
+		//the states are expanded in the same order, so the same solution is found
+		if(RankedSolver::Solve(b, solution, statistics) != isSolvedStandard || solution != solutionStandard)
+		{
+			std::cerr << "TestRankedSolver failed: wrong solution found!" << std::endl;
+		}
+		else if(!isSolvedStandard && statistics.statesMet != statisticsStandard.statesMet)
+		{
+			std::cerr << "TestRankedSolver failed: wrong states count!" << std::endl;
+		}
+	}
+	if(!RankedSolver::IsApplicable(5, 3) || RankedSolver::IsApplicable(5, 3, 1024) || RankedSolver::IsApplicable(16, 8) || RankedSolver::IsApplicable(300, 1))
+	{
+		std::cerr << "TestRankedSolver failed: wrong memory estimate!" << std::endl;
+	}
+}
+
+void TestNogoodSolver()
+{
+	const char *puzzles[] = {"2 2 1 1 1 2 2 1 2 2 1 1 1 1 2", "4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4", "3  1  2   2 1   1 2   1 1 1 2  1 2 1 3",
+		"5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5", "2 1 2 1 1 2 2 1 1 1 2 1 1 2 1",
+		"6 3 20 6 4 3 1 5 6 5 1 6 6 1 1 4 3 5 3 1 2 1 3 1 4 1 5 1 2 2 2 3 2 3 3 6 4 6 5 4 4 5 4 1 4 2 4 6 1 6 2 2 2 2 3 5 6 6 6 2 3 2 4 2 2 3 2 4 5 4 6 2 6 3 6 2 4 3 4 3 5 3 6 4 4 4 5 4 1 5 1 5 1 5 2"};
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		Board2 b(p.boardSize, p.balls, p.holes, p.walls);
+		std::vector<TiltDirection> solutionStandard;
+		std::vector<TiltDirection> solution;
+		SolveStatistics statisticsStandard;
+		SolveStatistics statistics;
+		bool isSolvedStandard = Board2::Solve(b, solutionStandard, statisticsStandard);
+		//the dead states don't lead to the won one, so the same solution is found
+		if(NogoodSolver::Solve(b, solution, statistics) != isSolvedStandard || solution != solutionStandard)
+		{
+			std::cerr << "TestNogoodSolver failed: wrong solution found!" << std::endl;
+		}
+		else if(statistics.statesMet > statisticsStandard.statesMet)
+		{
+			std::cerr << "TestNogoodSolver failed: more states met!" << std::endl;
+		}
+	}
+	//the last puzzle has two balls which can't be sunk both, so the search is cut off at once
+	Puzzle p(ParsePuzzle(puzzles[sizeof(puzzles) / sizeof(puzzles[0]) - 1]));
+	std::vector<TiltDirection> solution;
+	SolveStatistics statistics;
+	if(NogoodSolver::Solve(Board2(PuzzleView(p)), solution, statistics) || statistics.statesMet)
+	{
+		std::cerr << "TestNogoodSolver failed: the dead start is searched!" << std::endl;
+	}
+
+	//a state with a dead pair can't be won
+	Board2 board(PuzzleView(ParsePuzzle("6 3 12 4 4 3 3 4 6 5 3 4 3 3 2 2 1 3 1 5 3 6 3 2 3 3 3 6 2 6 3 1 2 1 3 4 6 5 6 2 1 2 2 5 4 5 5 3 4 3 5 4 3 4 4 1 6 2 6 3 1 3 2")));
+	DeadPatterns deadPatterns(board);
+	SuccessorGenerator generator(board);
+	SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+	std::set<PackedState> met;
+	std::deque<PackedState> queue(1);
+	board.GetPackedState(queue.front());
+	met.insert(queue.front());
+	for(; !queue.empty(); queue.pop_front())
+	{
+		Board2 b(board);
+		b.SetPackedState(queue.front());
+		std::vector<TiltDirection> tilts;
+		if(deadPatterns.IsDead(queue.front()) && Board2::Solve(b, tilts))
+		{
+			std::cerr << "TestNogoodSolver failed: a dead state is won!" << std::endl;
+			break;
+		}
+		generator.Expand(queue.front(), successors);
+		for(size_t i = 0; i < SuccessorGenerator::DirectionsCount; ++i)
+		{
+			if(SuccessorGenerator::Moved == successors[i].outcome && met.insert(successors[i].state).second)
+			{
+				queue.push_back(successors[i].state);
+			}
+		}
+	}
+	if(!deadPatterns.GetDeadCount())
+	{
+		std::cerr << "TestNogoodSolver failed: no dead pairs found!" << std::endl;
+	}
+}
+
+void TestStateBatch()
+{
+	Puzzle p(ParsePuzzle("5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5"));
+	Board2 board((PuzzleView(p)));
+	std::vector<TiltDirection> solution;
+	Board2::Solve(board, solution);
+	//the states along the solution, their tilts lose, win and move the balls
+	std::vector<PackedState> states(solution.size());
+	Board2 b(board);
+	for(size_t i = 0; i < solution.size(); ++i)
+	{
+		b.GetPackedState(states[i]);
+		b.Tilt(solution[i]);
+	}
+	StateBatch batch(board);
+	for(size_t i = 0; i < states.size(); i += StateBatch::Lanes)
+	{
+		batch.Clear();
+		for(size_t j = 0; j < StateBatch::Lanes && i + j < states.size(); ++j)
+		{
+			batch.SetState(j, states[i + j]);
+		}
+		const TiltDirection directions[] = {West, East, North, South};
+		for(size_t d = 0; d < sizeof(directions) / sizeof(directions[0]); ++d)
+		{
+			StateBatch tilted(batch);
+			tilted.Tilt(directions[d]);
+			std::vector<PackedState> children;
+			tilted.GetStates(children);
+			for(size_t j = 0; j < batch.GetSize(); ++j)
+			{
+				b.SetPackedState(states[i + j]);
+				b.Tilt(directions[d]);
+				PackedState child;
+				if(b.IsGameLost() != ((tilted.GetLostMask() >> j) & 1) || b.IsGameWon() != ((tilted.GetWonMask() >> j) & 1))
+				{
+					std::cerr << "TestStateBatch failed: wrong lost or won lane!" << std::endl;
+				}
+				else if(!b.IsGameLost())
+				{
+					b.GetPackedState(child);
+					if(child != children[j])
+					{
+						std::cerr << "TestStateBatch failed: wrong state of the lane!" << std::endl;
+					}
+				}
+			}
+		}
+	}
+}
+
+void TestSuccessorGenerator()
+{
+	const char *puzzles[] = {"4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4", "5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5"};
+	const TiltDirection directions[] = {West, East, North, South};
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		Board2 board((PuzzleView(p)));
+		std::vector<TiltDirection> solution;
+		Board2::Solve(board, solution);
+		SuccessorGenerator generator(board);
+		SuccessorGenerator::Successor successors[SuccessorGenerator::DirectionsCount];
+		//the states along the solution, their tilts lose, win and move the balls
+		Board2 b(board);
+		for(size_t j = 0; j < solution.size(); ++j)
+		{
+			PackedState state;
+			b.GetPackedState(state);
+			generator.Expand(state, successors);
+			for(size_t d = 0; d < sizeof(directions) / sizeof(directions[0]); ++d)
+			{
+				Board2 tilted(b);
+				tilted.Tilt(directions[d]);
+				const SuccessorGenerator::Successor &successor = successors[directions[d]];
+				PackedState child;
+				if(tilted.IsGameLost() != (SuccessorGenerator::Lost == successor.outcome) || tilted.IsGameWon() != (SuccessorGenerator::Won == successor.outcome))
+				{
+					std::cerr << "TestSuccessorGenerator failed: wrong outcome!" << std::endl;
+				}
+				else if(SuccessorGenerator::Moved == successor.outcome)
+				{
+					tilted.GetPackedState(child);
+					if(child != successor.state)
+					{
+						std::cerr << "TestSuccessorGenerator failed: wrong child!" << std::endl;
+					}
+				}
+			}
+			b.Tilt(solution[j]);
+		}
+	}
+}
+
+//tilts the board in place through all the sequences of the depth and checks that each undo restores the state and agrees with a tilted copy
+bool CheckJournaledTilts(Board2 &board, size_t depth)
+{
+	const TiltDirection directions[] = {West, East, North, South};
+	PackedState state;
+	board.GetPackedState(state);
+	std::vector<TiltDirection> tilts(board.GetTiltsSequence());
+	for(size_t d = 0; d < sizeof(directions) / sizeof(directions[0]); ++d)
+	{
+		//the copy recounts its balls from the state, so it doesn't take over a wrong count of the board
+		Board2 copy(board);
+		copy.SetPackedState(state);
+		copy.Tilt(directions[d]);
+		board.Tilt(directions[d]);
+		if(board.IsGameLost() != copy.IsGameLost() || board.IsGameWon() != copy.IsGameWon()
+			|| (!board.IsGameLost() && !(board.GetStateDigest() == copy.GetStateDigest())))
+		{
+			return false;
+		}
+		if(depth > 1 && !board.IsGameLost() && !board.IsGameWon() && !CheckJournaledTilts(board, depth - 1))
+		{
+			return false;
+		}
+		board.Undo();
+		PackedState restored;
+		board.GetPackedState(restored);
+		if(restored != state || board.IsGameLost() || board.IsGameWon() || board.GetTiltsSequence() != tilts)
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+void TestBoardJournal()
+{
+	const char *puzzles[] = {"4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4", "5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5"};
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		Board2 board((PuzzleView(p)));
+		board.SetJournaling(true);
+		if(!CheckJournaledTilts(board, 5))
+		{
+			std::cerr << "TestBoardJournal failed: the undone tilts don't restore the board!" << std::endl;
+		}
+	}
+	//the large board keeps the column-major cells, which should be restored too
+	std::vector<Position> balls;
+	std::vector<Position> holes;
+	for(size_t i = 0; i < 6; ++i)
+	{
+		balls.push_back(Position(10 + 13 * i, 90 - 11 * i));
+		holes.push_back(Position(7 * i + 3, 5 + 17 * i));
+	}
+	Board2 large(100, balls, holes, std::vector<std::pair<Position, Position>>());
+	large.SetJournaling(true);
+	if(!CheckJournaledTilts(large, 3))
+	{
+		std::cerr << "TestBoardJournal failed: the undone tilts don't restore the large board!" << std::endl;
+	}
+	large.Tilt(West);
+	large.SetJournaling(false);
+	try
+	{
+		large.Undo();
+		std::cerr << "TestBoardJournal failed: the tilt is undone without the journal!" << std::endl;
+	}
+	catch(const std::logic_error&)
+	{
+	}
+}
+
+//tilts the boards by the same random tilts (starting anew after the game is lost or won), returns false if they differ
+bool CheckSameTilts(const Board2 &start, const Board2 &otherStart, size_t tiltsCount, unsigned int seed)
+{
+	const TiltDirection directions[] = {West, East, North, South};
+	std::mt19937 random(seed);
+	Board2 board(start);
+	Board2 other(otherStart);
+	for(size_t i = 0; i < tiltsCount; ++i)
+	{
+		if(board.IsGameLost() || board.IsGameWon())
+		{
+			board = start;
+			other = otherStart;
+		}
+		TiltDirection direction = directions[random() % (sizeof(directions) / sizeof(directions[0]))];
+		board.Tilt(direction);
+		other.Tilt(direction);
+		if(board.IsGameLost() != other.IsGameLost() || board.IsGameWon() != other.IsGameWon()
+			|| (!board.IsGameLost() && !(board.GetStateDigest() == other.GetStateDigest())))
+		{
+			return false;
+		}
+	}
+	return true;
+}
+
+//Test for the lookup tables of Board2: the tilts by the tables should be the same as the ones going through the cells
+//when all the tables are built, when some of them don't fit the limit and when the tables are built by the copies in several threads
+void TestBoardTables()
+{
+	const char *puzzles[] = {"4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4", "5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5",
+		"4 3 4 1 4 3 2 1 1 3 3 2 3 2 2 1 2 2 2 3 1 4 1 3 3 3 4 3 2 3 3", "4 3 4 4 1 2 4 3 1 4 2 3 2 4 3 4 1 4 2 3 3 4 3 3 2 4 2 3 3 3 4"};
+	const size_t tiltsCount = 2000;
+	const size_t smallLimit = 64;
+	const unsigned int threadsCount = 4;
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		Board2 board((PuzzleView(p)));
+		Board2 scanned((PuzzleView(p)));
+		scanned.SetMaxTablesEntries(0);
+		if(!CheckSameTilts(board, scanned, tiltsCount, 1) || !board.GetTablesEntries() || scanned.GetTablesEntries())
+		{
+			std::cerr << "TestBoardTables failed: the tilts by the tables differ from the scan!" << std::endl;
+		}
+		//the shapes whose tables would exceed the limit fall back to the scan
+		Board2 limited((PuzzleView(p)));
+		limited.SetMaxTablesEntries(smallLimit);
+		if(!CheckSameTilts(limited, scanned, tiltsCount, 1) || limited.GetTablesEntries() > smallLimit)
+		{
+			std::cerr << "TestBoardTables failed: wrong tilts above the tables limit!" << std::endl;
+		}
+		//the copies in the threads build each table once, as the same tilts made one after another do
+		Board2 sequential((PuzzleView(p)));
+		for(unsigned int t = 0; t < threadsCount; ++t)
+		{
+			CheckSameTilts(sequential, scanned, tiltsCount, t);
+		}
+		Board2 shared((PuzzleView(p)));
+		boost::atomic<size_t> failuresCount(0);
+		boost::thread_group threads;
+		for(unsigned int t = 0; t < threadsCount; ++t)
+		{
+			threads.create_thread([&shared, &scanned, &failuresCount, tiltsCount, t]() {
+				if(!CheckSameTilts(shared, scanned, tiltsCount, t))
+				{
+					++failuresCount;
+				}
+			});
+		}
+		threads.join_all();
+		if(failuresCount.load() || shared.GetTablesEntries() != sequential.GetTablesEntries())
+		{
+			std::cerr << "TestBoardTables failed: wrong tilts by the tables shared between the threads!" << std::endl;
+		}
+	}
+}
+
+void TestReachableStateIndex()
+{
+	std::string path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string());
+	const char *puzzles[] = {"4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4", "5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5",
+		"2 1 2 1 1 2 2 1 1 1 2 1 1 2 1"};
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		Board2 board((PuzzleView(p)));
+		std::vector<TiltDirection> solution;
+		bool isSolved = Board2::Solve(board, solution);
+		ReachableStateIndex built(board);
+		built.Save(path);
+		ReachableStateIndex mapped(path);
+		const ReachableStateIndex *indexes[] = {&built, &mapped};
+		for(size_t j = 0; j < sizeof(indexes) / sizeof(indexes[0]); ++j)
+		{
+			const ReachableStateIndex &index = *indexes[j];
+			//the won state is the empty digest, its path is the solution
+			std::vector<TiltDirection> path;
+			if(index.GetPath(BoardStateDigest(), path) != isSolved || (isSolved && path != solution)
+				|| index.GetDistance(BoardStateDigest()) != (isSolved ? solution.size() : ReachableStateIndex::NotReachable))
+			{
+				std::cerr << "TestReachableStateIndex failed: wrong path to the won state!" << std::endl;
+			}
+			//the path of each state of the solution leads to it and is not longer than the solution's tilts
+			Board2 b(board);
+			for(size_t k = 0; k < solution.size(); ++k)
+			{
+				Board2 replayed(board);
+				if(!index.GetPath(b.GetStateDigest(), path) || path.size() > k || index.GetDistance(b.GetStateDigest()) != path.size())
+				{
+					std::cerr << "TestReachableStateIndex failed: a state of the solution is not reachable!" << std::endl;
+					break;
+				}
+				for(size_t l = 0; l < path.size(); ++l)
+				{
+					replayed.Tilt(path[l]);
+				}
+				if(!(replayed.GetStateDigest() == b.GetStateDigest()))
+				{
+					std::cerr << "TestReachableStateIndex failed: the path doesn't lead to the state!" << std::endl;
+				}
+				b.Tilt(solution[k]);
+			}
+			//a ball standing on its own hole can't be reached
+			BoardStateDigest onHole(board.GetStateDigest());
+			onHole[0] = Position(board.GetHolesCells()[0] / board.GetBoardSize(), board.GetHolesCells()[0] % board.GetBoardSize());
+			if(index.IsReachable(onHole))
+			{
+				std::cerr << "TestReachableStateIndex failed: an impossible state is reachable!" << std::endl;
+			}
+		}
+	}
+	boost::filesystem::remove(path);
+	try
+	{
+		ReachableStateIndex missing(path);
+		std::cerr << "TestReachableStateIndex failed: missing index is mapped!" << std::endl;
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+}
+
+void TestCheckpointedSolver()
+{
+	std::string path((boost::filesystem::temp_directory_path() / boost::filesystem::unique_path()).string());
+	const char *puzzles[] = {"4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4", "5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5",
+		"2 1 2 1 1 2 2 1 1 1 2 1 1 2 1"};
+	for(size_t i = 0; i < sizeof(puzzles) / sizeof(puzzles[0]); ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		std::vector<TiltDirection> solutionStandard;
+		std::vector<TiltDirection> solution;
+		std::vector<TiltDirection> solutionResumed;
+		SolveStatistics statistics;
+		SolveStatistics statisticsResumed;
+		bool isSolvedStandard = Board2::Solve(Board2(PuzzleView(p)), solutionStandard);
+		//the checkpoints are written as often as possible, so the last one is somewhere in the middle of the search
+		if(CheckpointedSolver::Solve(p, path, 0, solution, statistics) != isSolvedStandard || solution != solutionStandard)
+		{
+			std::cerr << "TestCheckpointedSolver failed: wrong solution found!" << std::endl;
+		}
+		else if(CheckpointedSolver::Resume(path, 0, solutionResumed, statisticsResumed) != isSolvedStandard || solutionResumed != solution
+			|| statisticsResumed.statesMet != statistics.statesMet || statisticsResumed.boardsQueued != statistics.boardsQueued)
+		{
+			std::cerr << "TestCheckpointedSolver failed: the resumed search differs!" << std::endl;
+		}
+	}
+	boost::filesystem::remove(path);
+	boost::filesystem::remove(path + ".states");
+	try
+	{
+		std::vector<TiltDirection> solution;
+		SolveStatistics statistics;
+		CheckpointedSolver::Resume(path, 0, solution, statistics);
+		std::cerr << "TestCheckpointedSolver failed: missing checkpoint is resumed!" << std::endl;
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+}
+
+void TestPortfolioSolver()
+{
+	PortfolioSolver portfolio(GetEngineNames());
+	const char *puzzles[] = {"2 2 1 1 1 2 2 1 2 2 1 1 1 1 2", "4 3 2 1 1 1 2 4 1 2 4 2 2 4 2 2 1 3 1 3 3 3 4",
+		"5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5", "2 1 2 1 1 2 2 1 1 1 2 1 1 2 1"};
+	const size_t puzzlesCount = sizeof(puzzles) / sizeof(puzzles[0]);
+	SolveStatistics statistics;
+	for(size_t i = 0; i < puzzlesCount; ++i)
+	{
+		Puzzle p(ParsePuzzle(puzzles[i]));
+		std::vector<TiltDirection> solutionStandard;
+		std::vector<TiltDirection> solution;
+		bool isSolvedStandard = Board2::Solve(Board2(PuzzleView(p)), solutionStandard);
+		//the engines may find different solutions, but each one should win
+		if(portfolio.Solve(p, solution, statistics) != isSolvedStandard)
+		{
+			std::cerr << "TestPortfolioSolver failed: wrong answer by " << statistics.winner << "!" << std::endl;
+		}
+		else if(isSolvedStandard && VerificationWon != VerifySolution<Board2>(p, solution))
+		{
+			std::cerr << "TestPortfolioSolver failed: solution by " << statistics.winner << " doesn't win!" << std::endl;
+		}
+	}
+	//the wins are counted over all the puzzles solved by the portfolio
+	size_t winsCount = 0;
+	for(std::map<std::string, size_t>::const_iterator it = statistics.engineWins.begin(); it != statistics.engineWins.end(); ++it)
+	{
+		winsCount += it->second;
+	}
+	if(winsCount != puzzlesCount || statistics.engineWins.size() != portfolio.GetEngines().size() || !statistics.engineWins.count(statistics.winner))
+	{
+		std::cerr << "TestPortfolioSolver failed: wrong wins count!" << std::endl;
+	}
+
+	Cancellation cancellation;
+	cancellation.Cancel();
+	try
+	{
+		std::vector<TiltDirection> solution;
+		SolveStatistics statistics;
+		Board2::Solve(Board2(PuzzleView(ParsePuzzle(puzzles[1]))), solution, statistics, &cancellation);
+		std::cerr << "TestPortfolioSolver failed: search isn't cancelled!" << std::endl;
+	}
+	catch(const SolveCancelled&)
+	{
+	}
+
+	//the only engine can't be used for the large board
+	Puzzle large;
+	large.boardSize = 300;
+	large.balls.push_back(Position(0, 0));
+	large.holes.push_back(Position(0, 299));
+	try
+	{
+		std::vector<TiltDirection> solution;
+		SolveStatistics statistics;
+		PortfolioSolver(std::vector<std::string>(1, "ranked")).Solve(large, solution, statistics);
+		std::cerr << "TestPortfolioSolver failed: inapplicable engine answers!" << std::endl;
+	}
+	catch(const std::domain_error&)
+	{
+	}
+	//the ranked states don't fit the memory limit of the portfolio
+	try
+	{
+		std::vector<TiltDirection> solution;
+		SolveStatistics statistics;
+		PortfolioSolver(std::vector<std::string>(1, "ranked"), 0).Solve(ParsePuzzle(puzzles[1]), solution, statistics);
+		std::cerr << "TestPortfolioSolver failed: memory limit is ignored!" << std::endl;
+	}
+	catch(const std::domain_error&)
+	{
+	}
+}
+
+//tells whether the solution is the standard one, the winning one of the same length or just the winning one for the kind
+bool IsSolutionOfKind(EngineSolution kind, const Puzzle &p, const std::vector<TiltDirection> &solution, const std::vector<TiltDirection> &solutionStandard)
+{
+	if(Board2Solution == kind)
+	{
+		return solution == solutionStandard;
+	}
+	return (WinningSolution == kind || solution.size() == solutionStandard.size()) && VerificationWon == VerifySolution<Board2>(p, solution);
+}
+
+void TestEngines()
+{
+	Puzzle p(ParsePuzzle("5 3 4 3 3 5 2 3 5 1 4 3 4 1 3 1 3 1 4 4 3 4 4 2 3 3 3 4 4 4 5"));
+	std::vector<TiltDirection> solutionStandard;
+	Board2::Solve(Board2(PuzzleView(p)), solutionStandard);
+	//a few tilts of the solution, so the game is not lost
+	std::vector<TiltDirection> tilts(solutionStandard.begin(), solutionStandard.begin() + 3);
+	std::vector<std::string> engines(GetEngineNames());
+	std::unique_ptr<Engine> reference(CreateEngine("board2", PuzzleView(p)));
+	for(size_t i = 0; i < tilts.size(); ++i)
+	{
+		reference->Tilt(tilts[i]);
+	}
+	std::vector<TiltDirection> solutionReference;
+	SolveStatistics statistics;
+	reference->Solve(solutionReference, statistics);
+	solutionReference.insert(solutionReference.begin(), tilts.begin(), tilts.end());
+	for(size_t i = 0; i < engines.size(); ++i)
+	{
+		std::unique_ptr<Engine> engine(CreateEngine(engines[i], PuzzleView(p)));
+		//the engines which search in another order should find a solution as long as the standard one or just a winning one
+		EngineSolution kind = GetEngineSolution(engines[i]);
+		std::vector<TiltDirection> solution;
+		if(!engine->Solve(solution, statistics) || !IsSolutionOfKind(kind, p, solution, solutionStandard))
+		{
+			std::cerr << "TestEngines failed: wrong solution by " << engine->GetName() << "!" << std::endl;
+		}
+		Cancellation cancellation;
+		cancellation.Cancel();
+		try
+		{
+			engine->Solve(solution, statistics, &cancellation);
+			std::cerr << "TestEngines failed: " << engine->GetName() << " isn't cancelled!" << std::endl;
+		}
+		catch(const SolveCancelled&)
+		{
+		}
+		//the solution is searched from the current state
+		for(size_t j = 0; j < tilts.size(); ++j)
+		{
+			engine->Tilt(tilts[j]);
+		}
+		if(!(engine->GetStateDigest() == reference->GetStateDigest()))
+		{
+			std::cerr << "TestEngines failed: wrong state of " << engine->GetName() << "!" << std::endl;
+		}
+		else
+		{
+			bool isSolved = engine->Solve(solution, statistics);
+			solution.insert(solution.begin(), tilts.begin(), tilts.end());
+			if(!isSolved || !IsSolutionOfKind(kind, p, solution, solutionReference))
+			{
+				std::cerr << "TestEngines failed: wrong solution from the state by " << engine->GetName() << "!" << std::endl;
+			}
+		}
+	}
+
+	std::stringstream table;
+	table << "4 1 0 board 0.5\n4 1 0 board2 0.25\n\n64 1 0 board2 0.5\n64 1 0 ranked 0.125\n";
+	CalibrationTable calibration(ReadCalibration(table));
+	std::stringstream written;
+	WriteCalibration(written, calibration);
+	if(calibration.size() != 4 || written.str() != "4 1 0 board 0.5\n4 1 0 board2 0.25\n64 1 0 board2 0.5\n64 1 0 ranked 0.125\n")
+	{
+		std::cerr << "TestEngines failed: wrong calibration table!" << std::endl;
+	}
+	//the nearest kind is chosen, its engines which are not applicable are skipped
+	if(ChooseEngine(PuzzleView(p), calibration, RankedSolver::DefaultMemoryLimit) != "board2"
+		|| ChooseEngine(PuzzleView(ParsePuzzle("50 1 0 1 1 50 50")), calibration, RankedSolver::DefaultMemoryLimit) != "ranked"
+		|| ChooseEngine(PuzzleView(ParsePuzzle("50 1 0 1 1 50 50")), calibration, 0) != "board2"
+		|| ChooseEngine(PuzzleView(p), CalibrationTable(), 0) != "sparse")
+	{
+		std::cerr << "TestEngines failed: wrong engine chosen!" << std::endl;
+	}
+	try
+	{
+		CreateEngine("none", PuzzleView(p));
+		std::cerr << "TestEngines failed: unknown engine is created!" << std::endl;
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+}
+
+void TestRegression()
+{
+	std::stringstream corpus;
+	corpus << "//the comment\n\n2 2 1 1 1 2 2 1 2 2 1 1 1 1 2\n2 1 2 1 1 2 2 1 1 1 2 1 1 2 1\n";
+	std::vector<RegressionCase> cases(ReadRegressionCorpus(corpus));
+	if(2 != cases.size() || cases[0].isMeasured)
+	{
+		std::cerr << "TestRegression failed: wrong corpus!" << std::endl;
+		return;
+	}
+	for(size_t i = 0; i < cases.size(); ++i)
+	{
+		cases[i] = MeasureRegressionCase(cases[i].puzzle, 1);
+	}
+	if("X" == cases[0].solution || "X" != cases[1].solution || 0 == cases[0].statistics.statesMet)
+	{
+		std::cerr << "TestRegression failed: wrong measurement!" << std::endl;
+	}
+	//the baselines survive writing and reading
+	std::stringstream baseline;
+	WriteRegressionCorpus(baseline, cases);
+	std::vector<RegressionCase> read(ReadRegressionCorpus(baseline));
+	if(2 != read.size() || read[0].puzzle != cases[0].puzzle || read[0].solution != cases[0].solution
+		|| read[1].statistics.maxQueueSize != cases[1].statistics.maxQueueSize || !read[1].isMeasured)
+	{
+		std::cerr << "TestRegression failed: wrong baseline reading!" << std::endl;
+		return;
+	}
+	//the time is given a huge tolerance, only the exact results are checked
+	std::stringstream report;
+	if(0 != RunRegression(read, 1, 1000, true, false, report))
+	{
+		std::cerr << "TestRegression failed: false regression!" << std::endl;
+	}
+	//the slower solve is only reported unless the time is gated
+	read[0].seconds = -1;
+	if(0 != RunRegression(read, 1, 0, false, false, report) || 1 != RunRegression(read, 1, 0, true, false, report))
+	{
+		std::cerr << "TestRegression failed: wrong time gate!" << std::endl;
+	}
+	read[0].seconds = cases[0].seconds;
+	read[1].statistics.statesMet += 1;
+	if(1 != RunRegression(read, 1, 1000, false, true, report))
+	{
+		std::cerr << "TestRegression failed: the changed nodes count is not detected!" << std::endl;
+	}
+	std::stringstream malformed("2 2 1 1 1 2 2 1 2 2 1 1 1 1 2 # solution=X states=many\n");
+	try
+	{
+		ReadRegressionCorpus(malformed);
+		std::cerr << "TestRegression failed: the malformed baseline is accepted!" << std::endl;
+	}
+	catch(const std::invalid_argument&)
+	{
+	}
+}
+
+void TestSolverServer()
+{
+	SolverServer server(3, 2);
+	std::istringstream input("1 3 1 0 1 1 3 3\n2 2 1 2 1 1 2 2 1 1 1 2 1 1 2 1\n\n3 not a puzzle\n4 3 1 0 1 1 3 3\n");
+	std::ostringstream output;
+	server.ServeStream(input, output);
+
+	//the responses may come in any order
+	std::map<std::string, std::string> responses;
+	std::istringstream outputLines(output.str());
+	std::string line;
+	while(std::getline(outputLines, line))
+	{
+		std::string::size_type idEnd = line.find(' ');
+		responses[line.substr(0, idEnd)] = line.substr(idEnd + 1);
+	}
+	if(responses.size() != 4)
+	{
+		std::cerr << "TestSolverServer failed: wrong number of responses!" << std::endl;
+		return;
+	}
+	if(responses["1"] != responses["4"] || responses["1"] != server.Solve("3 1 0 1 1 3 3") || responses["2"] != "X")
+	{
+		std::cerr << "TestSolverServer failed: wrong solution!" << std::endl;
+	}
+	std::vector<TiltDirection> solution(ParseSolution(responses["1"]));
+	if(VerificationWon != VerifySolution<Board2>(ParsePuzzle("3 1 0 1 1 3 3"), solution))
+	{
+		std::cerr << "TestSolverServer failed: solution doesn't win!" << std::endl;
+	}
+	if(0 != responses["3"].find("ERROR "))
+	{
+		std::cerr << "TestSolverServer failed: invalid puzzle isn't reported!" << std::endl;
+	}
+}
+
+size_t CountTraceEvents(const std::string &trace, const std::string &name)
+{
+	size_t count = 0;
+	std::string event = "{\"name\":\"" + name + "\"";
+	for(std::string::size_type position = trace.find(event); std::string::npos != position; position = trace.find(event, position + 1))
+	{
+		++count;
+	}
+	return count;
+}
+
+void TestTrace()
+{
+	Trace::Enable(16);
+	//each thread records an event and exits, only the last buffers are kept till they are written
+	for(size_t i = 0; i < Trace::MaxFinishedThreads + 10; ++i)
+	{
+		boost::thread thread([]() {
+			Trace::Record("TestTrace", 0, 1);
+		});
+		thread.join();
+	}
+	Trace::Record("TestTraceMain", 0, 1);
+	std::ostringstream output;
+	Trace::Write(output);
+	if(CountTraceEvents(output.str(), "TestTrace") != Trace::MaxFinishedThreads || CountTraceEvents(output.str(), "TestTraceMain") != 1)
+	{
+		std::cerr << "TestTrace failed: wrong events of the threads!" << std::endl;
+	}
+	std::ostringstream secondOutput;
+	Trace::Write(secondOutput);
+	if(CountTraceEvents(secondOutput.str(), "TestTrace") || CountTraceEvents(secondOutput.str(), "TestTraceMain"))
+	{
+		std::cerr << "TestTrace failed: the written events are not cleared!" << std::endl;
+	}
+	Trace::Disable();
+}
+
+//The class FailuresCounter passes the error output through and counts its lines (each one is a failure of a test),
+//so the tests exit with a non-zero code and the build step running them fails.
+//It takes the place of the stream's buffer while it lives (also when a test throws) and gives it back when it's destroyed.
+class FailuresCounter : public std::streambuf
+{
+public:
+	explicit FailuresCounter(std::ostream &stream)
+		:m_stream(stream)
+		,m_output(stream.rdbuf())
+		,m_failuresCount(0)
+	{
+		m_stream.rdbuf(this);
+	}
+	~FailuresCounter()
+	{
+		m_stream.rdbuf(m_output);
+	}
+	size_t GetFailuresCount() const
+	{
+		return m_failuresCount;
+	}
+
+protected:
+	virtual int overflow(int c)
+	{
+		if(traits_type::eq_int_type(c, traits_type::eof()))
+		{
+			return traits_type::not_eof(c);
+		}
+		if('\n' == c)
+		{
+			++m_failuresCount;
+		}
+		return m_output->sputc(traits_type::to_char_type(c));
+	}
+	virtual int sync()
+	{
+		return m_output->pubsync();
+	}
+
+private:
+	FailuresCounter(const FailuresCounter&);
+	FailuresCounter& operator=(const FailuresCounter&);
+
+	std::ostream &m_stream;
+	std::streambuf *m_output;
+	size_t m_failuresCount;
+};
+
+//Checks the solver against the baselines of the corpus (the solutions and the nodes counts, the time is only reported).
+void TestRegressionCorpus(const std::string &corpusFileName)
+{
+	std::ifstream corpusFile(corpusFileName);
+	if(!corpusFile.is_open())
+	{
+		std::cerr << "TestRegressionCorpus failed: can't open " << corpusFileName << "!" << std::endl;
+		return;
+	}
+	const size_t regressionsCount = RunRegression(ReadRegressionCorpus(corpusFile), 1, 0.5, false, false, std::cout);
+	if(regressionsCount)
+	{
+		std::cerr << "TestRegressionCorpus failed: " << regressionsCount << " regressions in " << corpusFileName << "!" << std::endl;
+	}
+}
+
 template <typename T>
 void f(T val)
 {
@@ -265,17 +1553,80 @@ void advance (InputIterator &it, Distance n)
 {
 }
 
-int main()
+//the optional argument is the path of the regression corpus to check the solver against,
+//the exit code is 1 if a test fails
+int main(int argc, char *argv[])
 try
 {
+	FailuresCounter failuresCounter(std::cerr);
 	std::cout << "Test0()" << std::endl;
 	Test0<Board2>();
 	std::cout << "Test1()" << std::endl;
 	Test1<Board2>();
 	std::cout << "Test2()" << std::endl;
 	Test2<Board2>();
+	std::cout << "Test0<SparseBoard>()" << std::endl;
+	Test0<SparseBoard>();
+	std::cout << "Test1<SparseBoard>()" << std::endl;
+	Test1<SparseBoard>();
+	std::cout << "Test2<SparseBoard>()" << std::endl;
+	Test2<SparseBoard>();
+	std::cout << "TestVerification()" << std::endl;
+	TestVerification();
+	std::cout << "TestShortestSolutions()" << std::endl;
+	TestShortestSolutions<Board2>();
+	std::cout << "TestGenerator()" << std::endl;
+	TestGenerator();
+	std::cout << "TestGeneratorFullBoards()" << std::endl;
+	TestGeneratorFullBoards();
+	std::cout << "TestPuzzleValidation()" << std::endl;
+	TestPuzzleValidation();
+	std::cout << "TestLargeBoard()" << std::endl;
+	TestLargeBoard();
+	std::cout << "TestCompactSolver()" << std::endl;
+	TestCompactSolver();
+	std::cout << "TestCompactSolverBytes()" << std::endl;
+	TestCompactSolverBytes();
+	std::cout << "TestRankedSolver()" << std::endl;
+	TestRankedSolver();
+	std::cout << "TestNogoodSolver()" << std::endl;
+	TestNogoodSolver();
+	std::cout << "TestStateBatch()" << std::endl;
+	TestStateBatch();
+	std::cout << "TestSuccessorGenerator()" << std::endl;
+	TestSuccessorGenerator();
+	std::cout << "TestBoardJournal()" << std::endl;
+	TestBoardJournal();
+	std::cout << "TestBoardTables()" << std::endl;
+	TestBoardTables();
+	std::cout << "TestReachableStateIndex()" << std::endl;
+	TestReachableStateIndex();
+	std::cout << "TestCheckpointedSolver()" << std::endl;
+	TestCheckpointedSolver();
+	std::cout << "TestPortfolioSolver()" << std::endl;
+	TestPortfolioSolver();
+	std::cout << "TestEngines()" << std::endl;
+	TestEngines();
+	std::cout << "TestRegression()" << std::endl;
+	TestRegression();
+	std::cout << "TestSolverServer()" << std::endl;
+	TestSolverServer();
+	std::cout << "TestTrace()" << std::endl;
+	TestTrace();
+	if(argc > 1)
+	{
+		std::cout << "TestRegressionCorpus()" << std::endl;
+		TestRegressionCorpus(argv[1]);
+	}
+	if(failuresCounter.GetFailuresCount())
+	{
+		std::cout << failuresCounter.GetFailuresCount() << " failures" << std::endl;
+		return 1;
+	}
+	return 0;
 }
 catch (const std::exception &e)
 {
 	std::cout << "Caught " << typeid(e).name() << ": " << e.what() << std::endl;
+	return 1;
 }
\ No newline at end of file
@@ -0,0 +1,132 @@
+#include "stdafx.h"
+#include "trace.h"
+
+namespace
+{
+	struct TraceBuffer
+	{
+		TraceBuffer(size_t capacity, size_t threadNumber)
+			:events(capacity)
+			,next(0)
+			,isWrapped(false)
+			,threadNumber(threadNumber)
+		{
+		}
+
+		std::vector<Trace::Event> events;
+		size_t next;	//position of the next event to record
+		bool isWrapped;	//events older than the next position were overwritten
+		size_t threadNumber;
+	};
+
+	typedef boost::chrono::high_resolution_clock TraceClock;
+
+	boost::mutex g_buffersMutex;
+	std::vector<std::shared_ptr<TraceBuffer>> g_buffers;	//the buffers of the running threads
+	std::deque<std::shared_ptr<TraceBuffer>> g_finishedBuffers;	//the buffers of the exited threads till they are written
+	size_t g_eventsPerThread = 1 << 16;
+	TraceClock::time_point g_epoch;
+
+	//the buffers are owned by the registry, at the thread exit the buffer is dropped or kept till the next Write()
+	void ReleaseBuffer(TraceBuffer *buffer)
+	{
+		boost::lock_guard<boost::mutex> lock(g_buffersMutex);
+		for(size_t i = 0; i < g_buffers.size(); ++i)
+		{
+			if(g_buffers[i].get() != buffer)
+			{
+				continue;
+			}
+			if(buffer->next || buffer->isWrapped)
+			{
+				g_finishedBuffers.push_back(g_buffers[i]);
+				if(g_finishedBuffers.size() > Trace::MaxFinishedThreads)
+				{
+					g_finishedBuffers.pop_front();
+				}
+			}
+			g_buffers.erase(g_buffers.begin() + i);
+			return;
+		}
+	}
+
+	boost::thread_specific_ptr<TraceBuffer> g_threadBuffer(&ReleaseBuffer);
+	size_t g_threadsCount = 0;
+
+	TraceBuffer& ThreadBuffer()
+	{
+		TraceBuffer *buffer = g_threadBuffer.get();
+		if(!buffer)
+		{
+			boost::lock_guard<boost::mutex> lock(g_buffersMutex);
+			g_buffers.push_back(std::make_shared<TraceBuffer>(g_eventsPerThread, ++g_threadsCount));
+			buffer = g_buffers.back().get();
+			g_threadBuffer.reset(buffer);
+		}
+		return *buffer;
+	}
+}
+
+boost::atomic<bool> Trace::s_isEnabled(false);
+
+void Trace::Enable(size_t eventsPerThread)
+{
+	if(!eventsPerThread)
+	{
+		throw std::invalid_argument("eventsPerThread should be possitive");
+	}
+	g_eventsPerThread = eventsPerThread;
+	g_epoch = TraceClock::now();
+	s_isEnabled.store(true, boost::memory_order_release);
+}
+
+void Trace::Disable()
+{
+	s_isEnabled.store(false, boost::memory_order_release);
+}
+
+unsigned long long Trace::Now()
+{
+	return boost::chrono::duration_cast<boost::chrono::microseconds>(TraceClock::now() - g_epoch).count();
+}
+
+void Trace::Record(const char *name, unsigned long long begin, unsigned long long end)
+{
+	TraceBuffer &buffer = ThreadBuffer();
+	Event &e = buffer.events[buffer.next];
+	e.name = name;
+	e.begin = begin;
+	e.duration = end - begin;
+	if(++buffer.next == buffer.events.size())
+	{
+		buffer.next = 0;
+		buffer.isWrapped = true;
+	}
+}
+
+void Trace::Write(std::ostream &output)
+{
+	boost::lock_guard<boost::mutex> lock(g_buffersMutex);
+	output << "{\"traceEvents\":[";
+	bool isFirst = true;
+	std::vector<std::shared_ptr<TraceBuffer>> buffers(g_finishedBuffers.begin(), g_finishedBuffers.end());
+	buffers.insert(buffers.end(), g_buffers.begin(), g_buffers.end());
+	g_finishedBuffers.clear();
+	for(size_t i = 0; i < buffers.size(); ++i)
+	{
+		TraceBuffer &buffer = *buffers[i];
+		//the oldest event is at the next position if the buffer is wrapped
+		size_t count = buffer.isWrapped ? buffer.events.size() : buffer.next;
+		size_t start = buffer.isWrapped ? buffer.next : 0;
+		for(size_t j = 0; j < count; ++j)
+		{
+			const Event &e = buffer.events[(start + j) % buffer.events.size()];
+			output << (isFirst ? "\n" : ",\n");
+			output << "{\"name\":\"" << e.name << "\",\"ph\":\"X\",\"pid\":1,\"tid\":" << buffer.threadNumber << ",\"ts\":" << e.begin << ",\"dur\":" << e.duration << "}";
+			isFirst = false;
+		}
+		buffer.next = 0;
+		buffer.isWrapped = false;
+	}
+	output << "\n],\"displayTimeUnit\":\"ns\"}" << std::endl;
+}
@@ -0,0 +1,85 @@
+#pragma once
+
+//The class Trace collects scoped timeline events of the solver and writes them in the Chrome trace format
+//(the output can be opened with chrome://tracing or Perfetto).
+//The events are put into the code only when TASK1_ENABLE_TRACING is defined and are recorded only after Enable() is called,
+//so with the tracing compiled in but disabled each event costs a check of one flag.
+//Each thread writes its events to its own ring buffer (when the buffer is full the oldest events are overwritten),
+//so recording needs no locks. The buffers are registered once per thread; after the thread exits its buffer is kept
+//till the next Write() if it has events (at most MaxFinishedThreads buffers, the oldest ones are dropped), so the threads
+//which come and go (the connections of the server) don't pile up the buffers.
+//Note: Enable(), Disable() and Write() should be called while no traced work is running.
+class Trace
+{
+public:
+	struct Event
+	{
+		const char *name;
+		unsigned long long begin;	//microseconds since the tracing was enabled
+		unsigned long long duration;	//microseconds
+	};
+
+	//the most buffers of the exited threads kept till Write()
+	static const size_t MaxFinishedThreads = 64;
+
+	static void Enable(size_t eventsPerThread = 1 << 16);
+	static void Disable();
+	static bool IsEnabled()
+	{
+		return s_isEnabled.load(boost::memory_order_acquire);
+	}
+	static unsigned long long Now();
+	static void Record(const char *name, unsigned long long begin, unsigned long long end);
+	//writes all recorded events (in the Chrome trace JSON format) and clears the buffers
+	static void Write(std::ostream &output);
+
+private:
+	static boost::atomic<bool> s_isEnabled;
+};
+
+//The class TraceScope records the event lasting from its construction till its destruction (or till Restart()).
+class TraceScope
+{
+public:
+	explicit TraceScope(const char *name)
+		:m_name(Trace::IsEnabled() ? name : 0)
+		,m_begin(m_name ? Trace::Now() : 0)
+	{
+	}
+	~TraceScope()
+	{
+		if(m_name)
+		{
+			Trace::Record(m_name, m_begin, Trace::Now());
+		}
+	}
+	//finishes the current event and starts the next one with the same name
+	void Restart()
+	{
+		if(m_name)
+		{
+			unsigned long long now = Trace::Now();
+			Trace::Record(m_name, m_begin, now);
+			m_begin = now;
+		}
+	}
+
+private:
+	TraceScope(const TraceScope&);
+	TraceScope& operator=(const TraceScope&);
+
+	const char *m_name;
+	unsigned long long m_begin;
+};
+
+#ifdef TASK1_ENABLE_TRACING
+#define TRACE_CONCATENATE_IMPL(x, y) x##y
+#define TRACE_CONCATENATE(x, y) TRACE_CONCATENATE_IMPL(x, y)
+#define TRACE_SCOPE(name) TraceScope TRACE_CONCATENATE(traceScope, __LINE__)(name)
+#define TRACE_NAMED_SCOPE(variable, name) TraceScope variable(name)
+#define TRACE_RESTART(variable) variable.Restart()
+#else
+#define TRACE_SCOPE(name)
+#define TRACE_NAMED_SCOPE(variable, name)
+#define TRACE_RESTART(variable)
+#endif
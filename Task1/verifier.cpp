@@ -0,0 +1,105 @@
+#include "stdafx.h"
+#include "verifier.h"
+#include "board2.h"
+
+namespace
+{
+	void VerifyRange(const std::vector<VerificationTask> &tasks, std::vector<VerificationResult> &results, size_t begin, size_t end)
+	{
+		for(size_t i = begin; i < end; ++i)
+		{
+			try
+			{
+				results[i] = VerifySolution<Board2>(ParsePuzzle(tasks[i].puzzle), ParseSolution(tasks[i].solution));
+			}
+			catch(const std::exception&)
+			{
+				results[i] = VerificationInvalid;
+			}
+		}
+	}
+}
+
+void VerifySolutions(const std::vector<VerificationTask> &tasks, std::vector<VerificationResult> &results, size_t threadsCount)
+{
+	results.resize(tasks.size());
+	if(!threadsCount)
+	{
+		threadsCount = std::max<size_t>(boost::thread::hardware_concurrency(), 1);
+	}
+	threadsCount = std::min(threadsCount, tasks.size());
+	if(threadsCount <= 1)
+	{
+		VerifyRange(tasks, results, 0, tasks.size());
+		return;
+	}
+
+	//split the tasks on contiguous ranges, so the threads don't write to the same cache lines of the results
+	boost::thread_group workers;
+	size_t rangeSize = (tasks.size() + threadsCount - 1) / threadsCount;
+	for(size_t begin = 0; begin < tasks.size(); begin += rangeSize)
+	{
+		workers.create_thread(std::bind(&VerifyRange, std::cref(tasks), std::ref(results), begin, std::min(begin + rangeSize, tasks.size())));
+	}
+	workers.join_all();
+}
+
+void VerifySolutionsStream(std::istream &input, std::ostream &output, size_t threadsCount, size_t chunkSize)
+{
+	if(!chunkSize)
+	{
+		throw std::invalid_argument("chunkSize should be possitive");
+	}
+
+	std::vector<VerificationTask> tasks;
+	std::vector<VerificationResult> results;
+	tasks.reserve(chunkSize);
+	bool inputEnded = false;
+	while(!inputEnded)
+	{
+		tasks.clear();
+		VerificationTask task;
+		while(tasks.size() < chunkSize)
+		{
+			if(!std::getline(input, task.puzzle))
+			{
+				inputEnded = true;
+				break;
+			}
+			if(!std::getline(input, task.solution))
+			{
+				task.solution.clear();
+				inputEnded = true;
+			}
+			tasks.push_back(task);
+			if(inputEnded)
+			{
+				break;
+			}
+		}
+
+		VerifySolutions(tasks, results, threadsCount);
+		for(size_t i = 0; i < results.size(); ++i)
+		{
+			output << VerificationResultName(results[i]) << '\n';
+		}
+	}
+	output.flush();
+}
+
+const char* VerificationResultName(VerificationResult result)
+{
+	switch(result)
+	{
+		case VerificationWon:
+			return "won";
+		case VerificationLost:
+			return "lost";
+		case VerificationIncomplete:
+			return "incomplete";
+		case VerificationInvalid:
+			return "invalid";
+		default:
+			throw std::logic_error("Unexpected verification result value.");
+	}
+}
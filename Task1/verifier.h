@@ -0,0 +1,39 @@
+#pragma once
+
+#include "puzzle.h"
+
+enum VerificationResult {VerificationWon, VerificationLost, VerificationIncomplete, VerificationInvalid};
+
+//The struct VerificationTask is a (puzzle, claimed solution) pair in the text form (as they are read from the input and printed by the application).
+struct VerificationTask
+{
+	std::string puzzle;
+	std::string solution;
+};
+
+//Replays the solution on the board and reports whether the game is won, lost or still goes on after the last tilt.
+//Tilts after the game is won are ignored (the board does not change any more).
+template <class BoardType>
+VerificationResult VerifySolution(const Puzzle &puzzle, const std::vector<TiltDirection> &solution)
+{
+	BoardType b(PuzzleView(puzzle), UntrustedPuzzle);
+	for(std::vector<TiltDirection>::const_iterator it = solution.begin(); it != solution.end() && !b.IsGameWon(); ++it)
+	{
+		b.Tilt(*it);
+		if(b.IsGameLost())
+		{
+			return VerificationLost;
+		}
+	}
+	return b.IsGameWon() ? VerificationWon : VerificationIncomplete;
+}
+
+//Verifies the tasks on threadsCount threads (0 means the number of the hardware threads).
+//results[i] is the verdict for tasks[i]; tasks which can't be parsed or describe an invalid board are reported as VerificationInvalid.
+void VerifySolutions(const std::vector<VerificationTask> &tasks, std::vector<VerificationResult> &results, size_t threadsCount);
+
+//Reads (puzzle line, solution line) pairs from the input till its end and writes one verdict per line to the output.
+//The pairs are verified in chunks of chunkSize, so the memory consumption doesn't depend on the input length.
+void VerifySolutionsStream(std::istream &input, std::ostream &output, size_t threadsCount, size_t chunkSize);
+
+const char* VerificationResultName(VerificationResult result);